@@ -1,6 +1,7 @@
 #include "cout_scope.h"
 
 #include <dson/dson.h>
+#include <dson/dson_fd_reader.h>
 
 #include <vector>
 
@@ -33,15 +34,18 @@ void empty_messages()
 		WorkFinished
 	};
 
-	const auto load_dson = [](const std::int32_t fd, hi::Dson & dson) -> bool
+	/*
+	 * Сообщения читаются из pipe через буфер читателя: один read() на все пришедшие сообщения,
+	 * dson - вьюха на буфер читателя, валидна до следующего чтения
+	 */
+	const auto load_dson = [](hi::DsonFdReader & reader, hi::Dson & dson) -> bool
 	{
-		dson.clear();
-		hi::Result result{hi::Result::InProcess};
-		while (hi::Result::InProcess == result)
+		while (!reader.next(dson))
 		{
-			result = dson.load_from_fd(fd);
+			if (reader.read() == hi::Result::Error)
+				return false;
 		}
-		return (hi::Result::Error != result);
+		return true;
 	};
 
 	const auto send_dson = [](const std::int32_t fd, hi::Dson & dson) -> bool
@@ -56,6 +60,7 @@ void empty_messages()
 
 	const auto server = [&]
 	{
+		hi::DsonFdReader reader{pipe_client_send_to_server[0]};
 		hi::Dson read_dson;
 		hi::Dson write_dson;
 		enum class State
@@ -69,7 +74,7 @@ void empty_messages()
 		State state_{State::WaitClientAuth};
 		while (true)
 		{
-			if (!load_dson(pipe_client_send_to_server[0], read_dson))
+			if (!load_dson(reader, read_dson))
 			{
 				scope.print(std::string{"Server:FAIL: read_dson.load_from_fd, errno="}.append(std::to_string(errno)));
 				continue;
@@ -137,6 +142,7 @@ void empty_messages()
 
 	const auto client = [&]
 	{
+		hi::DsonFdReader reader{pipe_server_send_to_client[0]};
 		hi::Dson read_dson;
 		hi::Dson write_dson;
 		write_dson.set_key(Message::IAmClient);
@@ -151,7 +157,7 @@ void empty_messages()
 		State state_{State::WaitServerAuth};
 		while (true)
 		{
-			if (!load_dson(pipe_server_send_to_client[0], read_dson))
+			if (!load_dson(reader, read_dson))
 			{
 				scope.print(std::string{"Client:FAIL: read_dson.load_from_fd, errno="}.append(std::to_string(errno)));
 				continue;
@@ -135,7 +135,7 @@ void star_routing()
 			dson.set_key(Key::WantAuth);
 			dson.emplace(Key::Password, password);
 			dson.emplace(std::make_unique<hi::DsonRouteObj>(Key::RouteAddress));
-			auto address = dynamic_cast<hi::DsonRouteObj *>(dson.get(Key::RouteAddress));
+			auto address = hi::dson_cast<hi::DsonRouteObj>(dson.get(Key::RouteAddress));
 			address->address()->from_cli_id = client_certificate_id;
 			bool was_answers{false};
 			for (std::uint32_t service_id = 0; service_id < 500; ++service_id)
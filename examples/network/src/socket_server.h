@@ -6,6 +6,7 @@
 #include "cout_scope.h"
 
 #include <dson/dson.h>
+#include <dson/dson_fd_reader.h>
 
 #include <deque>
 #include <fcntl.h>
@@ -47,7 +48,6 @@ private:
 		scope_.print(std::string{"server_loop accept_connection:"}.append(std::to_string(connection)));
 		if (connection < 0)
 			return;
-		hi::Dson dson;
 		bool need_set_route{true};
 		std::deque<hi::Dson> write_deque;
 
@@ -76,13 +76,24 @@ private:
 			send_dson_from_deque();
 		};
 
+		/*
+		 * Один read() забирает из сокета сразу все пришедшие сообщения,
+		 * каждое один раз копируется из буфера читателя в свой буфер (см. copy_frame())
+		 * и маршрутизируется
+		 */
+		hi::DsonFdReader reader{connection};
 		while (keep_run_.load(std::memory_order_acquire))
 		{
-			hi::Result res = dson.load_from_fd(connection);
-			if (res == hi::Result::Error)
+			if (reader.read() == hi::Result::Error)
 				return;
-			if (res == hi::Result::Ready)
+			char * frame;
+			std::int32_t frame_size;
+			while (reader.next(frame, frame_size))
 			{
+				auto buf = copy_frame(frame, frame_size);
+				if (!buf)
+					continue;
+				hi::Dson dson{std::move(buf)};
 				if (need_set_route)
 				{
 					auto address_obj = dson.get(router_.route_address_key());
@@ -102,7 +113,6 @@ private:
 					need_set_route = false;
 				}
 				router_.route(std::move(dson));
-				dson.clear();
 			}
 			send_dson_from_deque();
 		} // while loop
@@ -111,6 +121,20 @@ private:
 		scope_.print("server_loop finished");
 	} // server_loop
 
+	/*
+	 * Копия кадра из буфера читателя (он переиспользуется следующим read())
+	 * в буфер под счётчиком ссылок (см. Dson(std::shared_ptr<char> buf)):
+	 * сообщение и его дети держат буфер, пока лежат в очереди отправки.
+	 * @return nullptr если память не выделилась
+	 */
+	static std::shared_ptr<char> copy_frame(const char * frame, const std::int32_t frame_size)
+	{
+		std::shared_ptr<char> buf{static_cast<char *>(std::malloc(static_cast<std::size_t>(frame_size))), std::free};
+		if (buf)
+			std::memcpy(buf.get(), frame, static_cast<std::size_t>(frame_size));
+		return buf;
+	}
+
 	int accept_connection(int socket_descriptor)
 	{
 		struct sockaddr_un client;
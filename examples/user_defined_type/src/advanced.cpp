@@ -18,6 +18,7 @@ struct hi::types_map<VeryBigStruct> : register_id<VeryBigStruct, 54322>
 /*
   Структура с большим объёмом данных, копирование в Dson стоит дорого.
   Поэтому не копируем.
+  (Если данные можно генерировать по частям и держать целиком не нужно - см. DsonProducerObj)
 */
 class VeryBigStruct : public hi::DsonObj
 {
@@ -75,13 +76,13 @@ public: // hi::DsonObj
 		return hi::types_map<VeryBigStruct>::value;
 	}
 
-	void copy_to_stream_host_order(std::ofstream & out) override
+	void copy_to_stream_host_order(std::ostream & out) override
 	{
 		to_host_order();
 		copy_to_stream_local(out);
 	}
 
-	void copy_to_stream_network_order(std::ofstream & out) override
+	void copy_to_stream_network_order(std::ostream & out) override
 	{
 		to_network_order();
 		copy_to_stream_local(out);
@@ -191,10 +192,10 @@ private:
 		prepare_data();
 	}
 
-	void copy_to_stream_local(std::ofstream & out) const
+	void copy_to_stream_local(std::ostream & out) const
 	{
-		std::copy(buf_, buf_ + buf_size, std::ostream_iterator<char>(out));
-		std::copy(very_big_data.begin(), very_big_data.end(), std::ostream_iterator<char>(out));
+		out.write(buf_, buf_size);
+		out.write(very_big_data.data(), static_cast<std::streamsize>(very_big_data.size()));
 	}
 
 	hi::Result copy_to_fd_local(std::int32_t fd)
@@ -255,7 +256,8 @@ private:
 		return hi::Result::Error;
 	}
 
-	hi::Result copy_to_buf_local(char *& buf, std::int32_t & buf_size)
+	// out_size - сколько осталось в буфере назначения (buf_size - размер заголовка с параметрами)
+	hi::Result copy_to_buf_local(char *& buf, std::int32_t & out_size)
 	{
 		switch (state_)
 		{
@@ -267,12 +269,12 @@ private:
 					return hi::Result::Error;
 				}
 				std::int32_t writed = buf_size - offset_;
-				if (writed > buf_size)
-					writed = buf_size;
+				if (writed > out_size)
+					writed = out_size;
 				std::memcpy(buf, buf_ + offset_, writed);
 				offset_ += writed;
 				buf += writed;
-				buf_size -= writed;
+				out_size -= writed;
 				if (offset_ < buf_size)
 					return hi::Result::InProcess;
 				state_ = State::CopyingData;
@@ -288,12 +290,12 @@ private:
 					return hi::Result::Error;
 				}
 				std::int32_t writed = size - offset_;
-				if (writed > buf_size)
-					writed = buf_size;
+				if (writed > out_size)
+					writed = out_size;
 				std::memcpy(buf, very_big_data.data() + offset_, writed);
 				offset_ += writed;
 				buf += writed;
-				buf_size -= writed;
+				out_size -= writed;
 				if (offset_ < size)
 					return hi::Result::InProcess;
 				state_ = State::Ready;
@@ -388,7 +390,7 @@ VeryBigStruct to_my_struct(hi::DsonObj * dson_obj)
 	VeryBigStruct re;
 	if (!dson_obj)
 		return re;
-	auto dson = dynamic_cast<hi::Dson *>(dson_obj);
+	auto dson = hi::dson_cast<hi::Dson>(dson_obj);
 	if (!dson)
 		return re;
 	char * buf = static_cast<char *>(dson->data());
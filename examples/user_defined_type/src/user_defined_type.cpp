@@ -103,7 +103,7 @@ void save_and_load_simple()
 	}
 	auto my_struct_obj = dson2.get(1);
 	assert(my_struct_obj);
-	auto my_struct_dson_obj = dynamic_cast<hi::Dson *>(my_struct_obj);
+	auto my_struct_dson_obj = hi::dson_cast<hi::Dson>(my_struct_obj);
 	assert(my_struct_dson_obj);
 
 	auto my_struct_after = to_my_struct(my_struct_dson_obj);
@@ -0,0 +1,348 @@
+#ifndef DSON_FILE_OBJ_H
+#define DSON_FILE_OBJ_H
+
+#include <dson/impl/dson_obj.h>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+
+namespace hi
+{
+
+/**
+ * @brief The DsonFileObj class
+ * Объект, данные которого - участок файла (fd + offset + size).
+ * Файл не читается в память: copy_to_fd_* передаёт данные через sendfile()
+ * (байты не попадают в user space), с обычной возобновляемой выгрузкой (Result::InProcess)
+ * в неблокирующий сокет.
+ * copy_to_buf_* читает данные сразу в место назначения (pread), copy_to_stream_* - кусками.
+ *
+ * Байты файла выдаются как есть (по умолчанию тип std::string).
+ * Файл должен поддерживать pread() (обычный файл, не pipe) и не должен укорачиваться
+ * пока объект выгружается: иначе выгрузка закончится Result::Error.
+ */
+class DsonFileObj : public DsonObj
+{
+public:
+	/**
+	 * @brief DsonFileObj
+	 * Участок уже открытого файла
+	 * @param key ключ
+	 * @param fd файл (не закрывается объектом, должен жить пока живёт объект)
+	 * @param offset начало участка
+	 * @param size размер участка
+	 * @param data_type тип данных
+	 */
+	DsonFileObj(
+		const DsonKey key,
+		const std::int32_t fd,
+		const std::int64_t offset,
+		const std::int32_t size,
+		const TypeMarker data_type = types_map<std::string>::value)
+		: fd_{fd}
+		, file_offset_{offset}
+	{
+		setup_header(key, size, data_type);
+		if (fd_ < 0 || offset < 0)
+			state_ = State::Error;
+	}
+
+	/**
+	 * @brief DsonFileObj
+	 * Файл целиком: открывается и закрывается объектом
+	 * @note если файл не открылся (или больше 2 Гб) - state() == State::Error
+	 */
+	DsonFileObj(const DsonKey key, const char * path, const TypeMarker data_type = types_map<std::string>::value)
+		: fd_{::open(path, O_RDONLY | O_CLOEXEC)}
+		, own_fd_{true}
+	{
+		std::int32_t size{0};
+		struct stat st;
+		if (fd_ < 0 || ::fstat(fd_, &st) != 0 || st.st_size > std::numeric_limits<std::int32_t>::max())
+		{
+			state_ = State::Error;
+		}
+		else
+		{
+			size = static_cast<std::int32_t>(st.st_size);
+		}
+		setup_header(key, size, data_type);
+	}
+
+	DsonFileObj(const DsonFileObj &) = delete;
+	DsonFileObj & operator=(const DsonFileObj &) = delete;
+
+	~DsonFileObj()
+	{
+		if (own_fd_ && fd_ >= 0)
+			::close(fd_);
+	}
+
+	std::int32_t fd() const noexcept
+	{
+		return fd_;
+	}
+
+	std::int64_t file_offset() const noexcept
+	{
+		return file_offset_;
+	}
+
+public: // DsonObj
+	bool is_host_order() const noexcept override
+	{
+		return true;
+	}
+
+	bool is_network_order() const noexcept override
+	{
+		return mark_host_order == mark_network_order;
+	}
+
+	std::int32_t data_size() const noexcept override
+	{
+		return header_.data_size_;
+	}
+
+	bool is_data_size_fixed() const noexcept override
+	{
+		// Участок задаётся в конструкторе
+		return true;
+	}
+
+	DsonKey key() const noexcept override
+	{
+		return header_.key_;
+	}
+
+	void set_key(DsonKey _key) noexcept override
+	{
+		header_.key_ = _key;
+	}
+
+	TypeMarker data_type() const noexcept override
+	{
+		return header_.data_type_;
+	}
+
+	using DsonObj::copy_to_stream_host_order;
+	using DsonObj::copy_to_stream_network_order;
+
+	void copy_to_stream_host_order(std::ostream & out) override
+	{
+		copy_to_stream_local(out, false);
+	}
+
+	void copy_to_stream_network_order(std::ostream & out) override
+	{
+		copy_to_stream_local(out, true);
+	}
+
+	Result copy_to_fd_host_order(std::int32_t fd) override
+	{
+		if (state_ == State::Ready)
+			start(false);
+		return copy_to_fd_local(fd);
+	}
+
+	Result copy_to_fd_network_order(std::int32_t fd) override
+	{
+		if (state_ == State::Ready)
+			start(true);
+		return copy_to_fd_local(fd);
+	}
+
+	Result copy_to_buf_host_order(char *& buf, std::int32_t & buf_size) override
+	{
+		if (state_ == State::Ready)
+			start(false);
+		return copy_to_buf_local(buf, buf_size);
+	}
+
+	Result copy_to_buf_network_order(char *& buf, std::int32_t & buf_size) override
+	{
+		if (state_ == State::Ready)
+			start(true);
+		return copy_to_buf_local(buf, buf_size);
+	}
+
+	State state() const noexcept override
+	{
+		return state_;
+	}
+
+	void reset_state() noexcept override
+	{
+		// Файл не открылся - это не исправить
+		if (fd_ < 0 || file_offset_ < 0)
+			return;
+		state_ = State::Ready;
+	}
+
+private:
+	void setup_header(const DsonKey key, const std::int32_t size, const TypeMarker data_type)
+	{
+		header_.mark_byte_order_ = mark_host_order;
+		header_.data_size_ = size > 0 ? size : 0;
+		header_.key_ = key;
+		header_.data_type_ = data_type;
+	}
+
+	// Начало выгрузки: заголовок в нужном byte order
+	void start(const bool network_order)
+	{
+		std::memcpy(out_header_, &header_, header_size);
+		if (network_order)
+			header_network_host(std::launder(reinterpret_cast<std::uint32_t *>(out_header_)));
+		state_ = State::CopyingHeader;
+		offset_ = 0;
+	}
+
+	Result fail() noexcept
+	{
+		state_ = State::Error;
+		return Result::Error;
+	}
+
+	void copy_to_stream_local(std::ostream & out, const bool network_order)
+	{
+		if (state_ != State::Ready)
+			return;
+		start(network_order);
+		out.write(out_header_, header_size);
+		char buf[16 * 1024];
+		std::int32_t done{0};
+		while (done < header_.data_size_)
+		{
+			const std::int32_t size = std::min<std::int32_t>(sizeof(buf), header_.data_size_ - done);
+			const auto readed = ::pread(fd_, buf, static_cast<size_t>(size), file_offset_ + done);
+			if (readed <= 0)
+			{
+				out.setstate(std::ios::badbit);
+				break;
+			}
+			out.write(buf, readed);
+			done += static_cast<std::int32_t>(readed);
+		}
+		state_ = State::Ready;
+	}
+
+	Result copy_to_fd_local(std::int32_t fd)
+	{
+		switch (state_)
+		{
+		case State::CopyingHeader:
+			{
+				if (offset_ >= header_size)
+				{
+					assert(false);
+					return Result::Error;
+				}
+				const auto writed = write_to_fd(fd, out_header_ + offset_, header_size - offset_);
+				switch (writed)
+				{
+				case -1:
+					return Result::Error;
+				case 0:
+					return Result::InProcess;
+				default:
+					break;
+				}
+				offset_ += static_cast<std::int32_t>(writed);
+				if (offset_ < header_size)
+					return Result::InProcess;
+				state_ = State::CopyingData;
+				offset_ = 0;
+			}
+			[[fallthrough]];
+		case State::CopyingData:
+			{
+				while (offset_ < header_.data_size_)
+				{
+					std::int64_t file_pos = file_offset_ + offset_;
+					const auto sent = send_file_to_fd(fd, fd_, file_pos, header_.data_size_ - offset_);
+					switch (sent)
+					{
+					case -1:
+						return fail();
+					case 0:
+						return Result::InProcess;
+					default:
+						break;
+					}
+					offset_ += static_cast<std::int32_t>(sent);
+				}
+				state_ = State::Ready;
+				return Result::Ready;
+			}
+		default:
+			break;
+		}
+		return Result::Error;
+	}
+
+	Result copy_to_buf_local(char *& buf, std::int32_t & buf_size)
+	{
+		switch (state_)
+		{
+		case State::CopyingHeader:
+			{
+				if (offset_ >= header_size)
+				{
+					assert(false);
+					return Result::Error;
+				}
+				std::int32_t writed = header_size - offset_;
+				if (writed > buf_size)
+					writed = buf_size;
+				std::memcpy(buf, out_header_ + offset_, writed);
+				offset_ += writed;
+				buf += writed;
+				buf_size -= writed;
+				if (offset_ < header_size)
+					return Result::InProcess;
+				state_ = State::CopyingData;
+				offset_ = 0;
+			}
+			[[fallthrough]];
+		case State::CopyingData:
+			{
+				// Чтение сразу в место назначения
+				while (buf_size > 0 && offset_ < header_.data_size_)
+				{
+					const std::int32_t size = std::min(buf_size, header_.data_size_ - offset_);
+					const auto readed = ::pread(fd_, buf, static_cast<size_t>(size), file_offset_ + offset_);
+					if (readed <= 0)
+						return fail();
+					offset_ += static_cast<std::int32_t>(readed);
+					buf += readed;
+					buf_size -= static_cast<std::int32_t>(readed);
+				}
+				if (offset_ < header_.data_size_)
+					return Result::InProcess;
+				state_ = State::Ready;
+				return Result::Ready;
+			}
+		default:
+			break;
+		}
+		return Result::Error;
+	}
+
+private:
+	// Заголовок в host order
+	Header header_;
+	// Заголовок текущей выгрузки в нужном byte order
+	alignas(Header) char out_header_[sizeof(Header)];
+	const std::int32_t fd_;
+	const std::int64_t file_offset_{0};
+	const bool own_fd_{false};
+};
+
+} // namespace hi
+#endif // DSON_FILE_OBJ_H
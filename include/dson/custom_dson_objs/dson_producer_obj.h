@@ -0,0 +1,333 @@
+#ifndef DSON_PRODUCER_OBJ_H
+#define DSON_PRODUCER_OBJ_H
+
+#include <dson/impl/dson_obj.h>
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace hi
+{
+
+/**
+ * @brief The DsonProducerObj class
+ * Объект, данные которого не хранятся, а генерируются по мере выгрузки.
+ * Размер данных объявляется заранее, байты запрашиваются у producer кусками:
+ * copy_to_buf_* - сразу в место назначения,
+ * copy_to_fd_* и copy_to_stream_* - через буфер размера chunk_size.
+ * Память не зависит от размера данных: выгрузка большого объёма (экспорт)
+ * без материализации всех данных (ср. VeryBigStruct в examples/user_defined_type).
+ *
+ * Байты данных выдаются как есть: byte order данных - забота producer.
+ * Каждая выгрузка запрашивает данные заново, начиная с offset 0.
+ */
+class DsonProducerObj : public DsonObj
+{
+public:
+	/**
+	 * @brief Producer
+	 * Записать в buf следующие байты данных
+	 * @param buf куда писать
+	 * @param size сколько байт нужно (не больше чем осталось до data_size)
+	 * @param offset сколько байт данных уже выдано в этой выгрузке
+	 * @return сколько байт записано (от 1 до size), <= 0 => ошибка, выгрузка прерывается
+	 */
+	using Producer = std::function<std::int32_t(char * buf, std::int32_t size, std::int32_t offset)>;
+
+	static constexpr std::int32_t default_chunk_size{64 * 1024};
+
+	/**
+	 * @brief DsonProducerObj
+	 * @param key ключ
+	 * @param data_type тип данных (например types_map<std::string>::value)
+	 * @param data_size объявленный размер данных: producer обязан выдать ровно столько
+	 * @param producer генератор данных
+	 * @param chunk_size размер буфера для выгрузки в fd и поток
+	 */
+	DsonProducerObj(
+		const DsonKey key,
+		const TypeMarker data_type,
+		const std::int32_t data_size,
+		Producer producer,
+		const std::int32_t chunk_size = default_chunk_size)
+		: producer_{std::move(producer)}
+		, chunk_size_{std::max(chunk_size, header_size)}
+	{
+		header_.mark_byte_order_ = mark_host_order;
+		header_.data_size_ = data_size > 0 ? data_size : 0;
+		header_.key_ = key;
+		header_.data_type_ = data_type;
+	}
+
+public: // DsonObj
+	bool is_host_order() const noexcept override
+	{
+		return true;
+	}
+
+	bool is_network_order() const noexcept override
+	{
+		return mark_host_order == mark_network_order;
+	}
+
+	std::int32_t data_size() const noexcept override
+	{
+		return header_.data_size_;
+	}
+
+	bool is_data_size_fixed() const noexcept override
+	{
+		// Размер объявляется в конструкторе
+		return true;
+	}
+
+	DsonKey key() const noexcept override
+	{
+		return header_.key_;
+	}
+
+	void set_key(DsonKey _key) noexcept override
+	{
+		header_.key_ = _key;
+	}
+
+	TypeMarker data_type() const noexcept override
+	{
+		return header_.data_type_;
+	}
+
+	using DsonObj::copy_to_stream_host_order;
+	using DsonObj::copy_to_stream_network_order;
+
+	void copy_to_stream_host_order(std::ostream & out) override
+	{
+		copy_to_stream_local(out, false);
+	}
+
+	void copy_to_stream_network_order(std::ostream & out) override
+	{
+		copy_to_stream_local(out, true);
+	}
+
+	Result copy_to_fd_host_order(std::int32_t fd) override
+	{
+		if (state_ == State::Ready)
+			start(false);
+		return copy_to_fd_local(fd);
+	}
+
+	Result copy_to_fd_network_order(std::int32_t fd) override
+	{
+		if (state_ == State::Ready)
+			start(true);
+		return copy_to_fd_local(fd);
+	}
+
+	Result copy_to_buf_host_order(char *& buf, std::int32_t & buf_size) override
+	{
+		if (state_ == State::Ready)
+			start(false);
+		return copy_to_buf_local(buf, buf_size);
+	}
+
+	Result copy_to_buf_network_order(char *& buf, std::int32_t & buf_size) override
+	{
+		if (state_ == State::Ready)
+			start(true);
+		return copy_to_buf_local(buf, buf_size);
+	}
+
+	State state() const noexcept override
+	{
+		return state_;
+	}
+
+	void reset_state() noexcept override
+	{
+		state_ = State::Ready;
+		chunk_begin_ = 0;
+		chunk_end_ = 0;
+	}
+
+private:
+	// Начало выгрузки: заголовок в нужном byte order
+	void start(const bool network_order)
+	{
+		std::memcpy(out_header_, &header_, header_size);
+		if (network_order)
+			header_network_host(std::launder(reinterpret_cast<std::uint32_t *>(out_header_)));
+		state_ = State::CopyingHeader;
+		offset_ = 0;
+		produced_ = 0;
+		chunk_begin_ = 0;
+		chunk_end_ = 0;
+	}
+
+	/*
+	 * Запросить у producer до size байт данных в buf
+	 * @return сколько записано, -1 при ошибке producer
+	 */
+	std::int32_t produce(char * buf, const std::int32_t size)
+	{
+		const std::int32_t produced = producer_ ? producer_(buf, size, produced_) : 0;
+		if (produced <= 0 || produced > size)
+		{
+			state_ = State::Error;
+			return -1;
+		}
+		produced_ += produced;
+		return produced;
+	}
+
+	// Дозаполнить буфер данными до chunk_size_
+	bool fill_chunk()
+	{
+		std::int32_t size = std::min(chunk_size_ - chunk_end_, header_.data_size_ - produced_);
+		while (size > 0)
+		{
+			const std::int32_t produced = produce(chunk_.data() + chunk_end_, size);
+			if (produced < 0)
+				return false;
+			chunk_end_ += produced;
+			size -= produced;
+		}
+		return true;
+	}
+
+	void copy_to_stream_local(std::ostream & out, const bool network_order)
+	{
+		if (state_ != State::Ready)
+			return;
+		start(network_order);
+		out.write(out_header_, header_size);
+		chunk_.resize(static_cast<std::size_t>(std::min(chunk_size_, header_.data_size_)));
+		while (produced_ < header_.data_size_)
+		{
+			chunk_end_ = 0;
+			if (!fill_chunk())
+			{
+				out.setstate(std::ios::badbit);
+				reset_state();
+				return;
+			}
+			out.write(chunk_.data(), chunk_end_);
+		}
+		reset_state();
+	}
+
+	Result copy_to_fd_local(std::int32_t fd)
+	{
+		switch (state_)
+		{
+		case State::CopyingHeader:
+			{
+				// Заголовок и первые данные - одним write()
+				chunk_.resize(static_cast<std::size_t>(std::min(chunk_size_, header_size + header_.data_size_)));
+				std::memcpy(chunk_.data(), out_header_, header_size);
+				chunk_begin_ = 0;
+				chunk_end_ = header_size;
+				if (!fill_chunk())
+					return Result::Error;
+				state_ = State::CopyingData;
+			}
+			[[fallthrough]];
+		case State::CopyingData:
+			{
+				for (;;)
+				{
+					if (chunk_begin_ == chunk_end_)
+					{
+						if (produced_ == header_.data_size_)
+						{
+							reset_state();
+							return Result::Ready;
+						}
+						chunk_begin_ = 0;
+						chunk_end_ = 0;
+						if (!fill_chunk())
+							return Result::Error;
+					}
+					const auto writed = write_to_fd(fd, chunk_.data() + chunk_begin_, chunk_end_ - chunk_begin_);
+					switch (writed)
+					{
+					case -1:
+						return Result::Error;
+					case 0:
+						return Result::InProcess;
+					default:
+						break;
+					}
+					chunk_begin_ += static_cast<std::int32_t>(writed);
+				}
+			}
+		default:
+			break;
+		}
+		return Result::Error;
+	}
+
+	Result copy_to_buf_local(char *& buf, std::int32_t & buf_size)
+	{
+		switch (state_)
+		{
+		case State::CopyingHeader:
+			{
+				if (offset_ >= header_size)
+				{
+					assert(false);
+					return Result::Error;
+				}
+				std::int32_t writed = header_size - offset_;
+				if (writed > buf_size)
+					writed = buf_size;
+				std::memcpy(buf, out_header_ + offset_, writed);
+				offset_ += writed;
+				buf += writed;
+				buf_size -= writed;
+				if (offset_ < header_size)
+					return Result::InProcess;
+				state_ = State::CopyingData;
+			}
+			[[fallthrough]];
+		case State::CopyingData:
+			{
+				// Данные генерируются сразу в место назначения
+				while (buf_size > 0 && produced_ < header_.data_size_)
+				{
+					const std::int32_t produced = produce(buf, std::min(buf_size, header_.data_size_ - produced_));
+					if (produced < 0)
+						return Result::Error;
+					buf += produced;
+					buf_size -= produced;
+				}
+				if (produced_ < header_.data_size_)
+					return Result::InProcess;
+				reset_state();
+				return Result::Ready;
+			}
+		default:
+			break;
+		}
+		return Result::Error;
+	}
+
+private:
+	// Заголовок в host order
+	Header header_;
+	// Заголовок текущей выгрузки в нужном byte order
+	alignas(Header) char out_header_[sizeof(Header)];
+	Producer producer_;
+	const std::int32_t chunk_size_;
+	// Буфер выгрузки в fd/поток, выделяется при первой такой выгрузке
+	std::vector<char> chunk_;
+	// Невыгруженная часть chunk_ [chunk_begin_, chunk_end_)
+	std::int32_t chunk_begin_{0};
+	std::int32_t chunk_end_{0};
+	// Сколько байт данных выдал producer в текущей выгрузке
+	std::int32_t produced_{0};
+};
+
+} // namespace hi
+#endif // DSON_PRODUCER_OBJ_H
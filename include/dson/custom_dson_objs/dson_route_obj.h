@@ -9,8 +9,11 @@ namespace hi
 class DsonRouteObj : public DsonObj
 {
 public:
+	static constexpr Kind obj_kind{Kind::RouteObj};
+
 	template <typename K>
 	DsonRouteObj(K key)
+		: DsonObj{obj_kind}
 	{
 		setup_header(static_cast<DsonKey>(key));
 	}
@@ -86,6 +89,7 @@ public:
 	 */
 	template <typename K>
 	DsonRouteObj(K key, Address * from)
+		: DsonObj{obj_kind}
 	{
 		setup_header(static_cast<std::int32_t>(key));
 		set_reverse_address(from);
@@ -107,6 +111,11 @@ public: // DsonObj
 		return static_cast<std::int32_t>(sizeof(Address));
 	}
 
+	bool is_data_size_fixed() const noexcept override
+	{
+		return true;
+	}
+
 	DsonKey key() const noexcept override
 	{
 		Header * _header = header();
@@ -133,13 +142,16 @@ public: // DsonObj
 		return types_map<std::vector<std::uint32_t>>::value;
 	}
 
-	void copy_to_stream_host_order(std::ofstream & out) override
+	using DsonObj::copy_to_stream_host_order;
+	using DsonObj::copy_to_stream_network_order;
+
+	void copy_to_stream_host_order(std::ostream & out) override
 	{
 		to_host_order();
 		copy_to_stream_local(out);
 	}
 
-	void copy_to_stream_network_order(std::ofstream & out) override
+	void copy_to_stream_network_order(std::ostream & out) override
 	{
 		to_network_order();
 		copy_to_stream_local(out);
@@ -233,11 +245,7 @@ private:
 		if (is_host_order())
 			return;
 		// Сразу преобразую весь буфер
-		std::uint32_t * array = std::launder(reinterpret_cast<std::uint32_t *>(buf_));
-		for (std::int32_t i = 0; i < buf_array_len; ++i)
-		{
-			array[i] = ntohl(array[i]);
-		}
+		array32_network_host(std::launder(reinterpret_cast<std::uint32_t *>(buf_)), buf_array_len);
 	}
 
 	void to_network_order()
@@ -245,16 +253,12 @@ private:
 		if (is_network_order())
 			return;
 		// Сразу преобразую весь буфер
-		std::uint32_t * array = std::launder(reinterpret_cast<std::uint32_t *>(buf_));
-		for (std::int32_t i = 0; i < buf_array_len; ++i)
-		{
-			array[i] = htonl(array[i]);
-		}
+		array32_network_host(std::launder(reinterpret_cast<std::uint32_t *>(buf_)), buf_array_len);
 	}
 
-	void copy_to_stream_local(std::ofstream & out) const
+	void copy_to_stream_local(std::ostream & out) const
 	{
-		std::copy(buf_, buf_ + header_size_address_size, std::ostream_iterator<char>(out));
+		out.write(buf_, header_size_address_size);
 	}
 
 	Result copy_to_fd_local(std::int32_t fd)
@@ -327,12 +331,12 @@ DsonRouteObj::Address * to_address(DsonObj * obj)
 {
 	if (!obj)
 		return nullptr;
-	if (auto dson = dynamic_cast<Dson *>(obj))
+	if (auto dson = dson_cast<Dson>(obj))
 	{
 		Dson::converters().to_host(*dson);
 		return static_cast<DsonRouteObj::Address *>(dson->data());
 	}
-	if (auto dson = dynamic_cast<DsonRouteObj *>(obj))
+	if (auto dson = dson_cast<DsonRouteObj>(obj))
 	{
 		return dson->address();
 	}
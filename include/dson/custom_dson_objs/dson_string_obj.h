@@ -11,8 +11,11 @@ namespace hi
 class DsonStringObj : public DsonObj
 {
 public:
+	static constexpr Kind obj_kind{Kind::StringObj};
+
 	DsonStringObj(const DsonKey key, std::string && object)
-		: object_{std::move(object)}
+		: DsonObj{obj_kind}
+		, object_{std::move(object)}
 	{
 		setup_header(key);
 	}
@@ -46,6 +49,12 @@ public: // DsonObj
 		return int32_to_host(header_as_array()[1]);
 	}
 
+	bool is_data_size_fixed() const noexcept override
+	{
+		// Строка задаётся только в конструкторе
+		return true;
+	}
+
 	DsonKey key() const noexcept override
 	{
 		Header * _header = header();
@@ -75,13 +84,16 @@ public: // DsonObj
 		return int32_to_host(header_as_array()[3]);
 	}
 
-	void copy_to_stream_host_order(std::ofstream & out) override
+	using DsonObj::copy_to_stream_host_order;
+	using DsonObj::copy_to_stream_network_order;
+
+	void copy_to_stream_host_order(std::ostream & out) override
 	{
 		prepare_header_host_order();
 		copy_to_stream_local(out);
 	}
 
-	void copy_to_stream_network_order(std::ofstream & out) override
+	void copy_to_stream_network_order(std::ostream & out) override
 	{
 		prepare_header_network_order();
 		copy_to_stream_local(out);
@@ -164,28 +176,20 @@ private:
 	{
 		if (is_host_order())
 			return;
-		std::uint32_t * _header = header_as_array();
-		for (std::int32_t i = 0; i < header_array_len; ++i)
-		{
-			_header[i] = ntohl(_header[i]);
-		}
+		header_network_host(header_as_array());
 	}
 
 	void prepare_header_network_order()
 	{
 		if (is_network_order())
 			return;
-		std::uint32_t * _header = header_as_array();
-		for (std::int32_t i = 0; i < header_array_len; ++i)
-		{
-			_header[i] = htonl(_header[i]);
-		}
+		header_network_host(header_as_array());
 	}
 
-	void copy_to_stream_local(std::ofstream & out) const
+	void copy_to_stream_local(std::ostream & out) const
 	{
-		std::copy(header_, header_ + header_size, std::ostream_iterator<char>(out));
-		std::copy(object_.begin(), object_.end(), std::ostream_iterator<char>(out));
+		out.write(header_, header_size);
+		out.write(object_.data(), static_cast<std::streamsize>(object_.size()));
 	}
 
 	Result copy_to_fd_local(std::int32_t fd)
@@ -1,13 +1,22 @@
 #ifndef DSON_H
 #define DSON_H
 
+#include <dson/impl/dson_arena.h>
 #include <dson/impl/dson_obj.h>
+#include <dson/impl/dson_sink.h>
+#include <dson/impl/flat_map.h>
 
+#include <algorithm>
+#include <array>
 #include <cstdlib> // malloc
 #include <cstring> // memcpy
 #include <functional>
+#include <iterator>
 #include <map>
 #include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #ifndef MAX_DSON_RAM_SIZE
 #	define MAX_DSON_RAM_SIZE (1024 * 1024 * 1024)
@@ -19,6 +28,8 @@ namespace hi
 class Dson : public DsonObj
 {
 public:
+	static constexpr Kind obj_kind{Kind::Dson};
+
 	Dson()
 	{
 		clear_header();
@@ -26,6 +37,8 @@ public:
 
 	~Dson()
 	{
+		// Удаляет родитель: он сам поправит свои счётчики
+		parent_ = nullptr;
 		clear();
 	}
 
@@ -33,7 +46,8 @@ public:
 	 * @brief Dson
 	 * Работа ака std::string_view - окно на буфер.
 	 * Буфер представляется в виде Dson.
-	 * Если попытаться смувать, то буфер скопируется в новую аллокацию.
+	 * При move вьюха остаётся вьюхой на тот же буфер: буфер должен жить пока живёт Dson.
+	 * Если Dson нужно удерживать дольше буфера - см. Dson(std::shared_ptr<char> buf)
 	 * (например для передачи Dson в библиотеки лучше использовать to_buf_host_order())
 	 * @param buf
 	 */
@@ -44,24 +58,38 @@ public:
 		pre_parse_buf();
 	}
 
-	Dson(const Dson & other) = delete;
-	Dson(Dson && other) noexcept
+	/**
+	 * @brief Dson
+	 * Вьюха на буфер с подсчётом ссылок: буфер живёт пока на него смотрит хоть один Dson.
+	 * Дочерние вьюхи (после разбора) держат тот же буфер, поэтому их можно
+	 * мувать (в очередь отправки, в колбэк Router) и удерживать без копирования.
+	 * @param buf буфер, начинается с заголовка
+	 */
+	explicit Dson(std::shared_ptr<char> buf)
+		: buf_{buf.get()}
+		, buf_owner_{std::move(buf)}
+		, dson_kind_{DsonKind::DataBufNeedParse}
 	{
-		move_from_other(std::move(other));
+		pre_parse_buf();
 	}
 
 	/**
 	 * @brief Dson
-	 * Когда необходимо DsonKind::OneObjectInDataBuf
-	 * перекинуть в key_to_val_map_
-	 * @param header
-	 * @param buf
+	 * Буфер данных и узлы дочерних объектов при разборе берутся из арены.
+	 * Память возвращается арене целиком при clear(), если её не держат смуванные из этого Dson
+	 * сообщения (например сообщение было смувано в очередь отправки и ещё не отправлено).
+	 * @param arena арена, обычно одна на соединение
 	 */
-	Dson(char * header, char * buf)
-		: buf_{buf}
-		, dson_kind_{DsonKind::OneObjectInDataBuf}
+	explicit Dson(std::shared_ptr<DsonArena> arena)
+		: arena_{std::move(arena)}
+	{
+		clear_header();
+	}
+
+	Dson(const Dson & other) = delete;
+	Dson(Dson && other) noexcept
 	{
-		std::memcpy(header_, header, header_size);
+		move_from_other(std::move(other));
 	}
 
 	Dson & operator=(const Dson & other) = delete;
@@ -69,23 +97,69 @@ public:
 	{
 		if (&other == this)
 			return *this;
+		clear();
 		move_from_other(std::move(other));
 		return *this;
 	}
 
+	/**
+	 * Узлы Dson могут размещаться в арене (см. DsonArena).
+	 * Перед каждым узлом хранится указатель на арену (nullptr для кучи),
+	 * чтобы delete через std::unique_ptr<DsonObj> знал куда возвращать память.
+	 */
+	static void * operator new(std::size_t size)
+	{
+		return allocate_node(size, nullptr);
+	}
+
+	static void * operator new(std::size_t size, DsonArena * arena)
+	{
+		return allocate_node(size, arena);
+	}
+
+	static void operator delete(void * ptr) noexcept
+	{
+		deallocate_node(ptr);
+	}
+
+	static void operator delete(void * ptr, DsonArena *) noexcept
+	{
+		deallocate_node(ptr);
+	}
+
+	/**
+	 * @brief set_arena
+	 * Назначить арену из которой будут выделяться буфер и узлы детей.
+	 * Текущее содержимое очищается.
+	 * @param arena арена или nullptr чтобы работать с кучей
+	 */
+	void set_arena(std::shared_ptr<DsonArena> arena)
+	{
+		clear();
+		arena_ = std::move(arena);
+	}
+
+	const std::shared_ptr<DsonArena> & arena() const noexcept
+	{
+		return arena_;
+	}
+
 	template <typename T>
 	Dson(T data);
 
+	// Хранилище дочерних объектов контейнера: ключ->объект, упорядочено по ключу
+	using ObjectsMap = FlatMap<DsonKey, std::unique_ptr<DsonObj>>;
+
 	void * init(std::int32_t data_type, std::int32_t data_size)
 	{
 		clear();
-		char * ptr = allocate(data_size);
-		if (!ptr)
-			return {};
 		Header * _header = header();
 		_header->mark_byte_order_ = mark_host_order;
 		_header->data_type_ = data_type;
 		_header->data_size_ = data_size;
+		char * ptr = allocate(data_size);
+		if (!ptr)
+			return {};
 		dson_kind_ = DsonKind::OneObjectInDataBuf;
 		return ptr;
 	}
@@ -109,14 +183,14 @@ public:
 	void * init(std::int32_t key, std::int32_t data_type, std::int32_t data_size)
 	{
 		clear();
-		char * ptr = allocate(data_size);
-		if (!ptr)
-			return {};
 		Header * _header = header();
 		_header->mark_byte_order_ = mark_host_order;
 		_header->key_ = key;
 		_header->data_type_ = data_type;
 		_header->data_size_ = data_size;
+		char * ptr = allocate(data_size);
+		if (!ptr)
+			return {};
 		dson_kind_ = DsonKind::OneObjectInDataBuf;
 		return ptr;
 	}
@@ -125,48 +199,178 @@ public:
 	 * @brief map
 	 * Доступ к содержимому Dson для поиска и итерации
 	 * @return map ключ->объект
+	 * @note все дети переводятся в host order при первом вызове, повторные вызовы (пока дети
+	 * не менялись) их не обходят. Если нужны не все дети - см. children()
 	 */
-	const std::map<std::int32_t, std::unique_ptr<DsonObj>> & map()
+	const ObjectsMap & map()
 	{
-		if (state_ != State::Ready)
+		if (!prepare_children())
+			return key_to_val_map_;
+		if (children_host_order_)
 			return key_to_val_map_;
-		switch (dson_kind_)
-		{
-		case DsonKind::DataBufNeedParse:
-			parse_buf();
-			break;
-		case DsonKind::OneObjectInDataBuf:
-			one_object_buf_to_container();
-			break;
-		default:
-			break;
-		}
 		// Внешний доступ всегда предполагает host order для всех элементов
 		auto & _converters = converters();
 		for (auto & it : key_to_val_map_)
 		{
-			if (auto dson = dynamic_cast<Dson *>(it.second.get()))
+			if (auto dson = dson_cast<Dson>(it.second.get()))
 			{
 				_converters.to_host(*dson);
 			}
 		}
+		children_host_order_ = true;
 
 		return key_to_val_map_;
 	}
 
+	/**
+	 * @brief The Children class
+	 * Обход детей с переводом в host order только тех, к кому обратились
+	 * (см. children())
+	 */
+	class Children
+	{
+	public:
+		class iterator
+		{
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = std::pair<DsonKey, DsonObj *>;
+			using difference_type = std::ptrdiff_t;
+			using pointer = void;
+			using reference = value_type;
+
+			explicit iterator(ObjectsMap::iterator it)
+				: it_{it}
+			{
+			}
+
+			// Ребёнок переводится в host order при разыменовании
+			value_type operator*() const
+			{
+				return {it_->first, to_host(it_->second.get())};
+			}
+
+			DsonKey key() const noexcept
+			{
+				return it_->first;
+			}
+
+			iterator & operator++() noexcept
+			{
+				++it_;
+				return *this;
+			}
+
+			bool operator==(const iterator & other) const noexcept
+			{
+				return it_ == other.it_;
+			}
+
+			bool operator!=(const iterator & other) const noexcept
+			{
+				return it_ != other.it_;
+			}
+
+		private:
+			ObjectsMap::iterator it_;
+		};
+
+		explicit Children(ObjectsMap & map)
+			: map_{map}
+		{
+		}
+
+		iterator begin() const noexcept
+		{
+			return iterator{map_.begin()};
+		}
+
+		iterator end() const noexcept
+		{
+			return iterator{map_.end()};
+		}
+
+		std::size_t size() const noexcept
+		{
+			return map_.size();
+		}
+
+		bool empty() const noexcept
+		{
+			return map_.empty();
+		}
+
+		// Ребёнок по ключу в host order (nullptr если нет)
+		DsonObj * find(const DsonKey key) const
+		{
+			auto it = map_.find(key);
+			if (it == map_.end())
+				return nullptr;
+			return to_host(it->second.get());
+		}
+
+	private:
+		static DsonObj * to_host(DsonObj * obj) noexcept
+		{
+			if (auto dson = dson_cast<Dson>(obj))
+				converters().to_host(*dson);
+			return obj;
+		}
+
+		ObjectsMap & map_;
+	};
+
+	/**
+	 * @brief children
+	 * Обход детей без перевода всех в host order: ребёнок переводится при обращении к нему,
+	 * ключи доступны без перевода (например логирование ключей и пары полей сообщения):
+	 *  for (auto [key, obj] : dson.children())
+	 * @note представление действительно пока дети не добавляются и не удаляются
+	 */
+	Children children()
+	{
+		prepare_children();
+		return Children{key_to_val_map_};
+	}
+
 	void clear()
 	{
+		// Сначала дети: их узлы могут лежать в арене
+		copy_index_ = 0;
+		if (extra_)
+			extra_->reset();
+		children_host_order_ = false;
+		key_to_val_map_.clear();
+		add_volatile_children(-volatile_children_);
+		invalidate_caches();
+
 		if (was_buf_allocation_)
 		{
-			std::free(buf_);
-			buf_ = nullptr;
+			// Буфер под счётчиком ссылок освобождает последний владелец
+			if (!buf_from_arena_ && !is_buf_inline() && !buf_owner_)
+				std::free(buf_);
 			was_buf_allocation_ = false;
+			buf_from_arena_ = false;
 		}
+		// Вьюха на внешний буфер: буфер мог быть уже освобождён, заголовок остаётся из header_
+		buf_ = nullptr;
 		buf_size_ = 0;
+		buf_owner_.reset();
+		buf_mapped_ = false;
 		dson_kind_ = DsonKind::DsonContainer;
+		index_.clear();
+		indexed_ = false;
 
-		copy_iter_ = {};
-		key_to_val_map_.clear();
+		if (borrowed_arena_)
+		{
+			borrowed_arena_->release();
+			borrowed_arena_.reset();
+		}
+		if (arena_ && !arena_->is_borrowed())
+		{
+			// Никто больше не ссылается на память арены
+			arena_->reset();
+		}
 
 		state_ = State::Ready;
 	}
@@ -196,8 +400,7 @@ public:
 	{
 		const std::int32_t k = static_cast<std::int32_t>(key);
 		obj.set_key(k);
-		auto ptr = std::make_unique<Dson>(std::move(obj));
-		insert_internal(k, std::move(ptr));
+		insert_internal(k, make_node(std::move(obj)));
 	}
 
 	template <typename K, typename T>
@@ -221,13 +424,18 @@ public:
 	template <typename K>
 	DsonObj * get(K _key)
 	{
+		if (state_ != State::Ready)
+			return {};
+		const std::int32_t k = static_cast<std::int32_t>(_key);
 		if (DsonKind::DataBufNeedParse == dson_kind_)
 		{
+			if (data_type() == types_map<DsonContainer>::value)
+			{
+				// Дочерний объект создаётся только для запрошенного ключа
+				return get_lazy(k);
+			}
 			parse_buf();
 		}
-		if (state_ != State::Ready)
-			return {};
-		const std::int32_t k = static_cast<std::int32_t>(_key);
 		switch (dson_kind_)
 		{
 		case DsonKind::OneObjectInDataBuf:
@@ -252,13 +460,62 @@ public:
 		return get(key);
 	}
 
+	/**
+	 * Поле контейнера в том виде, как оно лежит в буфере.
+	 * Для только что загруженного Dson - без создания дочернего объекта
+	 * (данные могут быть в network byte order, буфер не меняется).
+	 */
+	struct RawField
+	{
+		TypeMarker data_type{types_map<Empty>::value};
+		std::int32_t data_size{0};
+		// false => данные в network byte order
+		bool host_order{true};
+		// nullptr => поле не найдено или это не Dson (тогда доступ через get())
+		const char * data{nullptr};
+	};
+
+	/**
+	 * @brief raw_field
+	 * Доступ к данным поля без создания дочернего Dson.
+	 * Используется преобразователями скаляров из <dson/from_dson_converters.h>
+	 * @param _key - искомый ключ
+	 * @return RawField, data == nullptr если не найдено
+	 */
+	template <typename K>
+	RawField raw_field(K _key)
+	{
+		if (state_ != State::Ready)
+			return {};
+		const std::int32_t k = static_cast<std::int32_t>(_key);
+		if (DsonKind::DataBufNeedParse == dson_kind_ && data_type() == types_map<DsonContainer>::value)
+		{
+			if (!index_buf())
+				return {};
+			if (key_to_val_map_.find(k) == key_to_val_map_.end())
+			{
+				const ChildIndex * child = find_index(k);
+				if (!child)
+					return {};
+				const char * ptr = static_cast<char *>(data()) + child->offset_;
+				const bool host_order = std::launder(reinterpret_cast<const Header *>(ptr))->mark_byte_order_
+					== mark_host_order;
+				return {child->data_type_, child->data_size_, host_order, ptr + header_size};
+			}
+		}
+		auto dson = dson_cast<Dson>(get(k));
+		if (!dson)
+			return {};
+		return {dson->data_type(), dson->data_size(), dson->is_host_order(), static_cast<char *>(dson->data())};
+	}
+
 	/**
 	 * @brief load_from_stream
-	 * Загрузка из ifstream
-	 * @param input - ifstream
+	 * Загрузка из потока (файл, std::stringstream и т.п.)
+	 * @param input - поток
 	 * @note загрузка происходит разом всего объёма
 	 */
-	void load_from_stream(std::ifstream & input)
+	void load_from_stream(std::istream & input)
 	{
 		clear();
 		if (!input.read(header_, header_size))
@@ -293,6 +550,102 @@ public:
 		state_ = State::Ready;
 	}
 
+	/**
+	 * @brief map_file
+	 * Dson из файла через mmap: Dson становится вьюхой DataBufNeedParse на отображение файла,
+	 * данные не читаются заранее - страницы подгружаются при обращении к ним.
+	 * Время открытия и RSS не зависят от размера файла (читается то, к чему обращались).
+	 * Отображение живёт пока живёт Dson (снимается в clear(), переезжает при move).
+	 * @param path путь к файлу (в файле Dson, например записанный через operator<<)
+	 * @param advice подсказка ядру: Random для чтения нескольких ключей, Sequential для чтения подряд
+	 * @return Result::Ready или Result::Error (файла нет, размер не совпадает с заголовком)
+	 * @note отображение copy-on-write: перевод данных в host order не меняет файл
+	 */
+	Result map_file(const char * path, MappedFile::Advice advice = MappedFile::Advice::Random)
+	{
+		clear();
+		auto mapping = std::make_shared<MappedFile>();
+		if (!mapping->map(path, advice) || mapping->size() < header_size)
+		{
+			state_ = State::Error;
+			return Result::Error;
+		}
+		const Header header = header_to_host_copy(mapping->data());
+		if (header.mark_byte_order_ != mark_host_order || header.data_size_ < 0
+			|| header.data_size_ > MAX_DSON_RAM_SIZE || header_size + header.data_size_ > mapping->size())
+		{
+			state_ = State::Error;
+			return Result::Error;
+		}
+		buf_ = mapping->data();
+		// Отображение держат этот Dson и все дочерние вьюхи
+		buf_owner_ = std::shared_ptr<char>(std::move(mapping), buf_);
+		buf_mapped_ = true;
+		pre_parse_buf();
+		return state_ == State::Error ? Result::Error : Result::Ready;
+	}
+
+	// Dson - вьюха на файл, отображённый через map_file() (или дочерняя вьюха такого Dson)
+	bool is_mapped() const noexcept
+	{
+		return buf_mapped_;
+	}
+
+	/**
+	 * @brief is_buf_shared
+	 * Буфер под счётчиком ссылок: move и удержание Dson не копируют данные
+	 * @note вьюха на буфер арены тоже не копирует данные, но держит арену, а не счётчик буфера
+	 */
+	bool is_buf_shared() const noexcept
+	{
+		return buf_owner_ != nullptr;
+	}
+
+	/**
+	 * @brief cache_encoded
+	 * Кэшировать закодированный вид (заголовок + данные) в том byte order, в котором
+	 * узел выгружали: повторная выгрузка без изменений - один memcpy / write() без обхода дерева.
+	 * Кэш сбрасывается при emplace(), set_key(), clear() и изменении любого дочернего Dson.
+	 * Нужен для редко меняющихся объектов, которые отправляются много раз.
+	 * @param enable false - выключить и освободить память кэша
+	 * @note изменения, о которых Dson не узнает (запись через data(), изменение
+	 * пользовательских DsonObj детей с фиксированным размером), сбрасываются через invalidate_encoded().
+	 * Пока есть дети с нефиксированным размером (см. DsonObj::is_data_size_fixed()), кэш не используется.
+	 */
+	void cache_encoded(bool enable = true)
+	{
+		if (!enable)
+		{
+			if (!extra_)
+				return;
+			if (extra_->copying_encoded_)
+			{
+				// Незаконченная выгрузка из кэша
+				extra_->copying_encoded_ = false;
+				state_ = State::Ready;
+			}
+			extra_->encoded_.reset();
+		}
+		else if (!encoded_cache())
+		{
+			extra().encoded_ = std::make_unique<EncodedCache>();
+		}
+	}
+
+	bool is_encoded_cached() const noexcept
+	{
+		return encoded_cache() != nullptr;
+	}
+
+	/**
+	 * @brief invalidate_encoded
+	 * Сообщить об изменении, о котором Dson узнать не может (см. cache_encoded())
+	 */
+	void invalidate_encoded() noexcept
+	{
+		invalidate_caches();
+	}
+
 	/**
 	 * @brief load_from_fd
 	 * POSIX чтение из fd (сеть/файл/pipe/..)
@@ -302,6 +655,147 @@ public:
 	 * @note итераторы хранятся внутри - чтобы сбросить: reset()
 	 */
 	Result load_from_fd(const std::int32_t fd)
+	{
+		return load_from_fd_internal(fd, nullptr, 0);
+	}
+
+	/**
+	 * @brief load_from_fd
+	 * POSIX чтение из fd с приёмником для больших сообщений:
+	 * если данных сообщения не меньше threshold, они не аллоцируются в Dson,
+	 * а передаются в sink по мере чтения (буфер, файл через splice(), колбэк),
+	 * например загрузка большого файла пишется сразу на диск.
+	 * Такое сообщение может быть и больше MAX_DSON_RAM_SIZE.
+	 * @param fd дескриптор
+	 * @param sink приёмник (один и тот же на все вызовы до Result::Ready)
+	 * @param threshold с какого размера данных использовать sink
+	 * @return Result
+	 * @note после загрузки в sink Dson пустой (только ключ сообщения), is_data_in_sink() == true;
+	 * заголовок сообщения приёмник получает в DsonSink::begin()
+	 */
+	Result load_from_fd(const std::int32_t fd, DsonSink & sink, const std::int32_t threshold)
+	{
+		return load_from_fd_internal(fd, &sink, threshold);
+	}
+
+	// Данные последнего загруженного сообщения ушли в DsonSink (см. load_from_fd(fd, sink, threshold))
+	bool is_data_in_sink() const noexcept
+	{
+		return extra_ && extra_->data_in_sink_;
+	}
+
+	// Нужен ли ребёнок с таким ключом (см. set_load_filter())
+	using KeyFilter = std::function<bool(DsonKey key)>;
+
+	/**
+	 * @brief set_load_filter
+	 * Загружать из fd только нужных детей верхнего уровня контейнера:
+	 * остальные дети вычитываются из fd и отбрасываются без аллокаций,
+	 * память и разбор сообщения зависят только от того что будет прочитано.
+	 * Каждый нужный ребёнок загружается в свой узел (с арены, если она задана).
+	 * Фильтр действует на все следующие load_from_fd() (кроме сообщений, ушедших в DsonSink)
+	 * и остаётся в этом Dson при move загруженного сообщения.
+	 * @param filter nullptr - загружать всё
+	 * @note для load_from_buf() не нужен: дети контейнера в буфере создаются только при get()
+	 */
+	void set_load_filter(KeyFilter filter)
+	{
+		if (!filter)
+		{
+			if (extra_)
+				extra_->filtered_.reset();
+			return;
+		}
+		std::unique_ptr<FilteredLoad> & filtered = extra().filtered_;
+		if (!filtered)
+			filtered = std::make_unique<FilteredLoad>();
+		filtered->filter_ = std::move(filter);
+	}
+
+	// Загружать только детей с ключами из keys (см. set_load_filter(KeyFilter))
+	void set_load_filter(std::vector<DsonKey> keys)
+	{
+		std::sort(keys.begin(), keys.end());
+		set_load_filter(
+			[keys = std::move(keys)](const DsonKey key)
+			{
+				return std::binary_search(keys.begin(), keys.end(), key);
+			});
+	}
+
+	/**
+	 * @brief has_child_objects
+	 * Созданы ли дочерние объекты (get(), map(), emplace()): пока нет,
+	 * дети лежат только в буфере и их можно взять через next_loaded()
+	 */
+	bool has_child_objects() const noexcept
+	{
+		return !key_to_val_map_.empty();
+	}
+
+	/**
+	 * @brief next_loaded
+	 * Потоковый разбор контейнера: следующий ребёнок верхнего уровня, чьи байты уже пришли.
+	 * Доступен пока загрузка ещё идёт (load_from_fd()/load_from_buf() вернули Result::InProcess),
+	 * например можно начать маршрутизацию по первым полям, пока хвост сообщения ещё в пути:
+	 *  while (dson.load_from_fd(fd) != Result::Error)
+	 *      while (dson.next_loaded(child))
+	 *          обработка child;
+	 * После Result::Ready выдаются оставшиеся дети, загруженный Dson доступен целиком как обычно.
+	 * @param child сюда кладётся вьюха на ребёнка (предыдущее содержимое очищается)
+	 * @return false если следующий ребёнок ещё не загружен или выданы все
+	 * @note каждый ребёнок выдаётся один раз, новая загрузка (и clear()) начинает выдачу сначала
+	 * @note ребёнок держит буфер сообщения счётчиком ссылок
+	 * (буфер арены - через DsonArena::borrow(), см. share_buf_with())
+	 */
+	bool next_loaded(Dson & child)
+	{
+		if (loading_to_sink() || loading_filtered() || data_type() != types_map<DsonContainer>::value)
+			return false;
+		const std::int32_t streamed = this->streamed();
+		std::int32_t loaded{0};
+		if (state_ == State::LoadingData)
+		{
+			loaded = offset_;
+		}
+		else if (state_ == State::Ready && dson_kind_ == DsonKind::DataBufNeedParse)
+		{
+			loaded = data_size();
+		}
+		else
+		{
+			return false;
+		}
+		if (loaded - streamed < header_size)
+			return false;
+		char * ptr = static_cast<char *>(data()) + streamed;
+		const Header header = header_to_host_copy(ptr);
+		if (header.key_ < 0 || header.data_size_ < 0 || header.data_size_ > data_size() - streamed - header_size)
+		{
+			// Повреждённый буфер: ошибку покажет разбор всего сообщения
+			return false;
+		}
+		const std::int32_t size = header_size + header.data_size_;
+		if (size > loaded - streamed)
+			return false;
+		child = Dson{ptr};
+		share_buf_with(child);
+		extra().streamed_ += size;
+		return true;
+	}
+
+	/**
+	 * @brief streamed
+	 * Сколько байт данных уже выдано детьми через next_loaded()
+	 * @return 0 если потоковый разбор не начинался
+	 */
+	std::int32_t streamed() const noexcept
+	{
+		return extra_ ? extra_->streamed_ : 0;
+	}
+
+private:
+	Result load_from_fd_internal(const std::int32_t fd, DsonSink * sink, const std::int32_t threshold)
 	{
 		switch (state_)
 		{
@@ -339,7 +833,8 @@ public:
 					return Result::InProcess;
 				}
 				const std::int32_t size = data_size();
-				if (size < 0 || size > MAX_DSON_RAM_SIZE)
+				const bool to_sink = sink && size > 0 && size >= threshold;
+				if (size < 0 || (size > MAX_DSON_RAM_SIZE && !to_sink))
 				{
 					state_ = State::Error;
 					return Result::Error;
@@ -350,10 +845,29 @@ public:
 					dson_kind_ = DsonKind::DsonContainer;
 					return Result::Ready;
 				}
-				char * buf = allocate(size);
-				if (!buf)
+				if (to_sink)
 				{
-					state_ = State::Error;
+					if (!sink->begin(header_to_host_copy(header_)))
+					{
+						state_ = State::Error;
+						return Result::Error;
+					}
+					extra().loading_to_sink_ = true;
+					offset_ = 0;
+					state_ = State::LoadingData;
+					return load_to_sink(fd, sink);
+				}
+				if (filtered() && data_type() == types_map<DsonContainer>::value)
+				{
+					filtered()->start();
+					offset_ = 0;
+					state_ = State::LoadingData;
+					return load_filtered(fd);
+				}
+				char * buf = allocate(size);
+				if (!buf)
+				{
+					state_ = State::Error;
 					return Result::Error;
 				}
 				offset_ = 0;
@@ -362,6 +876,10 @@ public:
 			[[fallthrough]];
 		case State::LoadingData:
 			{
+				if (loading_to_sink())
+					return load_to_sink(fd, sink);
+				if (loading_filtered())
+					return load_filtered(fd);
 				if (offset_ >= buf_size_)
 				{
 					assert(false);
@@ -386,6 +904,143 @@ public:
 		return Result::Error;
 	}
 
+	bool loading_filtered() const noexcept
+	{
+		const FilteredLoad * load = filtered();
+		return load && load->active_;
+	}
+
+	Result fail_filtered() noexcept
+	{
+		filtered()->reset();
+		state_ = State::Error;
+		return Result::Error;
+	}
+
+	// Загруженный нужный ребёнок переходит в контейнер
+	void adopt_filtered_child()
+	{
+		FilteredLoad & load = *filtered();
+		const DsonKey _key = load.child_->key();
+		load.child_->detach_arena();
+		load.child_->parent_ = this;
+		key_to_val_map_.insert_or_assign(_key, std::move(load.child_));
+	}
+
+	/*
+	 * Загрузка контейнера с фильтром ключей (см. set_load_filter()):
+	 * заголовок каждого ребёнка читается отдельно, нужный ребёнок дочитывается
+	 * своим узлом, ненужный пропускается.
+	 * offset_ - сколько данных сообщения разобрано (включая ещё загружаемого ребёнка)
+	 */
+	Result load_filtered(const std::int32_t fd)
+	{
+		FilteredLoad & load = *filtered();
+		const std::int32_t size = data_size();
+		for (;;)
+		{
+			if (load.child_)
+			{
+				const Result result = load.child_->load_from_fd(fd);
+				if (result == Result::Error)
+					return fail_filtered();
+				if (result == Result::InProcess)
+					return Result::InProcess;
+				adopt_filtered_child();
+				continue;
+			}
+			if (load.skip_ > 0)
+			{
+				char scratch[4 * 1024];
+				const auto readed = read_from_fd(fd, scratch, std::min<std::int32_t>(load.skip_, sizeof(scratch)));
+				if (readed < 0)
+					return fail_filtered();
+				if (readed == 0)
+					return Result::InProcess;
+				load.skip_ -= static_cast<std::int32_t>(readed);
+				continue;
+			}
+			if (offset_ == size)
+				break;
+			if (size - offset_ < header_size)
+				return fail_filtered();
+			const auto readed = read_from_fd(fd, load.header_ + load.header_offset_, header_size - load.header_offset_);
+			if (readed < 0)
+				return fail_filtered();
+			load.header_offset_ += static_cast<std::int32_t>(readed);
+			if (load.header_offset_ < header_size)
+				return Result::InProcess;
+			load.header_offset_ = 0;
+			const Header header = header_to_host_copy(load.header_);
+			if (header.data_size_ < 0 || header.data_size_ > size - offset_ - header_size)
+				return fail_filtered();
+			offset_ += header_size + header.data_size_;
+			if (!load.filter_(header.key_))
+			{
+				load.skip_ = header.data_size_;
+				continue;
+			}
+			/*
+			 * Заголовок уже прочитан: ребёнок начинает загрузку с него.
+			 * Данные ребёнка выделяются из арены родителя только на время загрузки:
+			 * владеет (и сбрасывает) арену родитель.
+			 */
+			load.child_ = make_node(arena_);
+			std::int32_t consumed{0};
+			const Result result = load.child_->load_from_buf_copy(load.header_, header_size, consumed);
+			if (result == Result::Error)
+				return fail_filtered();
+			// Ребёнок без данных (пустая строка, пустой контейнер) загружен одним заголовком
+			if (result == Result::Ready)
+				adopt_filtered_child();
+		}
+		load.active_ = false;
+		dson_kind_ = DsonKind::DsonContainer;
+		invalidate_caches();
+		state_ = State::Ready;
+		return Result::Ready;
+	}
+
+	// Данные сообщения передаются в sink, в Dson остаётся только заголовок
+	Result load_to_sink(const std::int32_t fd, DsonSink * sink)
+	{
+		if (!sink)
+		{
+			assert(false);
+			state_ = State::Error;
+			return Result::Error;
+		}
+		const std::int32_t size = data_size();
+		while (offset_ < size)
+		{
+			const auto received = sink->receive_from_fd(fd, size - offset_);
+			if (received < 0 || received > size - offset_)
+			{
+				extra_->loading_to_sink_ = false;
+				state_ = State::Error;
+				return Result::Error;
+			}
+			if (received == 0)
+				return Result::InProcess;
+			offset_ += static_cast<std::int32_t>(received);
+		}
+		extra_->loading_to_sink_ = false;
+		if (!sink->end())
+		{
+			state_ = State::Error;
+			return Result::Error;
+		}
+		// Пустой Dson с ключом сообщения
+		const DsonKey _key = key();
+		clear_header();
+		set_key(_key);
+		dson_kind_ = DsonKind::DsonContainer;
+		extra_->data_in_sink_ = true;
+		state_ = State::Ready;
+		return Result::Ready;
+	}
+
+public:
 	/**
 	 * @brief load_from_buf
 	 * чтение из буфера
@@ -396,93 +1051,60 @@ public:
 	 * (например через shared mem)
 	 * @note ожидается что в буфере уже есть Dson (текущий или заголовок нового)
 	 * (ожидание появления Dson, сброс в случае ошибки - должны обеспечиваться внешними механизмами)
-	 * @note за раз передаётся 1 Dson (нет механизмов загрузки с буфера сразу нескольких Dson,
-	 *  - либо уже идёт загрузка и размер Dson берётся из его заголовка
-	 *  - либо ожидается заголовок и которого будет понятен размер Dson)
+	 * @note данные всегда копируются в свой буфер (аллокация или арена)
 	 * @note если Dson больше по размеру чем buf_size, то ожидается что buf заполнен полностью
+	 * @note чтобы пройти по буферу с несколькими Dson подряд - см. load_from_buf(buf, buf_size, consumed)
 	 */
 	Result load_from_buf(char * buf, std::int32_t buf_size)
 	{
-		switch (state_)
+		std::int32_t consumed;
+		return load_from_buf_copy(buf, buf_size, consumed);
+	}
+
+	/**
+	 * @brief load_from_buf
+	 * Разбор окна буфера, в котором подряд лежат несколько Dson (shared mem, пачка из файла и т.п.).
+	 * Загружает один Dson за вызов и сообщает сколько байт окна было использовано,
+	 * следующий вызов делается с buf + consumed.
+	 *
+	 * Если Dson целиком лежит в окне (и загрузка не была начата раньше),
+	 * то Dson становится вьюхой на окно без копирования (см. Dson(char * buf)) - окно должно жить
+	 * пока используется Dson.
+	 * Копируется только Dson, который пересекает границу окна: его начало копируется
+	 * и вызов вернёт Result::InProcess, продолжение берётся из следующего окна.
+	 * @param buf окно буфера
+	 * @param buf_size размер окна
+	 * @param consumed сколько байт окна использовано
+	 * @return Result::Ready если Dson загружен
+	 */
+	Result load_from_buf(char * buf, std::int32_t buf_size, std::int32_t & consumed)
+	{
+		consumed = 0;
+		const bool loading = (state_ == State::LoadingHeader || state_ == State::LoadingData);
+		if (!loading && buf_size >= header_size)
 		{
-		case State::Error:
-			[[fallthrough]];
-		case State::CopyingHeader:
-			[[fallthrough]];
-		case State::CopyingData:
-			[[fallthrough]];
-		case State::Ready:
+			const Header header = header_to_host_copy(buf);
+			if (header.mark_byte_order_ != mark_host_order || header.data_size_ < 0
+				|| header.data_size_ > MAX_DSON_RAM_SIZE)
 			{
 				clear();
-				offset_ = 0;
-				state_ = State::LoadingHeader;
-				dson_kind_ = DsonKind::DataBufNeedParse;
-			}
-			[[fallthrough]];
-		case State::LoadingHeader:
-			{
-				if (offset_ >= header_size)
-				{
-					assert(false);
-					state_ = State::Error;
-					return Result::Error;
-				}
-				auto readed = header_size - offset_;
-				if (readed > buf_size)
-					readed = buf_size;
-				std::memcpy(header_ + offset_, buf, readed);
-				offset_ += readed;
-				if (offset_ < header_size)
-				{
-					return Result::InProcess;
-				}
-				const std::int32_t size = data_size();
-				if (size < 0 || size > MAX_DSON_RAM_SIZE)
-				{
-					state_ = State::Error;
-					return Result::Error;
-				}
-				if (size == 0)
-				{
-					state_ = State::Ready;
-					dson_kind_ = DsonKind::DsonContainer;
-					return Result::Ready;
-				}
-				if (!allocate(size))
-				{
-					state_ = State::Error;
-					return Result::Error;
-				}
-				offset_ = 0;
-				state_ = State::LoadingData;
-				buf_size -= readed;
-				if (!buf_size)
-					return Result::InProcess;
-				buf += readed;
+				state_ = State::Error;
+				return Result::Error;
 			}
-			[[fallthrough]];
-		case State::LoadingData:
+			const std::int32_t frame_size = header_size + header.data_size_;
+			if (frame_size <= buf_size)
 			{
-				if (offset_ >= buf_size_)
-				{
-					assert(false);
+				// Целиком в окне: вьюха
+				clear();
+				buf_ = buf;
+				pre_parse_buf();
+				if (state_ == State::Error)
 					return Result::Error;
-				}
-				auto readed = buf_size_ - offset_;
-				if (readed > buf_size)
-					readed = buf_size;
-				std::memcpy(buf_ + offset_, buf, readed);
-				offset_ += readed;
-				if (offset_ == buf_size_)
-				{
-					state_ = State::Ready;
-					return Result::Ready;
-				}
-				return Result::InProcess;
+				consumed = frame_size;
+				return Result::Ready;
 			}
-		} // switch
-
-		return Result::Error;
+		}
+		return load_from_buf_copy(buf, buf_size, consumed);
 	}
 
 public: // DsonObj
@@ -511,17 +1133,29 @@ public: // DsonObj
 			}
 		case DsonKind::DsonContainer:
 			{
+				if (cached_data_size_ >= 0)
+					return cached_data_size_;
 				std::int32_t re{0};
 				for (auto & it : key_to_val_map_)
 				{
 					re += it.second->data_size() + header_size;
 				}
+				if (!volatile_children_)
+				{
+					cached_data_size_ = re;
+				}
 				return re;
 			}
 		}
 		return {};
 	}
 
+	bool is_data_size_fixed() const noexcept override
+	{
+		// Свои изменения Dson сообщает родителю сам (см. invalidate_caches())
+		return !volatile_children_;
+	}
+
 	DsonKey key() const noexcept override
 	{
 		Header * _header = header();
@@ -541,6 +1175,8 @@ public: // DsonObj
 		{
 			header_as_array()[2] = int32_to_network(_key);
 		}
+		// Ключ лежит в заголовке: закодированный вид узла и родителей устарел
+		invalidate_caches();
 	}
 
 	template <typename K>
@@ -559,88 +1195,17 @@ public: // DsonObj
 		return int32_to_host(header_as_array()[3]);
 	}
 
-	void copy_to_stream_host_order(std::ofstream & out) override
-	{
-		if (state_ != State::Ready)
-			return;
-		if (dson_kind_ == DsonKind::DataBufNeedParse)
-		{ // Данные только приехали и не менялись => можно сразу отправить
-			if (is_host_order())
-			{
-				const auto _data_size = data_size();
-				copy_to_stream_header_internal(out, _data_size);
-				copy_to_stream_data_internal(out, _data_size);
-				return;
-			}
-			parse_buf();
-		}
-		switch (dson_kind_)
-		{
-		case DsonKind::OneObjectInDataBuf:
-			{
-				converters().to_host(*this);
-				const auto _data_size = data_size();
-				copy_to_stream_header_internal(out, _data_size);
-				copy_to_stream_data_internal(out, _data_size);
-				break;
-			}
-		case DsonKind::DsonContainer:
-			{
-				header_to_host();
-				const auto _data_size = data_size();
-				copy_to_stream_header_internal(out, _data_size);
+	using DsonObj::copy_to_stream_host_order;
+	using DsonObj::copy_to_stream_network_order;
 
-				for (auto & it : key_to_val_map_)
-				{
-					it.second->copy_to_stream_host_order(out);
-				}
-				break;
-			}
-		default:
-			break;
-		}
+	void copy_to_stream_host_order(std::ostream & out) override
+	{
+		copy_to_stream_internal<false>(out);
 	}
 
-	void copy_to_stream_network_order(std::ofstream & out) override
+	void copy_to_stream_network_order(std::ostream & out) override
 	{
-		if (state_ != State::Ready)
-			return;
-		if (dson_kind_ == DsonKind::DataBufNeedParse)
-		{ // Данные только приехали и не менялись => можно сразу отправить
-			if (is_network_order())
-			{
-				const auto _data_size = data_size();
-				copy_to_stream_header_internal(out, _data_size);
-				copy_to_stream_data_internal(out, _data_size);
-				return;
-			}
-			parse_buf();
-		}
-		switch (dson_kind_)
-		{
-		case DsonKind::OneObjectInDataBuf:
-			{
-				const auto _data_size = data_size();
-				converters().to_network(*this);
-				copy_to_stream_header_internal(out, _data_size);
-				copy_to_stream_data_internal(out, _data_size);
-				break;
-			}
-		case DsonKind::DsonContainer:
-			{
-				const auto _data_size = data_size();
-				header_to_network();
-				copy_to_stream_header_internal(out, _data_size);
-
-				for (auto & it : key_to_val_map_)
-				{
-					it.second->copy_to_stream_network_order(out);
-				}
-				break;
-			}
-		default:
-			break;
-		}
+		copy_to_stream_internal<true>(out);
 	}
 
 	/**
@@ -692,6 +1257,8 @@ public: // DsonObj
 			return;
 		}
 		state_ = State::Ready;
+		if (extra_)
+			extra_->copying_encoded_ = false;
 		// Итераторы сбросятся при переключении состояний
 	}
 
@@ -702,6 +1269,11 @@ public: // Converters
 	 * В данном разделе конструируется таблица преобразователей byte order.
 	 */
 	using Converter = std::function<void(Header &, char *)>;
+	/*
+	 * Преобразователь без type erasure: встроенные типы и пользовательские функции,
+	 * зарегистрированные как указатель (например +[](Header &, char *) {...})
+	 */
+	using ConverterFn = void (*)(Header &, char *);
 	struct Converters
 	{
 		using ConvertersMap = std::map<std::uint32_t, std::function<void(Header &, char *)>>;
@@ -729,65 +1301,290 @@ public: // Converters
 #ifdef USE_USER_DSON_TYPES
 			dson_user_defined_converters(to_host_order_, to_network_order_);
 #endif
+			update_dispatch();
+		}
+
+		/**
+		 * @brief register_converter
+		 * Добавить или заменить преобразователи типа после создания таблицы
+		 * (например при загрузке плагина), таблица диспетчеризации пересобирается сразу.
+		 * Обычно преобразователи пользователя регистрируются в dson_user_defined_converters().
+		 * @param type идентификатор типа
+		 * @param to_host преобразователь в host order
+		 * @param to_network преобразователь в network order
+		 */
+		void register_converter(const TypeMarker type, Converter to_host, Converter to_network)
+		{
+			to_host_order_.insert_or_assign(type, std::move(to_host));
+			to_network_order_.insert_or_assign(type, std::move(to_network));
+			update_dispatch();
+		}
+
+		// Убрать преобразователи типа (данные типа больше не преобразуются)
+		void remove_converter(const TypeMarker type)
+		{
+			to_host_order_.erase(type);
+			to_network_order_.erase(type);
+			update_dispatch();
 		}
 
 		void to_host(Dson & obj) noexcept
 		{
 			if (obj.is_host_order())
 				return;
-			auto converter = to_host_order_.find(obj.data_type());
-			if (converter == to_host_order_.end())
+			const Dispatch * converter = to_host_dispatch_.find(obj.data_type());
+			if (!converter)
 			{
 				// Для некоторых типов, например std::string, преобразования не требуются
 				return;
 			}
-			obj.to_host_internal(converter->second);
+			if (converter->fn_)
+			{
+				obj.to_host_internal(converter->fn_);
+			}
+			else
+			{
+				obj.to_host_internal(*converter->function_);
+			}
 		}
 
 		void to_network(Dson & obj) noexcept
 		{
 			if (obj.is_network_order())
 				return;
-			auto converter = to_network_order_.find(obj.data_type());
-			if (converter == to_network_order_.end())
+			// Родитель больше не может считать всех детей в host order (см. map())
+			if (obj.parent_)
+				obj.parent_->children_host_order_ = false;
+			const Dispatch * converter = to_network_dispatch_.find(obj.data_type());
+			if (!converter)
 			{
 				// Для некоторых типов, например std::string, преобразования не требуются
 				return;
 			}
-			obj.to_network_internal(converter->second);
+			if (converter->fn_)
+			{
+				obj.to_network_internal(converter->fn_);
+			}
+			else
+			{
+				obj.to_network_internal(*converter->function_);
+			}
 		}
 
-		ConvertersMap to_host_order_;
-		ConvertersMap to_network_order_;
-	};
-
-	static inline Converters & converters()
-	{
-		static Converters converters;
-		return converters;
-	}
-
-	void * data()
-	{
-		if (state_ == State::Error || !buf_)
-			return nullptr;
-		if (was_buf_allocation_)
-			return buf_;
-		return (buf_ + header_size);
-	}
-
-private:
-	Header * header() const noexcept
-	{
-		if (was_buf_allocation_ || !buf_)
+		/**
+		 * @brief has_converter
+		 * Нужно ли преобразовывать данные типа при смене byte order
+		 * (например данные std::string не преобразуются)
+		 */
+		template <bool network_order>
+		bool has_converter(const TypeMarker type) const noexcept
 		{
-			/*
-			 *  Если блок данных был аллоцирован, значит это не вьюха на внешний буффер
-			 *  и буффер под заголовки локальный.
-			 */
-			return std::launder(reinterpret_cast<Header *>(header_));
+			return dispatch<network_order>(type) != nullptr;
 		}
-		return std::launder(reinterpret_cast<Header *>(buf_));
+
+		/**
+		 * @brief convert_copy
+		 * Преобразование копии данных объекта, сам объект не меняется
+		 * @param header заголовок объекта в host order
+		 * @param data копия данных объекта
+		 */
+		template <bool network_order>
+		void convert_copy(Header & header, char * data) noexcept
+		{
+			const Dispatch * converter = dispatch<network_order>(header.data_type_);
+			if (!converter)
+				return;
+			if (converter->fn_)
+			{
+				converter->fn_(header, data);
+			}
+			else
+			{
+				(*converter->function_)(header, data);
+			}
+		}
+
+		// Встроенные преобразователи библиотеки
+		static void uint32_to_host(Header &, char * data)
+		{
+			std::uint32_t * var = std::launder(reinterpret_cast<std::uint32_t *>(data));
+			*var = ntohl(*var);
+		}
+
+		static void uint32_to_network(Header &, char * data)
+		{
+			std::uint32_t * var = std::launder(reinterpret_cast<std::uint32_t *>(data));
+			*var = htonl(*var);
+		}
+
+		static void uint64_to_host(Header &, char * data)
+		{
+			std::uint64_t * var = std::launder(reinterpret_cast<std::uint64_t *>(data));
+			*var = ntohll(*var);
+		}
+
+		static void uint64_to_network(Header &, char * data)
+		{
+			std::uint64_t * var = std::launder(reinterpret_cast<std::uint64_t *>(data));
+			*var = htonll(*var);
+		}
+
+		static void double_to_host(Header &, char * data)
+		{
+			double_in_buf_to_host_order(data);
+		}
+
+		static void double_to_network(Header &, char * data)
+		{
+			double_in_buf_to_network_order(data);
+		}
+
+		// Массивы преобразуются SIMD ядрами (см. <dson/impl/byte_swap.h>)
+		static void uint32_array_to_host(Header & header, char * data)
+		{
+			const std::size_t size = static_cast<std::uint32_t>(header.data_size_) / sizeof(std::uint32_t);
+			array32_network_host(std::launder(reinterpret_cast<std::uint32_t *>(data)), size);
+		}
+
+		static void uint32_array_to_network(Header & header, char * data)
+		{
+			const std::size_t size = static_cast<std::uint32_t>(header.data_size_) / sizeof(std::uint32_t);
+			array32_network_host(std::launder(reinterpret_cast<std::uint32_t *>(data)), size);
+		}
+
+		/*
+		 * Преобразователи регистрируются в ConvertersMap (так удобно пользователю),
+		 * но вызываются через таблицу: для fn_ прямой вызов по указателю,
+		 * для прочих std::function (лямбды с захватом) вызов через function_.
+		 */
+		struct Dispatch
+		{
+			ConverterFn fn_{nullptr};
+			const Converter * function_{nullptr};
+		};
+
+		class DispatchTable
+		{
+		public:
+			// Идентификаторы встроенных типов малы: прямая индексация
+			static constexpr TypeMarker dense_size{64};
+
+			void build(const ConvertersMap & converters)
+			{
+				dense_.fill(Dispatch{});
+				sparse_.clear();
+				for (const auto & [key, converter] : converters)
+				{
+					if (!converter)
+						continue;
+					Dispatch dispatch;
+					if (auto fn = converter.target<ConverterFn>())
+					{
+						dispatch.fn_ = *fn;
+					}
+					else
+					{
+						// std::map не перемещает элементы => указатель стабилен
+						dispatch.function_ = &converter;
+					}
+					const TypeMarker type = static_cast<TypeMarker>(key);
+					if (0 <= type && type < dense_size)
+					{
+						dense_[type] = dispatch;
+					}
+					else
+					{
+						// Пользовательские идентификаторы (например 54322) разрежены
+						sparse_.insert_or_assign(type, dispatch);
+					}
+				}
+			}
+
+			const Dispatch * find(const TypeMarker type) const noexcept
+			{
+				if (0 <= type && type < dense_size)
+				{
+					const Dispatch & re = dense_[type];
+					if (re.fn_ || re.function_)
+						return &re;
+					return nullptr;
+				}
+				if (sparse_.empty())
+					return nullptr;
+				auto it = sparse_.find(type);
+				if (it == sparse_.end())
+					return nullptr;
+				return &it->second;
+			}
+
+		private:
+			std::array<Dispatch, dense_size> dense_{};
+			std::unordered_map<TypeMarker, Dispatch> sparse_;
+		};
+
+		/**
+		 * @brief dispatch
+		 * Как будет вызван преобразователь типа
+		 * @return nullptr если у типа нет преобразователя
+		 */
+		template <bool network_order>
+		const Dispatch * dispatch(const TypeMarker type) const noexcept
+		{
+			if constexpr (network_order)
+			{
+				return to_network_dispatch_.find(type);
+			}
+			else
+			{
+				return to_host_dispatch_.find(type);
+			}
+		}
+
+	private:
+		// Пересобрать таблицы диспетчеризации после изменения ConvertersMap
+		void update_dispatch()
+		{
+			to_host_dispatch_.build(to_host_order_);
+			to_network_dispatch_.build(to_network_order_);
+		}
+
+		/*
+		 * Таблицы диспетчеризации держат указатели на элементы ConvertersMap:
+		 * карты меняются только через register_converter()/remove_converter()
+		 */
+		ConvertersMap to_host_order_;
+		ConvertersMap to_network_order_;
+		DispatchTable to_host_dispatch_;
+		DispatchTable to_network_dispatch_;
+	};
+
+	static inline Converters & converters()
+	{
+		static Converters converters;
+		return converters;
+	}
+
+	void * data()
+	{
+		if (state_ == State::Error || !buf_)
+			return nullptr;
+		if (was_buf_allocation_)
+			return buf_;
+		return (buf_ + header_size);
+	}
+
+private:
+	Header * header() const noexcept
+	{
+		if (was_buf_allocation_ || !buf_)
+		{
+			/*
+			 *  Если блок данных был аллоцирован, значит это не вьюха на внешний буффер
+			 *  и буффер под заголовки локальный.
+			 */
+			return std::launder(reinterpret_cast<Header *>(header_));
+		}
+		return std::launder(reinterpret_cast<Header *>(buf_));
 	}
 
 	std::uint32_t * header_as_array() const noexcept
@@ -808,14 +1605,112 @@ private:
 		return buf_;
 	}
 
+	// Загрузка одного Dson из окна буфера с копированием (см. load_from_buf())
+	Result load_from_buf_copy(char * buf, std::int32_t buf_size, std::int32_t & consumed)
+	{
+		consumed = 0;
+		switch (state_)
+		{
+		case State::Error:
+			[[fallthrough]];
+		case State::CopyingHeader:
+			[[fallthrough]];
+		case State::CopyingData:
+			[[fallthrough]];
+		case State::Ready:
+			{
+				clear();
+				offset_ = 0;
+				state_ = State::LoadingHeader;
+				dson_kind_ = DsonKind::DataBufNeedParse;
+			}
+			[[fallthrough]];
+		case State::LoadingHeader:
+			{
+				if (offset_ >= header_size)
+				{
+					assert(false);
+					state_ = State::Error;
+					return Result::Error;
+				}
+				auto readed = header_size - offset_;
+				if (readed > buf_size)
+					readed = buf_size;
+				std::memcpy(header_ + offset_, buf, readed);
+				offset_ += readed;
+				consumed += readed;
+				if (offset_ < header_size)
+				{
+					return Result::InProcess;
+				}
+				const std::int32_t size = data_size();
+				if (size < 0 || size > MAX_DSON_RAM_SIZE)
+				{
+					state_ = State::Error;
+					return Result::Error;
+				}
+				if (size == 0)
+				{
+					state_ = State::Ready;
+					dson_kind_ = DsonKind::DsonContainer;
+					return Result::Ready;
+				}
+				if (!allocate(size))
+				{
+					state_ = State::Error;
+					return Result::Error;
+				}
+				offset_ = 0;
+				state_ = State::LoadingData;
+				buf_size -= readed;
+				if (!buf_size)
+					return Result::InProcess;
+				buf += readed;
+			}
+			[[fallthrough]];
+		case State::LoadingData:
+			{
+				if (offset_ >= buf_size_)
+				{
+					assert(false);
+					return Result::Error;
+				}
+				auto readed = buf_size_ - offset_;
+				if (readed > buf_size)
+					readed = buf_size;
+				std::memcpy(buf_ + offset_, buf, readed);
+				offset_ += readed;
+				consumed += readed;
+				if (offset_ == buf_size_)
+				{
+					state_ = State::Ready;
+					return Result::Ready;
+				}
+				return Result::InProcess;
+			}
+		} // switch
+
+		return Result::Error;
+	}
+
 	void pre_parse_buf() noexcept
 	{
-		const std::int32_t _data_size = data_size();
+		// Вид узла ещё не выставлен (после clear() это DsonContainer): размер прямо из заголовка
+		const Header header = header_to_host_copy(header_as_char_buf());
+		/*
+		 * Заголовок вьюхи запоминается при создании: после clear() (и в деструкторе)
+		 * внешний буфер уже может быть освобождён
+		 */
+		if (!was_buf_allocation_)
+			std::memcpy(header_, &header, header_size);
+		const std::int32_t _data_size = header.data_size_;
 		if (_data_size < 0 || _data_size > MAX_DSON_RAM_SIZE)
 		{
 			state_ = State::Error;
 			return;
 		}
+		// Вьюха: буфер начинается с заголовка
+		buf_size_ = header_size + _data_size;
 		if (data_type() == types_map<DsonContainer>::value)
 		{
 			dson_kind_ = DsonKind::DataBufNeedParse;
@@ -824,345 +1719,1074 @@ private:
 		dson_kind_ = DsonKind::OneObjectInDataBuf;
 	}
 
-	void parse_buf()
+	/*
+	 * Описание ребёнка DsonKind::DataBufNeedParse контейнера без создания объекта.
+	 * Индекс упорядочен по ключу, память переиспользуется между загрузками.
+	 */
+	struct ChildIndex
 	{
-		assert(dson_kind_ == DsonKind::DataBufNeedParse);
-		const auto type = data_type();
-		if (type != types_map<DsonContainer>::value)
+		DsonKey key_;
+		// смещение заголовка ребёнка от начала данных контейнера
+		std::int32_t offset_;
+		TypeMarker data_type_;
+		std::int32_t data_size_;
+	};
+
+	/**
+	 * @brief header_to_host_copy
+	 * Заголовок из буфера в host order (сам буфер не меняется)
+	 */
+	static Header header_to_host_copy(const char * ptr) noexcept
+	{
+		Header re;
+		std::memcpy(&re, ptr, header_size);
+		if (re.mark_byte_order_ != mark_host_order)
 		{
-			dson_kind_ = DsonKind::OneObjectInDataBuf;
-			return;
+			header_network_host(std::launder(reinterpret_cast<std::uint32_t *>(&re)));
 		}
+		return re;
+	}
 
-		std::int32_t not_used = buf_size_;
-		char * ptr = static_cast<char *>(data());
-
+	/**
+	 * @brief index_buf
+	 * Ленивый разбор DsonKind::DataBufNeedParse: один линейный проход по буферу
+	 * без создания дочерних объектов, для каждого ребёнка запоминаются ключ, смещение, тип и размер.
+	 * Дочерний Dson создаётся только когда нужен DsonObj* (см. get_lazy()),
+	 * скаляры можно читать прямо из буфера (см. raw_field()).
+	 * @return false если буфер повреждён
+	 */
+	bool index_buf()
+	{
+		if (indexed_)
+			return true;
+		index_.clear();
+		char * base = static_cast<char *>(data());
+		std::int32_t not_used = data_size();
+		std::int32_t offset{0};
+		bool sorted{true};
 		while (not_used >= header_size)
 		{
-			auto obj = std::make_unique<Dson>(ptr);
-			const std::int32_t key = obj->key();
-			if (key < 0)
-				break;
-			std::int32_t buf_size = obj->data_size();
-			if (buf_size < 0)
+			const Header child = header_to_host_copy(base + offset);
+			if (child.key_ < 0 || child.data_size_ < 0 || child.data_size_ > not_used - header_size)
 				break;
-			buf_size += header_size;
-			key_to_val_map_.insert_or_assign(key, std::move(obj));
-			not_used -= buf_size;
-			ptr += buf_size;
+			if (!index_.empty() && index_.back().key_ >= child.key_)
+				sorted = false;
+			index_.push_back({child.key_, offset, child.data_type_, child.data_size_});
+			const std::int32_t size = child.data_size_ + header_size;
+			not_used -= size;
+			offset += size;
 		}
 		assert(not_used == 0);
 		if (not_used != 0)
 		{
+			index_.clear();
 			state_ = State::Error;
-			return;
+			return false;
 		}
-		dson_kind_ = DsonKind::DsonContainer;
+		if (!sorted)
+		{
+			// Сериализованные Dson идут по возрастанию ключа, остальное - чужие буферы
+			std::stable_sort(
+				index_.begin(),
+				index_.end(),
+				[](const ChildIndex & lhs, const ChildIndex & rhs)
+				{
+					return lhs.key_ < rhs.key_;
+				});
+			// При повторе ключа побеждает последний (как при insert_or_assign)
+			auto out = index_.begin();
+			for (auto it = index_.begin(); it != index_.end(); ++it)
+			{
+				if (std::next(it) != index_.end() && std::next(it)->key_ == it->key_)
+					continue;
+				*out++ = *it;
+			}
+			index_.erase(out, index_.end());
+		}
+		indexed_ = true;
+		return true;
+	}
+
+	const ChildIndex * find_index(const std::int32_t _key) const noexcept
+	{
+		const auto it = std::lower_bound(
+			index_.begin(),
+			index_.end(),
+			_key,
+			[](const ChildIndex & child, const std::int32_t k)
+			{
+				return child.key_ < k;
+			});
+		if (it == index_.end() || it->key_ != _key)
+			return nullptr;
+		return &*it;
 	}
 
 	/**
-	 * @brief one_object_buf_to_container
-	 * Пока был только 1 загруженный извне объект - key_to_val_map_ не использовался
-	 * Когда добавляются новые объекты поиск уже идёт по key_to_val_map_
-	 * и теперь необходимо первый объект также отразить в key_to_val_map_
+	 * @brief get_lazy
+	 * get() для DsonKind::DataBufNeedParse контейнера:
+	 * создаётся только запрошенный дочерний объект, он запоминается в key_to_val_map_
+	 */
+	DsonObj * get_lazy(const std::int32_t _key)
+	{
+		if (!index_buf())
+			return nullptr;
+		if (auto find_it = key_to_val_map_.find(_key); find_it != key_to_val_map_.end())
+		{
+			converters().to_host(*static_cast<Dson *>(find_it->second.get()));
+			return find_it->second.get();
+		}
+		const ChildIndex * child = find_index(_key);
+		if (!child)
+			return nullptr;
+		auto obj = make_view_node(static_cast<char *>(data()) + child->offset_);
+		Dson * re = obj.get();
+		re->parent_ = this;
+		key_to_val_map_.insert_or_assign(_key, std::move(obj));
+		converters().to_host(*re);
+		return re;
+	}
+
+	/*
+	 * Разобрать содержимое в key_to_val_map_ перед обходом детей
+	 * @return false если Dson ещё не готов (идёт загрузка/выгрузка)
+	 */
+	bool prepare_children()
+	{
+		if (state_ != State::Ready)
+			return false;
+		switch (dson_kind_)
+		{
+		case DsonKind::DataBufNeedParse:
+			parse_buf();
+			break;
+		case DsonKind::OneObjectInDataBuf:
+			one_object_buf_to_container();
+			break;
+		default:
+			break;
+		}
+		return true;
+	}
+
+	void parse_buf()
+	{
+		assert(dson_kind_ == DsonKind::DataBufNeedParse);
+		const auto type = data_type();
+		if (type != types_map<DsonContainer>::value)
+		{
+			dson_kind_ = DsonKind::OneObjectInDataBuf;
+			return;
+		}
+
+		if (!index_buf())
+			return;
+		char * base = static_cast<char *>(data());
+		key_to_val_map_.reserve(index_.size());
+		for (const auto & child : index_)
+		{
+			// Уже созданные через get() дети остаются (на них могут быть указатели)
+			if (key_to_val_map_.find(child.key_) != key_to_val_map_.end())
+				continue;
+			auto obj = make_view_node(base + child.offset_);
+			obj->parent_ = this;
+			key_to_val_map_.insert_or_assign(child.key_, std::move(obj));
+		}
+		index_.clear();
+		indexed_ = false;
+		children_host_order_ = false;
+		dson_kind_ = DsonKind::DsonContainer;
+	}
+
+	/**
+	 * @brief one_object_buf_to_container
+	 * Пока был только 1 загруженный извне объект - key_to_val_map_ не использовался
+	 * Когда добавляются новые объекты поиск уже идёт по key_to_val_map_
+	 * и теперь необходимо первый объект также отразить в key_to_val_map_
+	 */
+	void one_object_buf_to_container()
+	{
+		assert(dson_kind_ == DsonKind::OneObjectInDataBuf);
+		assert(data_type() != types_map<DsonContainer>::value);
+		if (!data())
+		{
+			state_ = State::Error;
+			return;
+		}
+		const std::int32_t key = this->key();
+		if (key < 0)
+		{
+			state_ = State::Error;
+			return;
+		}
+		// Объект вместе с заголовком и буфером (в том числе встроенным) переезжает в ребёнка
+		Header own_header;
+		std::memcpy(&own_header, header_as_char_buf(), header_size);
+		auto obj = make_node(std::move(*this));
+		// Кэш закодированного вида и признак загрузки в sink остаются у корня, а не у переехавшего ребёнка
+		if (Extra * moved = obj->extra_.get())
+		{
+			Extra & _extra = extra();
+			_extra.encoded_ = std::move(moved->encoded_);
+			_extra.copying_encoded_ = std::exchange(moved->copying_encoded_, false);
+			_extra.data_in_sink_ = std::exchange(moved->data_in_sink_, false);
+		}
+		std::memcpy(header_, &own_header, header_size);
+		buf_size_ = 0;
+		state_ = State::Ready;
+		dson_kind_ = DsonKind::DsonContainer;
+		obj->parent_ = this;
+		key_to_val_map_.insert_or_assign(key, std::move(obj));
+		children_host_order_ = false;
+		set_data_type_internal(types_map<DsonContainer>::value);
+	}
+
+	void insert_internal(const std::int32_t key, std::unique_ptr<DsonObj> obj)
+	{
+		assert(obj);
+		if (!obj)
+			return;
+		if (state_ != State::Ready)
+			reset_state();
+
+		switch (dson_kind_)
+		{
+		case DsonKind::DataBufNeedParse:
+			parse_buf();
+			break;
+		case DsonKind::OneObjectInDataBuf:
+			// Добавление последующих объектов превращает Dson в контейнер
+			one_object_buf_to_container();
+			break;
+		default:
+			break;
+		}
+		if (state_ != State::Ready)
+			return;
+		if (auto find_it = key_to_val_map_.find(key); find_it != key_to_val_map_.end())
+		{
+			DsonObj * old = find_it->second.get();
+			if (!old->is_data_size_fixed())
+				add_volatile_children(-1);
+			if (auto dson = dson_cast<Dson>(old))
+				dson->parent_ = nullptr;
+		}
+		if (!obj->is_data_size_fixed())
+			add_volatile_children(1);
+		if (auto dson = dson_cast<Dson>(obj.get()))
+			dson->parent_ = this;
+		key_to_val_map_.insert_or_assign(key, std::move(obj));
+		children_host_order_ = false;
+		set_data_type_internal(types_map<DsonContainer>::value);
+		invalidate_caches();
+	}
+
+	/**
+	 * @brief invalidate_caches
+	 * Узел изменился: сбросить закэшированные размеры и закодированный вид
+	 * контейнеров вверх по дереву.
+	 * Родитель, ещё не разобранный из буфера (ребёнок получен через get()), разбирается:
+	 * размер в его заголовке больше не верен.
+	 */
+	void invalidate_caches()
+	{
+		// Узел мог смениться на network order
+		if (parent_)
+			parent_->children_host_order_ = false;
+		for (Dson * it = this; it; it = it->parent_)
+		{
+			it->cached_data_size_ = -1;
+			if (EncodedCache * encoded = it->encoded_cache())
+				encoded->invalidate();
+			if (it->parent_ && it->parent_->dson_kind_ == DsonKind::DataBufNeedParse && it->parent_->state_ == State::Ready)
+				it->parent_->parse_buf();
+		}
+	}
+
+	/**
+	 * @brief add_volatile_children
+	 * Учёт детей, чей размер может поменяться незаметно для контейнера.
+	 * Когда у Dson такие дети появляются или исчезают, он сам становится
+	 * таким ребёнком для своего родителя.
+	 */
+	void add_volatile_children(const std::int32_t delta) noexcept
+	{
+		if (!delta)
+			return;
+		const bool was_fixed = !volatile_children_;
+		volatile_children_ += delta;
+		const bool fixed = !volatile_children_;
+		if (parent_ && was_fixed != fixed)
+		{
+			parent_->add_volatile_children(fixed ? -1 : 1);
+		}
+	}
+
+	DsonObj * get_internal(const std::int32_t _key)
+	{
+		assert(dson_kind_ == DsonKind::DsonContainer);
+		if (state_ != State::Ready)
+			reset_state();
+		auto find_it = key_to_val_map_.find(_key);
+		if (find_it == key_to_val_map_.end())
+			return {};
+		DsonObj * obj = find_it->second.get();
+		if (!obj)
+			return {};
+		// Если объект - Dson, то можно сразу попробовать конвертировать в host byte order
+		if (auto dson = dson_cast<Dson>(obj))
+		{
+			converters().to_host(*dson);
+		}
+		return obj;
+	}
+
+	template <typename ConverterT>
+	void to_host_internal(const ConverterT & converter)
+	{
+		header_to_host();
+		auto dson_header = header();
+		auto dson_data = static_cast<char *>(data());
+		if (!dson_data)
+			return;
+		converter(*dson_header, dson_data);
+	}
+
+	template <typename ConverterT>
+	void to_network_internal(const ConverterT & converter)
+	{
+		auto dson_header = header();
+		auto dson_data = static_cast<char *>(data());
+		if (!dson_data)
+			return;
+		converter(*dson_header, dson_data);
+		header_to_network();
+	}
+
+	void header_to_host() const noexcept
+	{
+		if (is_host_order())
+			return;
+		header_network_host(header_as_array());
+	}
+
+	void header_to_network() const noexcept
+	{
+		if (is_network_order())
+			return;
+		std::uint32_t * header = header_as_array();
+		if (!header)
+			return;
+		header_network_host(header);
+	}
+
+	void move_from_other(Dson && other)
+	{
+		/*
+		 * Вьюха остаётся вьюхой на тот же буфер: для внешнего буфера его время жизни
+		 * обеспечивает владелец, буфер под счётчиком ссылок переезжает вместе с buf_owner_
+		 */
+		std::memcpy(header_, other.header_, static_cast<size_t>(header_size));
+		state_ = other.state_;
+		other.state_ = State::Error;
+		if (other.is_buf_inline())
+		{
+			std::memcpy(inline_buf_, other.inline_buf_, static_cast<size_t>(other.buf_size_));
+			buf_ = inline_buf_;
+		}
+		else
+		{
+			buf_ = other.buf_;
+		}
+		other.buf_ = nullptr;
+		buf_size_ = other.buf_size_;
+		was_buf_allocation_ = other.was_buf_allocation_;
+		buf_from_arena_ = other.buf_from_arena_;
+		other.was_buf_allocation_ = false;
+		other.buf_from_arena_ = false;
+		// Память дерева может быть в арене other - держим арену пока держим дерево
+		if (other.arena_)
+		{
+			borrowed_arena_ = other.arena_;
+			borrowed_arena_->borrow();
+		}
+		else
+		{
+			borrowed_arena_ = std::move(other.borrowed_arena_);
+		}
+		buf_owner_ = std::move(other.buf_owner_);
+		buf_mapped_ = other.buf_mapped_;
+		other.buf_mapped_ = false;
+		// Кэш закодированного вида и результат загрузки в DsonSink переезжают вместе с деревом
+		if (other.extra_)
+		{
+			Extra & _extra = extra();
+			_extra.encoded_ = std::move(other.extra_->encoded_);
+			_extra.copying_encoded_ = std::exchange(other.extra_->copying_encoded_, false);
+			_extra.data_in_sink_ = std::exchange(other.extra_->data_in_sink_, false);
+		}
+		else if (extra_)
+		{
+			extra_->encoded_.reset();
+			extra_->copying_encoded_ = false;
+			extra_->data_in_sink_ = false;
+		}
+		dson_kind_ = other.dson_kind_;
+		key_to_val_map_.swap(other.key_to_val_map_);
+		children_host_order_ = other.children_host_order_;
+		other.children_host_order_ = false;
+		for (auto & it : key_to_val_map_)
+		{
+			if (auto dson = dson_cast<Dson>(it.second.get()))
+				dson->parent_ = this;
+		}
+		const std::int32_t volatile_children = other.volatile_children_;
+		other.add_volatile_children(-volatile_children);
+		other.invalidate_caches();
+		add_volatile_children(volatile_children);
+		invalidate_caches();
+		index_.swap(other.index_);
+		indexed_ = other.indexed_;
+		other.indexed_ = false;
+		offset_ = other.offset_;
+		std::swap(copy_index_, other.copy_index_);
+	}
+
+	void set_data_type_internal(const std::int32_t data_type)
+	{
+		Header * _header = header();
+		if (_header->mark_byte_order_ == mark_host_order)
+		{
+			_header->data_type_ = data_type;
+		}
+		else
+		{
+			header_as_array()[3] = int32_to_network(data_type);
+		}
+	}
+
+	/*
+	 * Выгрузка не меняет узел: заголовки и данные в нужном byte order пишутся
+	 * сразу в место назначения (буфер, промежуточный буфер writev, поток),
+	 * поэтому узел можно выгружать многократно и читать после выгрузки без обратного преобразования.
+	 */
+
+	// Нужно ли менять byte order узла при выгрузке
+	template <bool network_order>
+	bool need_conversion() const noexcept
+	{
+		if constexpr (network_order)
+		{
+			return !is_network_order();
+		}
+		else
+		{
+			return !is_host_order();
+		}
+	}
+
+	/**
+	 * @brief prepare_to_copy
+	 * Буфер DsonKind::DataBufNeedParse выгружается целиком без разбора, если дети не создавались:
+	 * как есть при совпадении byte order, иначе с переводом по ходу копирования (см. transcode_buf()).
+	 * Если дети создавались (get()), они могли измениться: буфер разбирается на детей,
+	 * каждый выгружается сам.
+	 */
+	template <bool network_order>
+	void prepare_to_copy()
+	{
+		if (dson_kind_ == DsonKind::DataBufNeedParse && !key_to_val_map_.empty())
+		{
+			parse_buf();
+		}
+	}
+
+	// Копия заголовка в нужном byte order (с актуальным размером контейнера)
+	template <bool network_order>
+	Header output_header() const noexcept
+	{
+		Header re = header_to_host_copy(header_as_char_buf());
+		if (dson_kind_ == DsonKind::DsonContainer)
+		{
+			re.data_size_ = data_size();
+		}
+		if constexpr (network_order)
+		{
+			header_network_host(std::launder(reinterpret_cast<std::uint32_t *>(&re)));
+		}
+		return re;
+	}
+
+	/*
+	 * Нужно ли преобразовывать данные узла (а не только заголовок):
+	 * DsonKind::OneObjectInDataBuf - если у типа есть конвертер,
+	 * DsonKind::DataBufNeedParse - если byte order детей может не совпадать
+	 * (выданные через next_loaded() дети переведены в host order прямо в буфере)
+	 */
+	template <bool network_order>
+	bool need_data_conversion() const noexcept
+	{
+		if (dson_kind_ == DsonKind::DataBufNeedParse)
+		{
+			return need_conversion<network_order>() || streamed();
+		}
+		return need_conversion<network_order>() && converters().has_converter<network_order>(data_type());
+	}
+
+	// Копия данных узла в dst с преобразованием byte order, false если буфер повреждён
+	template <bool network_order>
+	bool copy_data_converted(char * dst)
+	{
+		const std::int32_t size = data_size();
+		if (dson_kind_ == DsonKind::DataBufNeedParse)
+		{
+			return transcode_buf<network_order>(static_cast<const char *>(data()), size, dst);
+		}
+		std::memcpy(dst, data(), static_cast<std::size_t>(size));
+		Header header = header_to_host_copy(header_as_char_buf());
+		converters().convert_copy<network_order>(header, dst);
+		return true;
+	}
+
+	/**
+	 * @brief transcode_buf
+	 * Копия буфера детей в dst с переводом в нужный byte order без разбора на объекты:
+	 * буфер копируется целиком, затем один линейный проход по заголовкам (вглубь вложенных контейнеров)
+	 * переводит заголовки и данные типов с конвертером прямо в dst.
+	 * Byte order смотрится у каждого узла: часть детей могла быть уже переведена (см. next_loaded()).
+	 * Раскладка не меняется: узел лежит в dst по тому же смещению, что и в src.
+	 * @return false если буфер повреждён
+	 */
+	template <bool network_order>
+	static bool transcode_buf(const char * src, const std::int32_t size, char * dst)
+	{
+		const std::uint32_t mark_out = network_order ? mark_network_order : mark_host_order;
+		Converters & _converters = converters();
+		std::memcpy(dst, src, static_cast<std::size_t>(size));
+		// Концы объемлющих контейнеров (память только для вложенных контейнеров)
+		std::vector<std::int32_t> ends;
+		std::int32_t end{size};
+		std::int32_t offset{0};
+		while (offset < size)
+		{
+			while (offset == end)
+			{
+				end = ends.back();
+				ends.pop_back();
+			}
+			if (end - offset < header_size)
+				return false;
+			Header header;
+			std::memcpy(&header, src + offset, header_size);
+			const std::uint32_t mark = header.mark_byte_order_;
+			if (mark != mark_host_order)
+			{
+				if (mark != mark_network_order)
+					return false;
+				header_network_host(std::launder(reinterpret_cast<std::uint32_t *>(&header)));
+			}
+			if (header.data_size_ < 0 || header.data_size_ > end - offset - header_size)
+				return false;
+			const bool convert = mark != mark_out;
+			if (convert)
+			{
+				Header out = header;
+				if constexpr (network_order)
+				{
+					header_network_host(std::launder(reinterpret_cast<std::uint32_t *>(&out)));
+				}
+				std::memcpy(dst + offset, &out, header_size);
+			}
+			offset += header_size;
+			if (header.data_type_ == types_map<DsonContainer>::value)
+			{
+				ends.push_back(end);
+				end = offset + header.data_size_;
+				continue;
+			}
+			if (convert && header.data_size_ > 0)
+			{
+				_converters.convert_copy<network_order>(header, dst + offset);
+			}
+			offset += header.data_size_;
+		}
+		return true;
+	}
+
+	/**
+	 * @brief encoded
+	 * Закодированный вид узла (заголовок + данные) в нужном byte order из кэша,
+	 * при необходимости кодируется заново.
+	 * @return nullptr если кэш выключен, у узла есть дети чьё изменение незаметно
+	 * (см. DsonObj::is_data_size_fixed()) или кодирование не удалось
+	 * @note вызывать только в State::Ready
+	 */
+	template <bool network_order>
+	const std::vector<char> * encoded()
+	{
+		EncodedCache * _encoded = encoded_cache();
+		if (!_encoded || volatile_children_)
+			return nullptr;
+		if (const std::vector<char> * cached = _encoded->get<network_order>())
+			return cached;
+		std::vector<char> & cache = _encoded->buf_[network_order];
+		const std::int32_t size = data_size() + header_size;
+		cache.resize(static_cast<std::size_t>(size));
+		char * buf = cache.data();
+		std::int32_t buf_size = size;
+		if (copy_to_buf_tree<network_order>(buf, buf_size) != Result::Ready || buf_size)
+		{
+			reset_state();
+			return nullptr;
+		}
+		// Кодирование могло разобрать буфер (prepare_to_copy()) и сбросить кэш: отмечаем после
+		_encoded->valid_[network_order] = true;
+		return &cache;
+	}
+
+	/**
+	 * @brief copy_to_stream_internal
+	 * @note network_order нужен ли network byte order
+	 */
+	template <bool network_order>
+	void copy_to_stream_internal(std::ostream & out)
+	{
+		if (state_ != State::Ready)
+			return;
+		if (const std::vector<char> * cached = encoded<network_order>())
+		{
+			out.write(cached->data(), static_cast<std::streamsize>(cached->size()));
+			return;
+		}
+		prepare_to_copy<network_order>();
+		switch (dson_kind_)
+		{
+		case DsonKind::DataBufNeedParse:
+			[[fallthrough]]; // Данные только приехали и не менялись => отправляются без разбора
+		case DsonKind::OneObjectInDataBuf:
+			{
+				const Header header = output_header<network_order>();
+				out.write(reinterpret_cast<const char *>(&header), header_size);
+				const std::int32_t size = data_size();
+				if (!need_data_conversion<network_order>())
+				{
+					out.write(static_cast<char *>(data()), size);
+					break;
+				}
+				alignas(std::max_align_t) char local[64];
+				std::vector<char> heap;
+				char * tmp = local;
+				if (size > static_cast<std::int32_t>(sizeof(local)))
+				{
+					heap.resize(static_cast<std::size_t>(size));
+					tmp = heap.data();
+				}
+				if (!copy_data_converted<network_order>(tmp))
+				{
+					out.setstate(std::ios::badbit);
+					break;
+				}
+				out.write(tmp, size);
+				break;
+			}
+		case DsonKind::DsonContainer:
+			{
+				const Header header = output_header<network_order>();
+				out.write(reinterpret_cast<const char *>(&header), header_size);
+				for (auto & it : key_to_val_map_)
+				{
+					if constexpr (network_order)
+					{
+						it.second->copy_to_stream_network_order(out);
+					}
+					else
+					{
+						it.second->copy_to_stream_host_order(out);
+					}
+				}
+				break;
+			}
+		}
+	}
+
+	/**
+	 * @brief copy_to_fd_internal
+	 * Всё дерево выгружается одним списком буферов через writev():
+	 * заголовки и данные узлов не копируются, системный вызов один на IOV_MAX буферов
+	 * (а не по два на каждый объект).
+	 * @param fd
+	 * @return
+	 * @note network_order нужен ли network byte order
+	 * @note при частичной записи (неблокирующий сокет) вернёт Result::InProcess,
+	 * следующий вызов продолжит с места остановки
+	 * @note незаконченная выгрузка в буфер (copy_to_buf_*) прерывается:
+	 * в fd дерево выгружается целиком с начала
+	 */
+	template <bool network_order>
+	Result copy_to_fd_internal(std::int32_t fd)
+	{
+		if (state_ == State::CopyingHeader
+			|| (state_ == State::CopyingData && (copying_encoded() || !extra_ || extra_->gather_.iov_.empty())))
+		{
+			abort_copy();
+		}
+		GatherState & gather = extra().gather_;
+		switch (state_)
+		{
+		case State::Ready:
+			{
+				gather.clear();
+				if (const std::vector<char> * cached = encoded<network_order>())
+				{
+					// Один буфер - один write()
+					gather.add(cached->data(), cached->size());
+					state_ = State::CopyingData;
+					return copy_to_fd_internal<network_order>(fd);
+				}
+				if (!gather_tree<network_order>(gather))
+				{
+					gather.clear();
+					return Result::Error;
+				}
+				if (!gather.stage<network_order>())
+				{
+					gather.clear();
+					return Result::Error;
+				}
+				state_ = State::CopyingData;
+			}
+			[[fallthrough]];
+		case State::CopyingData:
+			{
+				const Result re = gather.write<network_order>(fd);
+				if (re != Result::InProcess)
+				{
+					gather.clear();
+					state_ = State::Ready;
+				}
+				return re;
+			}
+
+		default:
+			break;
+		}
+		assert(false);
+		return Result::Error;
+	} // copy_to_fd_internal
+
+	/*
+	 * Прервать незаконченную выгрузку узла и детей:
+	 * следующая выгрузка (в любое место назначения) начнётся сначала
 	 */
-	void one_object_buf_to_container()
+	void abort_copy() noexcept
 	{
-		assert(dson_kind_ == DsonKind::OneObjectInDataBuf);
-		assert(data_type() != types_map<DsonContainer>::value);
-		char * ptr = static_cast<char *>(data());
-		if (!ptr)
-		{
-			state_ = State::Error;
+		if (state_ != State::CopyingHeader && state_ != State::CopyingData)
 			return;
-		}
-		auto obj = std::make_unique<Dson>(header_as_char_buf(), ptr);
-		const std::int32_t key = obj->key();
-		if (key < 0)
+		for (auto & it : key_to_val_map_)
 		{
-			state_ = State::Error;
-			return;
+			DsonObj * obj = it.second.get();
+			if (auto dson = dson_cast<Dson>(obj))
+			{
+				dson->abort_copy();
+			}
+			else if (obj->state() == State::CopyingHeader || obj->state() == State::CopyingData)
+			{
+				obj->reset_state();
+			}
 		}
-		key_to_val_map_.insert_or_assign(key, std::move(obj));
-		dson_kind_ = DsonKind::DsonContainer;
-		set_data_type_internal(types_map<DsonContainer>::value);
+		if (extra_)
+			extra_->copying_encoded_ = false;
+		offset_ = 0;
+		copy_index_ = 0;
+		state_ = State::Ready;
 	}
 
-	void insert_internal(const std::int32_t key, std::unique_ptr<DsonObj> obj)
-	{
-		assert(obj);
-		if (!obj)
-			return;
-		if (state_ != State::Ready)
-			reset_state();
+	/*
+	 * Объекты библиотеки (не Dson) больше этого размера не копируются в промежуточный буфер writev(),
+	 * а выгружаются в fd сами (см. GatherState::add_direct())
+	 */
+	static constexpr std::int32_t max_staged_size{64 * 1024};
 
-		switch (dson_kind_)
+	/*
+	 * Объект можно выгрузить через copy_to_buf_* в промежуточный буфер writev():
+	 * только объекты библиотеки (их copy_to_buf_* выдаёт те же байты, что и copy_to_fd_*).
+	 * Пользовательские объекты (Kind::Custom) всегда выгружаются своим copy_to_fd_*,
+	 * как и до writev() - от них не требуется одинаковая работа обоих путей.
+	 */
+	static bool can_stage(const DsonObj * obj) noexcept
+	{
+		switch (obj->kind())
 		{
-		case DsonKind::DataBufNeedParse:
-			parse_buf();
-			break;
-		case DsonKind::OneObjectInDataBuf:
-			// Добавление последующих объектов превращает Dson в контейнер
-			one_object_buf_to_container();
-			break;
+		case Kind::StringObj:
+			[[fallthrough]];
+		case Kind::RouteObj:
+			return obj->data_size() <= max_staged_size;
 		default:
 			break;
 		}
-		if (state_ != State::Ready)
-			return;
-		key_to_val_map_.insert_or_assign(key, std::move(obj));
-		set_data_type_internal(types_map<DsonContainer>::value);
+		return false;
 	}
 
-	DsonObj * get_internal(const std::int32_t _key)
+	/*
+	 * Список буферов дерева для writev().
+	 * Объекты не являющиеся Dson (свои буферы не отдают) выгружаются
+	 * через copy_to_buf_* в общий промежуточный буфер (см. can_stage()), остальные - своим copy_to_fd_*.
+	 */
+	struct GatherState
 	{
-		assert(dson_kind_ == DsonKind::DsonContainer);
-		if (state_ != State::Ready)
-			reset_state();
-		auto find_it = key_to_val_map_.find(_key);
-		if (find_it == key_to_val_map_.end())
-			return {};
-		DsonObj * obj = find_it->second.get();
-		if (!obj)
-			return {};
-		// Если объект - Dson, то можно сразу попробовать конвертировать в host byte order
-		if (auto dson = dynamic_cast<Dson *>(obj))
+		struct Staged
 		{
-			converters().to_host(*dson);
-		}
-		return obj;
-	}
-
-	void to_host_internal(const Converter & converter)
-	{
-		header_to_host();
-		auto dson_header = header();
-		auto dson_data = static_cast<char *>(data());
-		if (!dson_data)
-			return;
-		converter(*dson_header, dson_data);
-	}
-
-	void to_network_internal(const Converter & converter)
-	{
-		auto dson_header = header();
-		auto dson_data = static_cast<char *>(data());
-		if (!dson_data)
-			return;
-		converter(*dson_header, dson_data);
-		header_to_network();
-	}
+			// nullptr => участок уже заполнен (см. add_scratch())
+			DsonObj * obj_;
+			std::size_t iov_index_;
+			std::size_t offset_;
+		};
 
-	void header_to_host() const noexcept
-	{
-		if (is_host_order())
-			return;
-		std::uint32_t * header = header_as_array();
-		for (std::uint32_t i = 0; i < header_array_len; ++i)
-		{
-			header[i] = ntohl(header[i]);
-		}
-	}
+		std::vector<iovec> iov_;
+		std::size_t iov_index_{0};
+		std::vector<Staged> staged_;
+		std::vector<char> staging_;
+		// Пользовательские и большие объекты выгружаются сами (copy_to_fd_*) в своё место в iov_, см. add_direct()
+		std::vector<Staged> direct_;
+		std::size_t direct_index_{0};
 
-	void header_to_network() const noexcept
-	{
-		if (is_network_order())
-			return;
-		std::uint32_t * header = header_as_array();
-		if (!header)
-			return;
-		for (std::uint32_t i = 0; i < header_array_len; ++i)
+		void clear() noexcept
 		{
-			header[i] = htonl(header[i]);
+			// Прерванная выгрузка: объект начнёт свою выгрузку сначала
+			for (std::size_t i = direct_index_; i < direct_.size(); ++i)
+			{
+				direct_[i].obj_->reset_state();
+			}
+			iov_.clear();
+			iov_index_ = 0;
+			staged_.clear();
+			staging_.clear();
+			direct_.clear();
+			direct_index_ = 0;
 		}
-	}
 
-	void move_from_other(Dson && other)
-	{
-		if (!was_buf_allocation_ && buf_)
+		void add(const void * buf, const std::size_t size)
 		{
-			/*
-			 * Если не было аллокаций, то это вьюха на чужой буфер => гарантировать его существование невозможно.
-			 * Поэтому просто всё копируем.
-			 */
-			buf_size_ = data_size();
-			buf_ = static_cast<char *>(std::malloc(static_cast<size_t>(buf_size_)));
-			if (!buf_)
-				return;
-			was_buf_allocation_ = true;
-			// Копируем header
-			char * buf = header_;
-			std::int32_t buf_size = header_size;
-			auto copy_result = other.copy_to_buf_host_order(buf, buf_size);
-			if (copy_result == Result::Error || buf_size)
-			{
-				state_ = State::Error;
+			if (!size)
 				return;
-			}
-			// Копируем данные
-			buf = buf_;
-			buf_size = buf_size_;
-			copy_result = other.copy_to_buf_host_order(buf, buf_size);
-			if (copy_result != Result::Ready || buf_size)
+			if (!iov_.empty())
 			{
-				state_ = State::Error;
+				// Соседние участки одного буфера (вьюха) склеиваются
+				iovec & last = iov_.back();
+				if (last.iov_base && static_cast<const char *>(last.iov_base) + last.iov_len == buf)
+				{
+					last.iov_len += size;
+					return;
+				}
 			}
-			return;
+			iov_.push_back(iovec{const_cast<void *>(buf), size});
 		}
 
-		// Обычный move всего
-		std::memcpy(header_, other.header_, static_cast<size_t>(header_size));
-		state_ = other.state_;
-		other.state_ = State::Error;
-		buf_ = other.buf_;
-		other.buf_ = nullptr;
-		buf_size_ = other.buf_size_;
-		was_buf_allocation_ = other.was_buf_allocation_;
-		dson_kind_ = other.dson_kind_;
-		std::swap(key_to_val_map_, other.key_to_val_map_);
-		offset_ = other.offset_;
-		std::swap(copy_iter_, other.copy_iter_);
-	}
-
-	void set_data_type_internal(const std::int32_t data_type)
-	{
-		Header * _header = header();
-		if (_header->mark_byte_order_ == mark_host_order)
+		void add_staged(DsonObj * obj)
 		{
-			_header->data_type_ = data_type;
+			const std::size_t size = static_cast<std::size_t>(obj->data_size() + header_size);
+			staged_.push_back(Staged{obj, iov_.size(), staging_.size()});
+			// адрес будет известен после аллокации staging_
+			iov_.push_back(iovec{nullptr, size});
+			staging_.resize(staging_.size() + size);
 		}
-		else
+
+		/**
+		 * @brief add_direct
+		 * Объект выгружается своим copy_to_fd_* между соседними буферами:
+		 * пользовательские объекты (например DsonProducerObj генерирует данные кусками)
+		 * и большие объекты библиотеки, чьи данные не стоит копировать в staging_
+		 */
+		void add_direct(DsonObj * obj)
 		{
-			header_as_array()[3] = int32_to_network(data_type);
+			direct_.push_back(Staged{obj, iov_.size(), 0});
+			iov_.push_back(iovec{nullptr, 0});
 		}
-	}
 
-	void set_data_size_internal(const std::int32_t data_size)
-	{
-		Header * _header = header();
-		if (_header->mark_byte_order_ == mark_host_order)
+		/**
+		 * @brief add_scratch
+		 * Место в промежуточном буфере под преобразованную копию (заголовок или данные),
+		 * заполняется сразу по возвращённому указателю (указатель валиден до следующего add_*)
+		 */
+		char * add_scratch(const std::size_t size)
 		{
-			_header->data_size_ = data_size;
+			const std::size_t offset = staging_.size();
+			staging_.resize(offset + size);
+			if (!staged_.empty() && !staged_.back().obj_ && staged_.back().iov_index_ + 1 == iov_.size())
+			{
+				// Подряд идущие копии (заголовок + число) - один участок
+				iov_.back().iov_len += size;
+			}
+			else
+			{
+				staged_.push_back(Staged{nullptr, iov_.size(), offset});
+				iov_.push_back(iovec{nullptr, size});
+			}
+			return staging_.data() + offset;
 		}
-		else
+
+		template <bool network_order>
+		bool stage()
 		{
-			header_as_array()[1] = int32_to_network(data_size);
+			for (const auto & it : staged_)
+			{
+				iovec & iov = iov_[it.iov_index_];
+				char * buf = staging_.data() + it.offset_;
+				iov.iov_base = buf;
+				if (!it.obj_)
+					continue;
+				std::int32_t buf_size = static_cast<std::int32_t>(iov.iov_len);
+				Result res;
+				if constexpr (network_order)
+				{
+					res = it.obj_->copy_to_buf_network_order(buf, buf_size);
+				}
+				else
+				{
+					res = it.obj_->copy_to_buf_host_order(buf, buf_size);
+				}
+				if (res != Result::Ready || buf_size)
+					return false;
+			}
+			return true;
 		}
-	}
 
-	/**
-	 * @brief copy_to_fd_internal
-	 * @param fd
-	 * @return
-	 * @note network_order нужен ли network byte order
-	 */
-	template <bool network_order>
-	Result copy_to_fd_internal(std::int32_t fd)
-	{
-		switch (state_)
+		template <bool network_order>
+		Result write(const std::int32_t fd)
 		{
-		case State::Ready:
+			while (iov_index_ < iov_.size())
 			{
-				if (dson_kind_ == DsonKind::DataBufNeedParse)
+				std::size_t end = iov_.size();
+				if (direct_index_ < direct_.size())
 				{
-					if ((is_host_order() && network_order) || (is_network_order() && !network_order))
+					const Staged & direct = direct_[direct_index_];
+					if (direct.iov_index_ == iov_index_)
 					{
-						/*
-						 * Если существующий byte order требует преобразований, то придётся
-						 * разобрать на отдельные объекты и преобразовать каждый
-						 */
-						parse_buf();
+						Result re;
+						if constexpr (network_order)
+						{
+							re = direct.obj_->copy_to_fd_network_order(fd);
+						}
+						else
+						{
+							re = direct.obj_->copy_to_fd_host_order(fd);
+						}
+						if (re != Result::Ready)
+							return re;
+						++direct_index_;
+						++iov_index_;
+						continue;
 					}
+					end = direct.iov_index_;
 				}
-
-				if (dson_kind_ == DsonKind::DsonContainer)
-				{
-					set_data_size_internal(data_size());
-				}
-
-				if constexpr (network_order)
+				const std::size_t count = std::min<std::size_t>(end - iov_index_, max_iovec_count);
+				auto writed = writev_to_fd(fd, iov_.data() + iov_index_, static_cast<std::int32_t>(count));
+				if (writed < 0)
+					return Result::Error;
+				if (writed == 0)
+					return Result::InProcess;
+				// Пропуск записанного, частично записанный буфер сдвигается
+				while (writed > 0)
 				{
-					if (dson_kind_ == DsonKind::OneObjectInDataBuf)
+					iovec & iov = iov_[iov_index_];
+					if (static_cast<std::size_t>(writed) >= iov.iov_len)
 					{
-						converters().to_network(*this);
+						writed -= static_cast<std::int64_t>(iov.iov_len);
+						++iov_index_;
 					}
 					else
 					{
-						header_to_network();
+						iov.iov_base = static_cast<char *>(iov.iov_base) + writed;
+						iov.iov_len -= static_cast<std::size_t>(writed);
+						writed = 0;
 					}
 				}
-				else
+			}
+			return Result::Ready;
+		}
+	};
+
+	/**
+	 * @brief gather_tree
+	 * Подготовка узла и его детей к выгрузке и сбор их буферов
+	 */
+	template <bool network_order>
+	bool gather_tree(GatherState & gather)
+	{
+		if (state_ != State::Ready)
+			return false;
+		if (const std::vector<char> * cached = encoded<network_order>())
+		{
+			gather.add(cached->data(), cached->size());
+			return true;
+		}
+		prepare_to_copy<network_order>();
+		if (state_ != State::Ready)
+			return false;
+		switch (dson_kind_)
+		{
+		case DsonKind::DsonContainer:
+			{
+				const Header header = output_header<network_order>();
+				std::memcpy(gather.add_scratch(header_size), &header, header_size);
+				for (auto & it : key_to_val_map_)
 				{
-					if (dson_kind_ == DsonKind::OneObjectInDataBuf)
+					DsonObj * obj = it.second.get();
+					if (auto dson = dson_cast<Dson>(obj))
 					{
-						converters().to_host(*this);
+						if (!dson->gather_tree<network_order>(gather))
+							return false;
 					}
 					else
 					{
-						header_to_host();
+						if (obj->state() != State::Ready)
+							return false;
+						if (can_stage(obj))
+						{
+							gather.add_staged(obj);
+						}
+						else
+						{
+							gather.add_direct(obj);
+						}
 					}
 				}
-				offset_ = 0;
-				state_ = State::CopyingHeader;
+				return true;
 			}
+		case DsonKind::DataBufNeedParse:
 			[[fallthrough]];
-		case State::CopyingHeader:
+		case DsonKind::OneObjectInDataBuf:
 			{
-				if (offset_ >= header_size)
-				{
-					assert(false);
-					return Result::Error;
-				}
-				char * _header = header_as_char_buf();
-				const auto writed = write_to_fd(fd, _header + offset_, header_size - offset_);
-				if (writed < 0)
-				{
-					state_ = State::Ready;
-					return Result::Error;
-				}
-
-				offset_ += writed;
-				if (offset_ < header_size)
-				{
-					return Result::InProcess;
-				}
-
-				if (dson_kind_ == DsonKind::DsonContainer)
+				if (need_conversion<network_order>())
 				{
-					copy_iter_ = key_to_val_map_.begin();
+					const Header header = output_header<network_order>();
+					std::memcpy(gather.add_scratch(header_size), &header, header_size);
 				}
 				else
 				{
-					offset_ = 0;
+					gather.add(header_as_char_buf(), header_size);
 				}
-				state_ = State::CopyingData;
-			}
-			[[fallthrough]];
-		case State::CopyingData:
-			{
-				if (dson_kind_ == DsonKind::DsonContainer)
+				const std::int32_t size = data_size();
+				if (size > 0)
 				{
-					if constexpr (network_order)
+					const void * buf = data();
+					if (!buf)
+						return false;
+					if (need_data_conversion<network_order>())
 					{
-						return copy_to_fd_internal_map_network(fd);
+						if (!copy_data_converted<network_order>(gather.add_scratch(static_cast<std::size_t>(size))))
+							return false;
 					}
 					else
 					{
-						return copy_to_fd_internal_map_host(fd);
+						gather.add(buf, static_cast<std::size_t>(size));
 					}
 				}
-				else
-				{
-					return copy_to_fd_internal_buf(fd);
-				}
+				return true;
 			}
-
-		default:
-			break;
 		}
-		assert(false);
-		return Result::Error;
-	} // copy_to_fd_internal
+		return false;
+	}
 
 	std::int32_t buf_size_without_header()
 	{
@@ -1171,109 +2795,66 @@ private:
 		return (buf_size_ - header_size);
 	}
 
-	Result copy_to_fd_internal_buf(std::int32_t fd)
-	{
-		char * buf = static_cast<char *>(data());
-		const std::int32_t size = buf_size_without_header();
-		if (offset_ >= size)
-		{
-			assert(false);
-			return Result::Error;
-		}
-		const auto writed = write_to_fd(fd, buf + offset_, size - offset_);
-		if (writed < 0)
-		{
-			state_ = State::Ready;
-			return Result::Error;
-		}
-		offset_ += writed;
-		if (size == offset_)
-		{
-			state_ = State::Ready;
-			return Result::Ready;
-		}
-		return Result::InProcess;
-	}
-
-	Result copy_to_fd_internal_map_network(std::int32_t fd)
+	/**
+	 * @brief copy_to_buf_internal
+	 * @param buf курсор по буферу
+	 * @param buf_size счётчик оставшегося объёма
+	 * @return Result
+	 * @note network_order нужен ли network byte order
+	 */
+	template <bool network_order>
+	Result copy_to_buf_internal(char *& buf, std::int32_t & buf_size)
 	{
-		while (copy_iter_ != key_to_val_map_.end())
+		if (state_ == State::Ready && encoded<network_order>())
 		{
-			const auto res = copy_iter_->second->copy_to_fd_network_order(fd);
-			if (res != Result::Ready)
-				return res;
-			++copy_iter_;
+			offset_ = 0;
+			extra_->copying_encoded_ = true;
+			state_ = State::CopyingData;
 		}
-		state_ = State::Ready;
-		return Result::Ready;
+		if (copying_encoded())
+			return copy_to_buf_encoded<network_order>(buf, buf_size);
+		return copy_to_buf_tree<network_order>(buf, buf_size);
 	}
 
-	Result copy_to_fd_internal_map_host(std::int32_t fd)
+	// Выгрузка закэшированного закодированного вида (см. cache_encoded())
+	template <bool network_order>
+	Result copy_to_buf_encoded(char *& buf, std::int32_t & buf_size)
 	{
-		while (copy_iter_ != key_to_val_map_.end())
+		const EncodedCache * _encoded = encoded_cache();
+		const std::vector<char> * cached = _encoded ? _encoded->get<network_order>() : nullptr;
+		if (!cached)
 		{
-			const auto res = copy_iter_->second->copy_to_fd_host_order(fd);
-			if (res != Result::Ready)
-				return res;
-			++copy_iter_;
+			// Узел изменили посреди выгрузки
+			assert(false);
+			extra_->copying_encoded_ = false;
+			state_ = State::Ready;
+			return Result::Error;
 		}
+		const std::int32_t size = static_cast<std::int32_t>(cached->size());
+		const auto writed = std::min(buf_size, size - offset_);
+		std::memcpy(buf, cached->data() + offset_, static_cast<std::size_t>(writed));
+		buf += writed;
+		offset_ += writed;
+		buf_size -= writed;
+		if (offset_ < size)
+			return Result::InProcess;
+		extra_->copying_encoded_ = false;
 		state_ = State::Ready;
 		return Result::Ready;
 	}
 
 	/**
-	 * @brief copy_to_fd_internal
-	 * @param buf курсор по буферу
-	 * @param buf_size счётчик оставшегося объёма
-	 * @return Result
-	 * @note network_order нужен ли network byte order
+	 * @brief copy_to_buf_tree
+	 * Выгрузка узла с обходом дерева
 	 */
 	template <bool network_order>
-	Result copy_to_buf_internal(char *& buf, std::int32_t & buf_size)
+	Result copy_to_buf_tree(char *& buf, std::int32_t & buf_size)
 	{
 		switch (state_)
 		{
 		case State::Ready:
 			{
-				if (dson_kind_ == DsonKind::DataBufNeedParse)
-				{
-					if ((is_host_order() && network_order) || (is_network_order() && !network_order))
-					{
-						/*
-						 * Если существующий byte order требует преобразований, то придётся
-						 * разобрать на отдельные объекты и преобразовать каждый
-						 */
-						parse_buf();
-					}
-				}
-
-				if (dson_kind_ == DsonKind::DsonContainer)
-				{
-					set_data_size_internal(data_size());
-				}
-
-				if constexpr (network_order)
-				{
-					if (dson_kind_ == DsonKind::OneObjectInDataBuf)
-					{
-						converters().to_network(*this);
-					}
-					else
-					{
-						header_to_network();
-					}
-				}
-				else
-				{
-					if (dson_kind_ == DsonKind::OneObjectInDataBuf)
-					{
-						converters().to_host(*this);
-					}
-					else
-					{
-						header_to_host();
-					}
-				}
+				prepare_to_copy<network_order>();
 				offset_ = 0;
 				state_ = State::CopyingHeader;
 			}
@@ -1286,7 +2867,8 @@ private:
 					return Result::Error;
 				}
 
-				char * _header = header_as_char_buf();
+				const Header header = output_header<network_order>();
+				const char * _header = reinterpret_cast<const char *>(&header);
 				const auto writed = std::min(buf_size, header_size - offset_);
 				std::memcpy(buf, _header + offset_, writed);
 				buf += writed;
@@ -1299,7 +2881,7 @@ private:
 
 				if (dson_kind_ == DsonKind::DsonContainer)
 				{
-					copy_iter_ = key_to_val_map_.begin();
+					copy_index_ = 0;
 				}
 				else
 				{
@@ -1323,7 +2905,7 @@ private:
 				}
 				else
 				{
-					return copy_to_buf_internal_buf(buf, buf_size);
+					return copy_to_buf_internal_buf<network_order>(buf, buf_size);
 				}
 			}
 
@@ -1332,18 +2914,54 @@ private:
 		}
 		assert(false);
 		return Result::Error;
-	} // copy_to_buf_internal
+	} // copy_to_buf_tree
 
+	template <bool network_order>
 	Result copy_to_buf_internal_buf(char *& buf, std::int32_t & buf_size)
 	{
-		char * local_buf = static_cast<char *>(data());
 		const std::int32_t size = buf_size_without_header();
+		if (size == 0)
+		{
+			// Пустые данные (пустой контейнер, пустая строка): выгружен только заголовок
+			state_ = State::Ready;
+			return Result::Ready;
+		}
 		if (offset_ >= size)
 		{
 			assert(false);
 			return Result::Error;
 		}
 
+		const char * local_buf = static_cast<char *>(data());
+		if (need_data_conversion<network_order>())
+		{
+			if (offset_ == 0 && buf_size >= size)
+			{
+				// Преобразуем сразу в месте назначения
+				if (!copy_data_converted<network_order>(buf))
+				{
+					reset_state();
+					return Result::Error;
+				}
+				buf += size;
+				buf_size -= size;
+				state_ = State::Ready;
+				return Result::Ready;
+			}
+			// Окно меньше данных: преобразованная копия выгружается по частям
+			std::vector<char> & scratch = extra().gather_.staging_;
+			if (offset_ == 0)
+			{
+				scratch.resize(static_cast<std::size_t>(size));
+				if (!copy_data_converted<network_order>(scratch.data()))
+				{
+					reset_state();
+					return Result::Error;
+				}
+			}
+			local_buf = scratch.data();
+		}
+
 		const auto writed = std::min(buf_size, size - offset_);
 		std::memcpy(buf, local_buf + offset_, writed);
 		buf += writed;
@@ -1360,12 +2978,12 @@ private:
 
 	Result copy_to_buf_internal_map_network(char *& buf, std::int32_t & buf_size)
 	{
-		while (copy_iter_ != key_to_val_map_.end())
+		while (copy_index_ < key_to_val_map_.size())
 		{
-			const auto res = copy_iter_->second->copy_to_buf_network_order(buf, buf_size);
+			const auto res = key_to_val_map_.by_index(copy_index_).second->copy_to_buf_network_order(buf, buf_size);
 			if (res != Result::Ready)
 				return res;
-			++copy_iter_;
+			++copy_index_;
 		}
 		state_ = State::Ready;
 		return Result::Ready;
@@ -1373,12 +2991,12 @@ private:
 
 	Result copy_to_buf_internal_map_host(char *& buf, std::int32_t & buf_size)
 	{
-		while (copy_iter_ != key_to_val_map_.end())
+		while (copy_index_ < key_to_val_map_.size())
 		{
-			const auto res = copy_iter_->second->copy_to_buf_host_order(buf, buf_size);
+			const auto res = key_to_val_map_.by_index(copy_index_).second->copy_to_buf_host_order(buf, buf_size);
 			if (res != Result::Ready)
 				return res;
-			++copy_iter_;
+			++copy_index_;
 		}
 		state_ = State::Ready;
 		return Result::Ready;
@@ -1388,17 +3006,148 @@ private:
 	{
 		if (buf_size <= 0)
 			return nullptr;
-		if (buf_ && was_buf_allocation_)
+		if (buf_ && was_buf_allocation_ && !buf_from_arena_ && !is_buf_inline() && !buf_owner_)
 			std::free(buf_);
-		buf_ = static_cast<char *>(std::malloc(static_cast<size_t>(buf_size)));
+		buf_owner_.reset();
+		if (buf_size <= inline_buf_size && data_type() != types_map<DsonContainer>::value)
+		{
+			/*
+			 * Скаляры и небольшие объекты хранятся внутри Dson без аллокации.
+			 * Контейнеры сюда не попадают: их дети после разбора смотрят в buf_,
+			 * а встроенный буфер при move переезжает.
+			 */
+			buf_ = inline_buf_;
+			buf_from_arena_ = false;
+		}
+		else if (arena_)
+		{
+			buf_ = static_cast<char *>(arena_->allocate(static_cast<size_t>(buf_size)));
+			buf_from_arena_ = true;
+		}
+		else
+		{
+			buf_ = static_cast<char *>(std::malloc(static_cast<size_t>(buf_size)));
+			buf_from_arena_ = false;
+		}
 		if (buf_)
 		{
 			was_buf_allocation_ = true;
 			buf_size_ = buf_size;
 		}
+		else
+		{
+			was_buf_allocation_ = false;
+			buf_from_arena_ = false;
+		}
 		return buf_;
 	}
 
+	/*
+	 * Узел перестаёт владеть ареной (его очистка не сбросит арену родителя),
+	 * но занимает её, пока его буфер и узлы из неё используются.
+	 */
+	void detach_arena() noexcept
+	{
+		if (!arena_)
+			return;
+		if (borrowed_arena_ != arena_)
+		{
+			if (borrowed_arena_)
+				borrowed_arena_->release();
+			borrowed_arena_ = arena_;
+			borrowed_arena_->borrow();
+		}
+		arena_.reset();
+	}
+
+	/**
+	 * @brief make_node
+	 * Создание дочернего Dson: в арене если она назначена, иначе в куче
+	 */
+	template <typename... Args>
+	std::unique_ptr<Dson> make_node(Args &&... args)
+	{
+		return std::unique_ptr<Dson>(new (arena_.get()) Dson(std::forward<Args>(args)...));
+	}
+
+	/**
+	 * @brief make_view_node
+	 * Дочерняя вьюха на ребёнка внутри buf_.
+	 * Ребёнок держит буфер сам (счётчиком ссылок или занимая арену, см. share_buf_with())
+	 * и переживает родителя (move в очередь, в колбэк и т.п.).
+	 * Не держится только внешний буфер вьюхи Dson(char *): его время жизни - забота владельца.
+	 */
+	std::unique_ptr<Dson> make_view_node(char * ptr)
+	{
+		auto re = make_node(ptr);
+		share_buf_with(*re);
+		return re;
+	}
+
+	/*
+	 * Вьюха view смотрит в buf_: держит буфер кучи счётчиком ссылок,
+	 * а буфер арены - занимая арену (DsonArena::borrow()): владелец не сбросит арену,
+	 * пока вьюху (или смуванный из неё Dson) не очистят.
+	 */
+	void share_buf_with(Dson & view)
+	{
+		view.buf_owner_ = share_buf();
+		view.buf_mapped_ = buf_mapped_;
+		// Буфер из своей арены или из чужой (дерево смувано от владельца арены, мы сами вьюха)
+		const std::shared_ptr<DsonArena> & arena = (buf_from_arena_ && arena_) ? arena_ : borrowed_arena_;
+		if (arena && view.borrowed_arena_ != arena)
+		{
+			if (view.borrowed_arena_)
+				view.borrowed_arena_->release();
+			view.borrowed_arena_ = arena;
+			view.borrowed_arena_->borrow();
+		}
+	}
+
+	/*
+	 * Владелец буфера для дочерних вьюх.
+	 * Собственный буфер из кучи при первом запросе переводится под счётчик ссылок.
+	 * Буфер арены не переводится: вьюхи удерживают арену (см. share_buf_with()).
+	 */
+	const std::shared_ptr<char> & share_buf()
+	{
+		if (!buf_owner_ && buf_ && was_buf_allocation_ && !buf_from_arena_ && !is_buf_inline())
+		{
+			buf_owner_ = std::shared_ptr<char>(buf_, std::free);
+		}
+		return buf_owner_;
+	}
+
+	// Место под указатель на арену перед узлом (с сохранением выравнивания узла)
+	static constexpr std::size_t node_prefix_size{alignof(std::max_align_t)};
+
+	static void * allocate_node(std::size_t size, DsonArena * arena)
+	{
+		void * mem = arena ? arena->allocate(size + node_prefix_size) : std::malloc(size + node_prefix_size);
+		if (!mem)
+			throw std::bad_alloc{};
+		*static_cast<DsonArena **>(mem) = arena;
+		return static_cast<char *>(mem) + node_prefix_size;
+	}
+
+	static void deallocate_node(void * ptr) noexcept
+	{
+		if (!ptr)
+			return;
+		void * mem = static_cast<char *>(ptr) - node_prefix_size;
+		if (*static_cast<DsonArena **>(mem))
+		{
+			// Память узла вернётся арене целиком при её сбросе
+			return;
+		}
+		std::free(mem);
+	}
+
+	bool is_buf_inline() const noexcept
+	{
+		return buf_ == inline_buf_;
+	}
+
 	void clear_header()
 	{
 		Header * _header = header();
@@ -1408,33 +3157,191 @@ private:
 		_header->data_type_ = types_map<Empty>::value;
 	}
 
-	void copy_to_stream_header_internal(std::ofstream & out, const std::int32_t data_size)
+private:
+	/*
+	 * Члены упорядочены по выравниванию (без дыр между ними): Dson - узел дерева,
+	 * размер узла умножается на число детей.
+	 */
+	alignas(Header) mutable char header_[sizeof(Header)];
+
+	// Размер buf_
+	std::int32_t buf_size_{0};
+
+	/*
+	 * Указатель на буффер загруженный с сети (без заголовка)
+	 * или на внешний буффер (с заголовком)
+	 */
+	char * buf_{nullptr};
+
+	/*
+	 * Встроенный буфер для небольших данных (числа, double, короткие строки):
+	 * если размер данных не больше inline_buf_size, то buf_ указывает сюда.
+	 */
+	static constexpr std::int32_t inline_buf_size{24};
+	alignas(std::max_align_t) char inline_buf_[inline_buf_size];
+
+	// Арена из которой выделяются буфер и узлы детей (nullptr => куча)
+	std::shared_ptr<DsonArena> arena_;
+
+	/*
+	 * Чужая арена, в которой лежит смуванное к нам дерево
+	 * (например сообщение ушло из цикла соединения в очередь отправки).
+	 * Удерживается живой пока дерево не очищено.
+	 */
+	std::shared_ptr<DsonArena> borrowed_arena_;
+
+	/*
+	 * Владелец буфера под счётчиком ссылок (nullptr => буфер свой или внешний).
+	 * Держит буфер пока на него смотрит этот Dson или его дочерние вьюхи,
+	 * для map_file() держит отображение файла.
+	 */
+	std::shared_ptr<char> buf_owner_;
+
+	/*
+	 * Содержимое Dson.
+	 * Позволяет искать по ключу целевой объект.
+	 */
+	ObjectsMap key_to_val_map_;
+
+	// Индекс детей DsonKind::DataBufNeedParse контейнера (см. index_buf())
+	std::vector<ChildIndex> index_;
+
+	// Контейнер в котором лежит этот Dson (nullptr если корень)
+	Dson * parent_{nullptr};
+
+	/*
+	 * Закодированный вид узла в host и network byte order (см. cache_encoded()).
+	 * Сбрасывается при изменении узла или его детей (см. invalidate_caches()),
+	 * память буферов при сбросе сохраняется.
+	 */
+	struct EncodedCache
 	{
-		if (dson_kind_ == DsonKind::DsonContainer)
+		std::vector<char> buf_[2];
+		bool valid_[2]{false, false};
+
+		void invalidate() noexcept
+		{
+			valid_[0] = false;
+			valid_[1] = false;
+		}
+
+		template <bool network_order>
+		const std::vector<char> * get() const noexcept
+		{
+			return valid_[network_order] ? &buf_[network_order] : nullptr;
+		}
+	};
+
+	// Загрузка с фильтром ключей (см. set_load_filter()), создаётся при установке фильтра
+	struct FilteredLoad
+	{
+		KeyFilter filter_;
+		// Идёт загрузка с фильтром
+		bool active_{false};
+		// Заголовок очередного ребёнка
+		alignas(Header) char header_[sizeof(Header)];
+		std::int32_t header_offset_{0};
+		// Загружаемый нужный ребёнок (с ареной родителя, см. load_filtered())
+		std::unique_ptr<Dson> child_;
+		// Сколько данных ненужного ребёнка осталось пропустить
+		std::int32_t skip_{0};
+
+		void reset() noexcept
+		{
+			active_ = false;
+			header_offset_ = 0;
+			if (child_)
+			{
+				child_->detach_arena();
+				child_.reset();
+			}
+			skip_ = 0;
+		}
+
+		void start() noexcept
 		{
-			set_data_size_internal(data_size);
+			reset();
+			active_ = true;
 		}
-		char * buf = header_as_char_buf();
-		std::copy(buf, buf + header_size, std::ostream_iterator<char>(out));
+	};
+
+	/*
+	 * Состояние, которое нужно немногим узлам (обычно корню сообщения):
+	 * выгрузка в fd, кэш закодированного вида, DsonSink, фильтр ключей, потоковый разбор.
+	 * Лежит отдельно, чтобы не увеличивать каждый узел дерева.
+	 * Создаётся при первом использовании и живёт до разрушения Dson (переживает clear()).
+	 */
+	struct Extra
+	{
+		// Состояние выгрузки через writev()
+		GatherState gather_;
+
+		// см. cache_encoded(), nullptr => кэш выключен
+		std::unique_ptr<EncodedCache> encoded_;
+		// Идёт выгрузка из encoded_ (copy_to_buf_*)
+		bool copying_encoded_{false};
+
+		// Идёт загрузка данных в DsonSink (см. load_from_fd(fd, sink, threshold))
+		bool loading_to_sink_{false};
+		bool data_in_sink_{false};
+
+		// Сколько байт данных уже выдано детьми через next_loaded()
+		std::int32_t streamed_{0};
+
+		// см. set_load_filter(), nullptr => загружать всё
+		std::unique_ptr<FilteredLoad> filtered_;
+
+		// Сброс перед новой загрузкой (clear()), фильтр и кэш остаются
+		void reset() noexcept
+		{
+			copying_encoded_ = false;
+			loading_to_sink_ = false;
+			data_in_sink_ = false;
+			streamed_ = 0;
+			if (filtered_)
+				filtered_->reset();
+		}
+	};
+	std::unique_ptr<Extra> extra_;
+
+	Extra & extra()
+	{
+		if (!extra_)
+			extra_ = std::make_unique<Extra>();
+		return *extra_;
 	}
 
-	void copy_to_stream_data_internal(std::ofstream & out, const std::int32_t data_size)
+	EncodedCache * encoded_cache() const noexcept
 	{
-		auto buf = static_cast<char *>(data());
-		std::copy(buf, buf + data_size, std::ostream_iterator<char>(out));
+		return extra_ ? extra_->encoded_.get() : nullptr;
 	}
 
-private:
-	alignas(Header) mutable char header_[sizeof(Header)];
+	FilteredLoad * filtered() const noexcept
+	{
+		return extra_ ? extra_->filtered_.get() : nullptr;
+	}
+
+	bool copying_encoded() const noexcept
+	{
+		return extra_ && extra_->copying_encoded_;
+	}
+
+	bool loading_to_sink() const noexcept
+	{
+		return extra_ && extra_->loading_to_sink_;
+	}
 
 	/*
-	 * Указатель на буффер загруженный с сети (без заголовка)
-	 * или на внешний буффер (с заголовком)
+	 * Позиция выгрузки key_to_val_map_.
+	 * Индекс, а не итератор: переживает перевыделение памяти FlatMap
 	 */
-	char * buf_{nullptr};
+	std::size_t copy_index_{0};
 
-	// Размер buf_
-	std::int32_t buf_size_{0};
+	// Закэшированный размер данных DsonKind::DsonContainer (-1 => не посчитан)
+	mutable std::int32_t cached_data_size_{-1};
+
+	// Сколько детей могут поменять размер незаметно (см. DsonObj::is_data_size_fixed())
+	std::int32_t volatile_children_{0};
 
 	/*
 	 * Аллоцировал ли data_buf_ сам,
@@ -1443,8 +3350,14 @@ private:
 	 */
 	bool was_buf_allocation_{false};
 
+	// buf_ выделен из arena_ (освобождать не надо)
+	bool buf_from_arena_{false};
+
+	// buf_ смотрит в отображение файла (см. map_file())
+	bool buf_mapped_{false};
+
 	// Что лежит внутри
-	enum class DsonKind
+	enum class DsonKind : std::uint8_t
 	{
 		// Объекты лежат в key_to_val_map_
 		DsonContainer,
@@ -1460,15 +3373,33 @@ private:
 	DsonKind dson_kind_{DsonKind::DsonContainer};
 
 	/*
-	 * Содержимое Dson.
-	 * Позволяет искать по ключу целевой объект.
+	 * Все дети в host order (см. map()).
+	 * Сбрасывается при добавлении детей и при изменении ребёнка (см. invalidate_caches())
 	 */
-	std::map<std::int32_t, std::unique_ptr<DsonObj>> key_to_val_map_;
+	bool children_host_order_{false};
+
+	bool indexed_{false};
 
-	// Итератор выгрузки key_to_val_map_
-	decltype(key_to_val_map_.begin()) copy_iter_{};
+	/*
+	 * Вид объекта (Kind::Dson) выставляется только здесь: член конструируется в любом
+	 * конструкторе Dson, включая пользовательские специализации Dson(T data)
+	 */
+	struct KindMark
+	{
+		explicit KindMark(Dson & self) noexcept
+		{
+			self.kind_ = obj_kind;
+		}
+	};
+	KindMark kind_mark_{*this};
 };
 
+inline std::istream & operator>>(std::istream & in, Dson & dson)
+{
+	dson.load_from_stream(in);
+	return in;
+}
+
 inline std::ifstream & operator>>(std::ifstream & in, Dson & dson)
 {
 	dson.load_from_stream(in);
@@ -1479,93 +3410,33 @@ inline void Dson::Converters::dson_lib_defined_converters(
 	ConvertersMap & to_host_order,
 	ConvertersMap & to_network_order)
 {
+	// Указатели на функции (а не лямбды): таблица диспетчеризации вызывает их напрямую
 	{ // std::int32_t, std::uint32_t,
-		auto to_host = [](Dson::Header &, char * data)
-		{
-			std::uint32_t * var = std::launder(reinterpret_cast<std::uint32_t *>(data));
-			*var = ntohl(*var);
-		};
-		auto to_network = [](Dson::Header &, char * data)
-		{
-			std::uint32_t * var = std::launder(reinterpret_cast<std::uint32_t *>(data));
-			*var = htonl(*var);
-		};
-		{
-			const auto key = types_map<std::int32_t>::value;
-			to_host_order.insert_or_assign(key, to_host);
-			to_network_order.insert_or_assign(key, to_network);
-		}
+		for (const auto key : {types_map<std::int32_t>::value, types_map<std::uint32_t>::value})
 		{
-			const auto key = types_map<std::uint32_t>::value;
-			to_host_order.insert_or_assign(key, to_host);
-			to_network_order.insert_or_assign(key, to_network);
+			to_host_order.insert_or_assign(key, &Converters::uint32_to_host);
+			to_network_order.insert_or_assign(key, &Converters::uint32_to_network);
 		}
 	} // std::uint32_t, std::int32_t
 
 	{ // std::int64_t, std::uint64_t,
-		auto to_host = [](Dson::Header &, char * data)
-		{
-			std::uint64_t * var = std::launder(reinterpret_cast<std::uint64_t *>(data));
-			*var = ntohll(*var);
-		};
-		auto to_network = [](Dson::Header &, char * data)
-		{
-			std::uint64_t * var = std::launder(reinterpret_cast<std::uint64_t *>(data));
-			*var = htonll(*var);
-		};
-		{
-			const auto key = types_map<std::int64_t>::value;
-			to_host_order.insert_or_assign(key, to_host);
-			to_network_order.insert_or_assign(key, to_network);
-		}
+		for (const auto key : {types_map<std::int64_t>::value, types_map<std::uint64_t>::value})
 		{
-			const auto key = types_map<std::uint64_t>::value;
-			to_host_order.insert_or_assign(key, to_host);
-			to_network_order.insert_or_assign(key, to_network);
+			to_host_order.insert_or_assign(key, &Converters::uint64_to_host);
+			to_network_order.insert_or_assign(key, &Converters::uint64_to_network);
 		}
 	} // std::uint64_t, std::int64_t
 
 	{ // double
 		const auto key = types_map<double>::value;
-		to_host_order.insert_or_assign(
-			key,
-			[](Dson::Header &, char * data)
-			{
-				double_in_buf_to_host_order(data);
-			});
-
-		to_network_order.insert_or_assign(
-			key,
-			[](Dson::Header &, char * data)
-			{
-				double_in_buf_to_network_order(data);
-			});
+		to_host_order.insert_or_assign(key, &Converters::double_to_host);
+		to_network_order.insert_or_assign(key, &Converters::double_to_network);
 	} // double
 
 	{ // std::vector<std::uint32_t>
 		const auto key = types_map<std::vector<std::uint32_t>>::value;
-		to_host_order.insert_or_assign(
-			key,
-			[](Dson::Header & header, char * data)
-			{
-				std::uint32_t size = header.data_size_ / sizeof(std::uint32_t);
-				std::uint32_t * array = std::launder(reinterpret_cast<std::uint32_t *>(data));
-				for (std::uint32_t i = 0; i < size; ++i)
-				{
-					array[i] = ntohl(array[i]);
-				}
-			});
-		to_network_order.insert_or_assign(
-			key,
-			[](Dson::Header & header, char * data)
-			{
-				std::uint32_t size = header.data_size_ / sizeof(std::uint32_t);
-				std::uint32_t * array = std::launder(reinterpret_cast<std::uint32_t *>(data));
-				for (std::uint32_t i = 0; i < size; ++i)
-				{
-					array[i] = htonl(array[i]);
-				}
-			});
+		to_host_order.insert_or_assign(key, &Converters::uint32_array_to_host);
+		to_network_order.insert_or_assign(key, &Converters::uint32_array_to_network);
 	} // std::vector<std::uint32_t>
 
 	// для std::string преобразования не требуются
@@ -0,0 +1,282 @@
+#ifndef DSON_BROADCAST_H
+#define DSON_BROADCAST_H
+
+#include <dson/dson.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <memory>
+#include <vector>
+
+namespace hi
+{
+
+/**
+ * @brief The DsonFrame class
+ * Неизменяемый сериализованный Dson (заголовок + данные) с подсчётом ссылок.
+ * Копирование кадра - это копирование указателя: один кадр стоит во всех очередях отправки
+ * подписчиков, байты не копируются и не преобразуются повторно.
+ */
+class DsonFrame
+{
+public:
+	DsonFrame() = default;
+
+	/**
+	 * @brief encode_network_order
+	 * Сериализация один раз (сам dson не меняется, см. copy_to_buf_network_order())
+	 * @return пустой кадр если сериализовать не удалось
+	 */
+	static DsonFrame encode_network_order(DsonObj & dson)
+	{
+		return encode<true>(dson);
+	}
+
+	static DsonFrame encode_host_order(DsonObj & dson)
+	{
+		return encode<false>(dson);
+	}
+
+	bool empty() const noexcept
+	{
+		return !buf_;
+	}
+
+	const char * data() const noexcept
+	{
+		return buf_.get();
+	}
+
+	std::int32_t size() const noexcept
+	{
+		return size_;
+	}
+
+	// Сколько очередей (и прочих владельцев) держат кадр
+	long use_count() const noexcept
+	{
+		return buf_.use_count();
+	}
+
+private:
+	template <bool network_order>
+	static DsonFrame encode(DsonObj & dson)
+	{
+		DsonFrame re;
+		const std::int32_t size = dson.data_size() + DsonObj::header_size;
+		char * buf = static_cast<char *>(std::malloc(static_cast<std::size_t>(size)));
+		if (!buf)
+			return re;
+		re.buf_ = std::shared_ptr<char>(buf, std::free);
+		std::int32_t left = size;
+		Result result;
+		if constexpr (network_order)
+		{
+			result = dson.copy_to_buf_network_order(buf, left);
+		}
+		else
+		{
+			result = dson.copy_to_buf_host_order(buf, left);
+		}
+		if (result != Result::Ready || left)
+		{
+			dson.reset_state();
+			return DsonFrame{};
+		}
+		re.size_ = size;
+		return re;
+	}
+
+	std::shared_ptr<char> buf_;
+	std::int32_t size_{0};
+};
+
+/**
+ * @brief The DsonFdQueue class
+ * Очередь отправки кадров в один неблокирующий fd.
+ * Хранит только позицию записи в текущем кадре: кадры общие для всех очередей.
+ * Несколько кадров уходят одним writev().
+ */
+class DsonFdQueue
+{
+public:
+	explicit DsonFdQueue(std::int32_t fd)
+		: fd_{fd}
+	{
+	}
+
+	void push(DsonFrame frame)
+	{
+		if (!frame.empty())
+			frames_.push_back(std::move(frame));
+	}
+
+	/**
+	 * @brief write
+	 * Отправить сколько возможно
+	 * @return Result::Ready очередь пуста, Result::InProcess fd не готов принять всё,
+	 * Result::Error ошибка записи
+	 */
+	Result write()
+	{
+		while (!frames_.empty())
+		{
+			const std::size_t count = std::min<std::size_t>(frames_.size(), max_iovec_count);
+			iov_.resize(count);
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				const DsonFrame & frame = frames_[i];
+				const std::int32_t offset = i ? 0 : offset_;
+				iov_[i].iov_base = const_cast<char *>(frame.data()) + offset;
+				iov_[i].iov_len = static_cast<std::size_t>(frame.size() - offset);
+			}
+			auto writed = writev_to_fd(fd_, iov_.data(), static_cast<std::int32_t>(count));
+			if (writed < 0)
+				return Result::Error;
+			if (writed == 0)
+				return Result::InProcess;
+			while (writed > 0)
+			{
+				const std::int64_t left = frames_.front().size() - offset_;
+				if (writed >= left)
+				{
+					writed -= left;
+					offset_ = 0;
+					frames_.pop_front();
+				}
+				else
+				{
+					offset_ += static_cast<std::int32_t>(writed);
+					writed = 0;
+				}
+			}
+		}
+		return Result::Ready;
+	}
+
+	std::int32_t fd() const noexcept
+	{
+		return fd_;
+	}
+
+	bool empty() const noexcept
+	{
+		return frames_.empty();
+	}
+
+	std::size_t size() const noexcept
+	{
+		return frames_.size();
+	}
+
+private:
+	const std::int32_t fd_;
+	std::deque<DsonFrame> frames_;
+	// Позиция записи в frames_.front()
+	std::int32_t offset_{0};
+	std::vector<iovec> iov_;
+};
+
+/**
+ * @brief The DsonBroadcast class
+ * Рассылка одного Dson многим подписчикам (pub/sub):
+ * Dson сериализуется один раз в DsonFrame, кадр ставится в очереди всех подписчиков,
+ * для каждого fd хранится только своя позиция записи.
+ * Сам Dson после publish() свободен (его можно менять и рассылать снова).
+ *
+ * Потоко небезопасно.
+ * @note чтобы отключившийся подписчик попадал в take_failed(), а не завершал процесс,
+ * приложение должно игнорировать SIGPIPE.
+ */
+class DsonBroadcast
+{
+public:
+	void add(std::int32_t fd)
+	{
+		queues_.push_back(std::make_unique<DsonFdQueue>(fd));
+	}
+
+	void remove(std::int32_t fd)
+	{
+		queues_.erase(
+			std::remove_if(
+				queues_.begin(),
+				queues_.end(),
+				[fd](const std::unique_ptr<DsonFdQueue> & queue)
+				{
+					return queue->fd() == fd;
+				}),
+			queues_.end());
+	}
+
+	/**
+	 * @brief publish
+	 * Сериализовать dson (network order) и разослать всем подписчикам
+	 * @return Result::Error если dson не удалось сериализовать,
+	 * иначе результат flush()
+	 */
+	Result publish(DsonObj & dson)
+	{
+		DsonFrame frame = DsonFrame::encode_network_order(dson);
+		if (frame.empty())
+			return Result::Error;
+		return publish(std::move(frame));
+	}
+
+	Result publish(DsonFrame frame)
+	{
+		for (auto & queue : queues_)
+		{
+			queue->push(frame);
+		}
+		return flush();
+	}
+
+	/**
+	 * @brief flush
+	 * Дописать очереди всех подписчиков.
+	 * Подписчики с ошибкой записи удаляются, их fd доступны через take_failed().
+	 * @return Result::Ready если все очереди пусты, иначе Result::InProcess
+	 */
+	Result flush()
+	{
+		Result re{Result::Ready};
+		for (auto it = queues_.begin(); it != queues_.end();)
+		{
+			const Result result = (*it)->write();
+			if (result == Result::Error)
+			{
+				failed_.push_back((*it)->fd());
+				it = queues_.erase(it);
+				continue;
+			}
+			if (result == Result::InProcess)
+				re = Result::InProcess;
+			++it;
+		}
+		return re;
+	}
+
+	// fd подписчиков, удалённых из-за ошибок записи
+	std::vector<std::int32_t> take_failed()
+	{
+		std::vector<std::int32_t> re;
+		re.swap(failed_);
+		return re;
+	}
+
+	std::size_t subscribers() const noexcept
+	{
+		return queues_.size();
+	}
+
+private:
+	std::vector<std::unique_ptr<DsonFdQueue>> queues_;
+	std::vector<std::int32_t> failed_;
+};
+
+} // namespace hi
+
+#endif // DSON_BROADCAST_H
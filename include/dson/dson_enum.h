@@ -0,0 +1,437 @@
+#ifndef DSON_ENUM_H
+#define DSON_ENUM_H
+
+#include <dson/dson.h>
+
+#include <array>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace hi
+{
+
+/**
+ * @brief The DsonEnum class
+ * Контейнер с известным на этапе компиляции набором ключей:
+ * ключи - плотный enum (0, 1, ..., max_key - 1), дети лежат в массиве по индексу ключа,
+ * поэтому get()/emplace() - прямое обращение к слоту без поиска.
+ *
+ * На проводе это обычный Dson контейнер (дети по возрастанию ключа):
+ * DsonEnum можно отправить и загрузить как Dson, вложить в Dson (emplace()),
+ * а загруженный Dson перевести в DsonEnum без копирования данных.
+ *
+ * Пример:
+ *  enum class Keys : std::int32_t { Id, Name, max };
+ *  DsonEnum<Keys> message;
+ *  message.emplace(Keys::Id, 7u);
+ *  const auto id = to_uint32(message.get(Keys::Id));
+ *
+ * Потоко небезопасно.
+ * @note выгрузка в fd кодирует контейнер целиком в свой буфер и отправляет его одним write(),
+ * большие данные (DsonFileObj и т.п.) лучше отправлять в обычном Dson
+ */
+template <typename Key, Key max_key = Key::max>
+class DsonEnum : public DsonObj
+{
+	static_assert(std::is_enum<Key>::value || std::is_integral<Key>::value, "Key must be enum or integral");
+
+public:
+	static constexpr std::size_t slots_count{static_cast<std::size_t>(max_key)};
+	static_assert(slots_count > 0, "max_key must be greater than first key");
+
+	DsonEnum()
+	{
+		setup_header(0);
+	}
+
+	template <typename K>
+	explicit DsonEnum(K key)
+	{
+		setup_header(static_cast<DsonKey>(key));
+	}
+
+	/**
+	 * @brief DsonEnum
+	 * Из загруженного Dson контейнера (см. assign())
+	 */
+	explicit DsonEnum(Dson && dson)
+	{
+		setup_header(0);
+		assign(std::move(dson));
+	}
+
+	DsonEnum(DsonEnum && other) = default;
+	DsonEnum & operator=(DsonEnum && other) = default;
+
+	/**
+	 * @brief assign
+	 * Перевести загруженный Dson контейнер в DsonEnum:
+	 * дети переезжают в слоты вьюхами на буфер dson (без копирования данных),
+	 * буфер удерживается детьми: буфер кучи - счётчиком ссылок, буфер арены - занимая арену
+	 * (арену dson не сбросят, пока слоты не очищены).
+	 * Дети с ключами вне [0, max_key) отбрасываются (другая версия протокола).
+	 * @param dson после вызова пустой
+	 * @return false если dson не контейнер
+	 */
+	bool assign(Dson && dson)
+	{
+		clear();
+		if (dson.state() != State::Ready || dson.data_type() != types_map<DsonContainer>::value)
+			return false;
+		header_.key_ = dson.key();
+
+		/*
+		 * Контейнер ещё не разобран: дети берутся прямо из буфера.
+		 * Созданные через get() дети могли измениться - тогда переезжают дети из map(),
+		 * как и когда часть детей уже выдана вызывающему через next_loaded() (map() разбирает весь буфер)
+		 */
+		const bool from_buf = !dson.has_child_objects() && !dson.streamed();
+		Dson child;
+		bool streamed{false};
+		while (from_buf && dson.next_loaded(child))
+		{
+			streamed = true;
+			const DsonKey _key = child.key();
+			if (in_range(_key))
+				slots_[static_cast<std::size_t>(_key)] = std::make_unique<Dson>(std::move(child));
+		}
+		if (!streamed)
+		{
+			for (auto & it : dson.map())
+			{
+				auto obj = dson_cast<Dson>(it.second.get());
+				if (obj && in_range(it.first))
+					slots_[static_cast<std::size_t>(it.first)] = std::make_unique<Dson>(std::move(*obj));
+			}
+		}
+		dson.clear();
+		return true;
+	}
+
+	/**
+	 * @brief emplace
+	 * Положить объект в слот ключа (старый объект удаляется)
+	 */
+	void emplace(Key key, Dson obj)
+	{
+		set(key, std::make_unique<Dson>(std::move(obj)));
+	}
+
+	template <typename T>
+	typename std::enable_if<std::is_base_of<DsonObj, T>::value, void>::type emplace(Key key, T obj)
+	{
+		set(key, std::make_unique<T>(std::move(obj)));
+	}
+
+	void emplace(Key key, std::unique_ptr<DsonObj> obj)
+	{
+		set(key, std::move(obj));
+	}
+
+	/**
+	 * @brief get
+	 * Объект по ключу (Dson в host order)
+	 * @return nullptr если слот пуст
+	 */
+	DsonObj * get(Key key)
+	{
+		const auto index = static_cast<std::size_t>(key);
+		if (index >= slots_count)
+			return nullptr;
+		DsonObj * obj = slots_[index].get();
+		if (auto dson = dson_cast<Dson>(obj))
+		{
+			Dson::converters().to_host(*dson);
+		}
+		return obj;
+	}
+
+	DsonObj * operator[](Key key)
+	{
+		return get(key);
+	}
+
+	bool contains(Key key) const noexcept
+	{
+		const auto index = static_cast<std::size_t>(key);
+		return index < slots_count && slots_[index];
+	}
+
+	// Очистить слот
+	void erase(Key key)
+	{
+		const auto index = static_cast<std::size_t>(key);
+		if (index < slots_count)
+			slots_[index].reset();
+	}
+
+	void clear()
+	{
+		for (auto & slot : slots_)
+		{
+			slot.reset();
+		}
+		reset_output();
+	}
+
+public: // DsonObj
+	bool is_host_order() const noexcept override
+	{
+		return true;
+	}
+
+	bool is_network_order() const noexcept override
+	{
+		return mark_host_order == mark_network_order;
+	}
+
+	std::int32_t data_size() const noexcept override
+	{
+		std::int32_t re{0};
+		for (const auto & slot : slots_)
+		{
+			if (slot)
+				re += header_size + slot->data_size();
+		}
+		return re;
+	}
+
+	// Дети меняются без ведома DsonEnum: размер считается при каждом запросе
+	bool is_data_size_fixed() const noexcept override
+	{
+		return false;
+	}
+
+	DsonKey key() const noexcept override
+	{
+		return header_.key_;
+	}
+
+	void set_key(DsonKey _key) noexcept override
+	{
+		header_.key_ = _key;
+	}
+
+	TypeMarker data_type() const noexcept override
+	{
+		return types_map<DsonContainer>::value;
+	}
+
+	using DsonObj::copy_to_stream_host_order;
+	using DsonObj::copy_to_stream_network_order;
+
+	void copy_to_stream_host_order(std::ostream & out) override
+	{
+		copy_to_stream_local<false>(out);
+	}
+
+	void copy_to_stream_network_order(std::ostream & out) override
+	{
+		copy_to_stream_local<true>(out);
+	}
+
+	Result copy_to_fd_host_order(std::int32_t fd) override
+	{
+		return copy_to_fd_local<false>(fd);
+	}
+
+	Result copy_to_fd_network_order(std::int32_t fd) override
+	{
+		return copy_to_fd_local<true>(fd);
+	}
+
+	Result copy_to_buf_host_order(char *& buf, std::int32_t & buf_size) override
+	{
+		return copy_to_buf_local<false>(buf, buf_size);
+	}
+
+	Result copy_to_buf_network_order(char *& buf, std::int32_t & buf_size) override
+	{
+		return copy_to_buf_local<true>(buf, buf_size);
+	}
+
+	State state() const noexcept override
+	{
+		return state_;
+	}
+
+	void reset_state() noexcept override
+	{
+		reset_output();
+	}
+
+private:
+	static bool in_range(const DsonKey key) noexcept
+	{
+		return key >= 0 && static_cast<std::size_t>(key) < slots_count;
+	}
+
+	void setup_header(const DsonKey key)
+	{
+		header_.mark_byte_order_ = mark_host_order;
+		header_.data_size_ = 0;
+		header_.key_ = key;
+		header_.data_type_ = types_map<DsonContainer>::value;
+	}
+
+	void set(Key key, std::unique_ptr<DsonObj> obj)
+	{
+		const auto index = static_cast<std::size_t>(key);
+		assert(index < slots_count);
+		if (!obj || index >= slots_count)
+			return;
+		obj->set_key(static_cast<DsonKey>(key));
+		slots_[index] = std::move(obj);
+	}
+
+	// Прервать выгрузку: дети начнут свою выгрузку сначала
+	void reset_output() noexcept
+	{
+		if (state_ == State::CopyingData && slot_index_ < slots_count && slots_[slot_index_])
+			slots_[slot_index_]->reset_state();
+		state_ = State::Ready;
+		offset_ = 0;
+		slot_index_ = 0;
+	}
+
+	// Заголовок выгрузки в нужном byte order
+	template <bool network_order>
+	void start()
+	{
+		Header header = header_;
+		header.data_size_ = data_size();
+		std::memcpy(out_header_, &header, header_size);
+		if constexpr (network_order)
+		{
+			header_network_host(std::launder(reinterpret_cast<std::uint32_t *>(out_header_)));
+		}
+		state_ = State::CopyingHeader;
+		offset_ = 0;
+		slot_index_ = 0;
+	}
+
+	template <bool network_order>
+	void copy_to_stream_local(std::ostream & out)
+	{
+		if (state_ != State::Ready)
+			return;
+		start<network_order>();
+		out.write(out_header_, header_size);
+		for (auto & slot : slots_)
+		{
+			if (!slot)
+				continue;
+			if constexpr (network_order)
+			{
+				slot->copy_to_stream_network_order(out);
+			}
+			else
+			{
+				slot->copy_to_stream_host_order(out);
+			}
+		}
+		state_ = State::Ready;
+	}
+
+	template <bool network_order>
+	Result copy_to_buf_local(char *& buf, std::int32_t & buf_size)
+	{
+		switch (state_)
+		{
+		case State::Ready:
+			start<network_order>();
+			[[fallthrough]];
+		case State::CopyingHeader:
+			{
+				const std::int32_t writed = std::min(buf_size, header_size - offset_);
+				std::memcpy(buf, out_header_ + offset_, writed);
+				offset_ += writed;
+				buf += writed;
+				buf_size -= writed;
+				if (offset_ < header_size)
+					return Result::InProcess;
+				state_ = State::CopyingData;
+			}
+			[[fallthrough]];
+		case State::CopyingData:
+			{
+				for (; slot_index_ < slots_count; ++slot_index_)
+				{
+					auto & slot = slots_[slot_index_];
+					if (!slot)
+						continue;
+					Result res;
+					if constexpr (network_order)
+					{
+						res = slot->copy_to_buf_network_order(buf, buf_size);
+					}
+					else
+					{
+						res = slot->copy_to_buf_host_order(buf, buf_size);
+					}
+					if (res != Result::Ready)
+						return res;
+				}
+				state_ = State::Ready;
+				return Result::Ready;
+			}
+		default:
+			break;
+		}
+		return Result::Error;
+	}
+
+	template <bool network_order>
+	Result copy_to_fd_local(std::int32_t fd)
+	{
+		if (state_ == State::Ready)
+		{
+			// Кодируем целиком: одна запись вместо записи на каждого ребёнка
+			encoded_.resize(static_cast<std::size_t>(header_size + data_size()));
+			char * buf = encoded_.data();
+			std::int32_t buf_size = static_cast<std::int32_t>(encoded_.size());
+			if (copy_to_buf_local<network_order>(buf, buf_size) != Result::Ready || buf_size)
+			{
+				reset_output();
+				return Result::Error;
+			}
+			encoded_offset_ = 0;
+			state_ = State::CopyingData;
+			slot_index_ = slots_count;
+		}
+		if (state_ != State::CopyingData)
+			return Result::Error;
+		while (encoded_offset_ < encoded_.size())
+		{
+			const auto writed = write_to_fd(fd, encoded_.data() + encoded_offset_, encoded_.size() - encoded_offset_);
+			if (writed < 0)
+			{
+				reset_output();
+				return Result::Error;
+			}
+			if (writed == 0)
+				return Result::InProcess;
+			encoded_offset_ += static_cast<std::size_t>(writed);
+		}
+		state_ = State::Ready;
+		return Result::Ready;
+	}
+
+private:
+	// Заголовок в host order (data_size_ считается при выгрузке)
+	Header header_;
+	// Заголовок текущей выгрузки в нужном byte order
+	alignas(Header) char out_header_[sizeof(Header)];
+	// Дети по индексу ключа
+	std::array<std::unique_ptr<DsonObj>, slots_count> slots_;
+	// Позиция выгрузки по слотам
+	std::size_t slot_index_{0};
+	// Закодированный контейнер для выгрузки в fd (память переиспользуется)
+	std::vector<char> encoded_;
+	std::size_t encoded_offset_{0};
+};
+
+} // namespace hi
+
+#endif // DSON_ENUM_H
@@ -0,0 +1,217 @@
+#ifndef DSON_FD_READER_H
+#define DSON_FD_READER_H
+
+#include <dson/dson.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+namespace hi
+{
+
+/**
+ * @brief The DsonFdReader class
+ * Чтение потока Dson сообщений из fd (сеть/pipe/..) через буфер упреждающего чтения.
+ *
+ * Dson::load_from_fd() делает отдельный read() на заголовок и на данные каждого сообщения.
+ * Читатель делает один большой read() в свой буфер, а затем выдаёт все целые сообщения,
+ * которые оказались в буфере, в виде вьюх (Dson(char *)) без копирования.
+ * Недочитанный хвост остаётся в буфере до следующего read().
+ *
+ * Используется так:
+ *  while (reader.read() != Result::Error)
+ *      while (reader.next(dson))
+ *          обработка dson;
+ *
+ * Потоко небезопасно. Один читатель на один fd.
+ * @note выданные вьюхи валидны до следующего вызова read(): read() сдвигает хвост в начало буфера
+ * и может переаллоцировать буфер. После read() (и после разрушения читателя) вьюху можно только
+ * переназначить (next()) или разрушить, а если сообщение нужно дольше - скопировать
+ * (например load_from_buf() в Dson с ареной).
+ */
+class DsonFdReader
+{
+public:
+	static constexpr std::int32_t default_capacity{64 * 1024};
+
+	explicit DsonFdReader(std::int32_t fd, std::int32_t capacity = default_capacity)
+		: fd_{fd}
+	{
+		if (capacity < DsonObj::header_size)
+			capacity = DsonObj::header_size;
+		buf_ = static_cast<char *>(std::malloc(static_cast<std::size_t>(capacity)));
+		if (buf_)
+			capacity_ = capacity;
+	}
+
+	DsonFdReader(const DsonFdReader &) = delete;
+	DsonFdReader & operator=(const DsonFdReader &) = delete;
+	DsonFdReader(DsonFdReader &&) = delete;
+	DsonFdReader & operator=(DsonFdReader &&) = delete;
+
+	~DsonFdReader()
+	{
+		std::free(buf_);
+	}
+
+	/**
+	 * @brief read
+	 * Один read() из fd на всё свободное место буфера
+	 * (если очередное сообщение не помещается в буфер - буфер увеличивается)
+	 * @return Result::Ready если в буфере есть хотя бы одно целое сообщение,
+	 * Result::InProcess если fd пока не дал целого сообщения,
+	 * Result::Error при ошибке чтения или повреждённом заголовке
+	 * @note делает невалидными выданные ранее вьюхи
+	 */
+	Result read()
+	{
+		if (error_)
+			return Result::Error;
+		const std::int32_t frame_size = next_frame_size();
+		if (frame_size < 0)
+			return fail();
+		if (frame_size > 0 && frame_size <= end_ - begin_)
+		{
+			// Целое сообщение уже в буфере: читать не нужно
+			return Result::Ready;
+		}
+		if (!prepare_space(frame_size))
+			return fail();
+
+		const auto readed = read_from_fd(fd_, buf_ + end_, capacity_ - end_);
+		if (readed < 0)
+			return fail();
+		end_ += static_cast<std::int32_t>(readed);
+
+		const std::int32_t size = next_frame_size();
+		if (size < 0)
+			return fail();
+		return (size > 0 && size <= end_ - begin_) ? Result::Ready : Result::InProcess;
+	}
+
+	/**
+	 * @brief next
+	 * Выдать следующее целое сообщение из буфера
+	 * @param dson сюда кладётся вьюха на буфер читателя (предыдущее содержимое очищается)
+	 * @return false если целых сообщений в буфере больше нет
+	 */
+	bool next(Dson & dson)
+	{
+		char * frame;
+		std::int32_t frame_size;
+		if (!next(frame, frame_size))
+			return false;
+		dson = Dson{frame};
+		return true;
+	}
+
+	/**
+	 * @brief next
+	 * Выдать следующее целое сообщение из буфера как сырой кадр (заголовок + данные),
+	 * например чтобы забрать его в Dson с ареной через load_from_buf()
+	 * @return false если целых сообщений в буфере больше нет
+	 */
+	bool next(char *& frame, std::int32_t & frame_size) noexcept
+	{
+		const std::int32_t size = next_frame_size();
+		if (size <= 0 || size > end_ - begin_)
+			return false;
+		frame = buf_ + begin_;
+		frame_size = size;
+		begin_ += size;
+		return true;
+	}
+
+	/**
+	 * @brief buffered
+	 * Сколько прочитанных байт ещё не выдано через next()
+	 */
+	std::int32_t buffered() const noexcept
+	{
+		return end_ - begin_;
+	}
+
+	std::int32_t capacity() const noexcept
+	{
+		return capacity_;
+	}
+
+	std::int32_t fd() const noexcept
+	{
+		return fd_;
+	}
+
+private:
+	/*
+	 * Размер (заголовок + данные) сообщения в начале невыданной части буфера:
+	 * 0 если заголовок ещё не дочитан, -1 если заголовок повреждён
+	 */
+	std::int32_t next_frame_size() const noexcept
+	{
+		if (end_ - begin_ < DsonObj::header_size)
+			return 0;
+		DsonObj::Header header;
+		std::memcpy(&header, buf_ + begin_, DsonObj::header_size);
+		std::int32_t data_size = header.data_size_;
+		if (header.mark_byte_order_ == mark_network_order)
+		{
+			data_size = int32_to_host(data_size);
+		}
+		else if (header.mark_byte_order_ != mark_host_order)
+		{
+			return -1;
+		}
+		if (data_size < 0 || data_size > MAX_DSON_RAM_SIZE)
+			return -1;
+		return data_size + DsonObj::header_size;
+	}
+
+	// Освободить в конце буфера место под сообщение frame_size (0 - размер пока неизвестен)
+	bool prepare_space(std::int32_t frame_size)
+	{
+		if (begin_ == end_)
+		{
+			begin_ = 0;
+			end_ = 0;
+		}
+		const std::int32_t need = frame_size > 0 ? frame_size : DsonObj::header_size;
+		if (capacity_ - begin_ >= need && end_ < capacity_)
+			return true;
+		// Хвост в начало буфера
+		const std::int32_t tail = end_ - begin_;
+		if (begin_)
+		{
+			std::memmove(buf_, buf_ + begin_, static_cast<std::size_t>(tail));
+			begin_ = 0;
+			end_ = tail;
+		}
+		if (capacity_ >= need && end_ < capacity_)
+			return true;
+		char * buf = static_cast<char *>(std::realloc(buf_, static_cast<std::size_t>(need)));
+		if (!buf)
+			return false;
+		buf_ = buf;
+		capacity_ = need;
+		return true;
+	}
+
+	Result fail() noexcept
+	{
+		error_ = true;
+		return Result::Error;
+	}
+
+private:
+	const std::int32_t fd_;
+	char * buf_{nullptr};
+	std::int32_t capacity_{0};
+	// Невыданная часть буфера [begin_, end_)
+	std::int32_t begin_{0};
+	std::int32_t end_{0};
+	bool error_{false};
+};
+
+} // namespace hi
+
+#endif // DSON_FD_READER_H
@@ -4,6 +4,7 @@
 #include <dson/dson.h>
 #include <dson/custom_dson_objs/dson_string_obj.h>
 
+#include <cstring>
 #include <string>
 #include <string_view>
 
@@ -15,21 +16,22 @@ namespace hi
 
 // TODO float, double, long double as ratio:
 // https://stackoverflow.com/questions/50962041/how-can-i-get-numerator-and-denominator-from-a-fractional-number
-inline std::uint32_t to_uint32(Dson * obj, const std::uint32_t def = 0)
+/**
+ * @brief host_data_to_uint32
+ * Преобразование данных скаляра (уже в host order)
+ * @param data_type - тип данных
+ * @param data - указатель на данные
+ * @param def - значение по умолчанию, если тип не подходит
+ */
+inline std::uint32_t host_data_to_uint32(const TypeMarker data_type, const void * data, const std::uint32_t def = 0)
 {
-	if (!obj)
-		return def;
-	if (!obj->is_host_order())
-	{
-		Dson::converters().to_host(*obj);
-	}
-	switch (obj->data_type())
+	switch (data_type)
 	{
 	case types_map<std::uint32_t>::value:
-		return *(static_cast<std::uint32_t *>(obj->data()));
+		return *(static_cast<const std::uint32_t *>(data));
 	case types_map<std::int32_t>::value:
 		{
-			const std::int32_t re = *(static_cast<std::int32_t *>(obj->data()));
+			const std::int32_t re = *(static_cast<const std::int32_t *>(data));
 			if (0 <= re)
 			{
 				return static_cast<std::uint32_t>(re);
@@ -38,7 +40,7 @@ inline std::uint32_t to_uint32(Dson * obj, const std::uint32_t def = 0)
 		}
 	case types_map<std::uint64_t>::value:
 		{
-			const std::uint64_t re = *(static_cast<std::uint64_t *>(obj->data()));
+			const std::uint64_t re = *(static_cast<const std::uint64_t *>(data));
 			if (re <= std::numeric_limits<std::uint32_t>::max())
 			{
 				return static_cast<std::uint32_t>(re);
@@ -47,7 +49,7 @@ inline std::uint32_t to_uint32(Dson * obj, const std::uint32_t def = 0)
 		}
 	case types_map<std::int64_t>::value:
 		{
-			const std::int64_t re = *(static_cast<std::int64_t *>(obj->data()));
+			const std::int64_t re = *(static_cast<const std::int64_t *>(data));
 			if (0 <= re && re <= std::numeric_limits<std::uint32_t>::max())
 			{
 				return static_cast<std::uint32_t>(re);
@@ -56,7 +58,7 @@ inline std::uint32_t to_uint32(Dson * obj, const std::uint32_t def = 0)
 		}
 	case types_map<double>::value:
 		{
-			const double re = *(static_cast<double *>(obj->data()));
+			const double re = *(static_cast<const double *>(data));
 			if (0 <= re && re <= std::numeric_limits<std::uint32_t>::max())
 			{
 				return static_cast<std::uint32_t>(re);
@@ -69,32 +71,37 @@ inline std::uint32_t to_uint32(Dson * obj, const std::uint32_t def = 0)
 	return def;
 }
 
-std::uint32_t to_uint32(DsonObj * obj, const std::uint32_t def = 0)
+inline std::uint32_t to_uint32(Dson * obj, const std::uint32_t def = 0)
 {
 	if (!obj)
 		return def;
-	if (auto dson = dynamic_cast<Dson *>(obj))
+	if (!obj->is_host_order())
 	{
-		return to_uint32(dson, def);
+		Dson::converters().to_host(*obj);
 	}
-	return def;
+	return host_data_to_uint32(obj->data_type(), obj->data(), def);
 }
 
-inline std::int32_t to_int32(Dson * obj, const std::int32_t def = 0)
+inline std::uint32_t to_uint32(DsonObj * obj, const std::uint32_t def = 0)
 {
 	if (!obj)
 		return def;
-	if (!obj->is_host_order())
+	if (auto dson = dson_cast<Dson>(obj))
 	{
-		Dson::converters().to_host(*obj);
+		return to_uint32(dson, def);
 	}
-	switch (obj->data_type())
+	return def;
+}
+
+inline std::int32_t host_data_to_int32(const TypeMarker data_type, const void * data, const std::int32_t def = 0)
+{
+	switch (data_type)
 	{
 	case types_map<std::int32_t>::value:
-		return *(static_cast<std::int32_t *>(obj->data()));
+		return *(static_cast<const std::int32_t *>(data));
 	case types_map<std::uint32_t>::value:
 		{
-			const std::uint32_t re = *(static_cast<std::uint32_t *>(obj->data()));
+			const std::uint32_t re = *(static_cast<const std::uint32_t *>(data));
 			if (re <= std::numeric_limits<std::int32_t>::max())
 			{
 				return static_cast<std::int32_t>(re);
@@ -103,7 +110,7 @@ inline std::int32_t to_int32(Dson * obj, const std::int32_t def = 0)
 		}
 	case types_map<std::uint64_t>::value:
 		{
-			const std::uint64_t re = *(static_cast<std::uint64_t *>(obj->data()));
+			const std::uint64_t re = *(static_cast<const std::uint64_t *>(data));
 			if (re <= std::numeric_limits<std::int32_t>::max())
 			{
 				return static_cast<std::int32_t>(re);
@@ -112,7 +119,7 @@ inline std::int32_t to_int32(Dson * obj, const std::int32_t def = 0)
 		}
 	case types_map<std::int64_t>::value:
 		{
-			const std::int64_t re = *(static_cast<std::int64_t *>(obj->data()));
+			const std::int64_t re = *(static_cast<const std::int64_t *>(data));
 			if (std::numeric_limits<std::int32_t>::lowest() <= re && re <= std::numeric_limits<std::int32_t>::max())
 			{
 				return static_cast<std::int32_t>(re);
@@ -121,7 +128,7 @@ inline std::int32_t to_int32(Dson * obj, const std::int32_t def = 0)
 		}
 	case types_map<double>::value:
 		{
-			const double re = *(static_cast<double *>(obj->data()));
+			const double re = *(static_cast<const double *>(data));
 			if (std::numeric_limits<std::int32_t>::lowest() <= re && re <= std::numeric_limits<std::int32_t>::max())
 			{
 				return static_cast<std::int32_t>(re);
@@ -134,32 +141,37 @@ inline std::int32_t to_int32(Dson * obj, const std::int32_t def = 0)
 	return def;
 }
 
-inline std::int32_t to_int32(DsonObj * obj, const std::int32_t def = 0)
+inline std::int32_t to_int32(Dson * obj, const std::int32_t def = 0)
 {
 	if (!obj)
 		return def;
-	if (auto dson = dynamic_cast<Dson *>(obj))
+	if (!obj->is_host_order())
 	{
-		return to_int32(dson, def);
+		Dson::converters().to_host(*obj);
 	}
-	return def;
+	return host_data_to_int32(obj->data_type(), obj->data(), def);
 }
 
-inline std::uint64_t to_uint64(Dson * obj, const std::uint64_t def = 0)
+inline std::int32_t to_int32(DsonObj * obj, const std::int32_t def = 0)
 {
 	if (!obj)
 		return def;
-	if (!obj->is_host_order())
+	if (auto dson = dson_cast<Dson>(obj))
 	{
-		Dson::converters().to_host(*obj);
+		return to_int32(dson, def);
 	}
-	switch (obj->data_type())
+	return def;
+}
+
+inline std::uint64_t host_data_to_uint64(const TypeMarker data_type, const void * data, const std::uint64_t def = 0)
+{
+	switch (data_type)
 	{
 	case types_map<std::uint32_t>::value:
-		return *(static_cast<std::uint32_t *>(obj->data()));
+		return *(static_cast<const std::uint32_t *>(data));
 	case types_map<std::int32_t>::value:
 		{
-			const std::int32_t re = *(static_cast<std::int32_t *>(obj->data()));
+			const std::int32_t re = *(static_cast<const std::int32_t *>(data));
 			if (0 <= re)
 			{
 				return static_cast<std::uint64_t>(re);
@@ -167,10 +179,10 @@ inline std::uint64_t to_uint64(Dson * obj, const std::uint64_t def = 0)
 			return def;
 		}
 	case types_map<std::uint64_t>::value:
-		return *(static_cast<std::uint64_t *>(obj->data()));
+		return *(static_cast<const std::uint64_t *>(data));
 	case types_map<std::int64_t>::value:
 		{
-			const std::int64_t re = *(static_cast<std::int64_t *>(obj->data()));
+			const std::int64_t re = *(static_cast<const std::int64_t *>(data));
 			if (0 <= re && re <= std::numeric_limits<std::uint64_t>::max())
 			{
 				return static_cast<std::uint64_t>(re);
@@ -179,7 +191,7 @@ inline std::uint64_t to_uint64(Dson * obj, const std::uint64_t def = 0)
 		}
 	case types_map<double>::value:
 		{
-			const double re = *(static_cast<double *>(obj->data()));
+			const double re = *(static_cast<const double *>(data));
 			if (0 <= re && re <= std::numeric_limits<std::uint64_t>::max())
 			{
 				return static_cast<std::uint64_t>(re);
@@ -192,34 +204,39 @@ inline std::uint64_t to_uint64(Dson * obj, const std::uint64_t def = 0)
 	return def;
 }
 
-inline std::uint64_t to_uint64(DsonObj * obj, const std::uint64_t def = 0)
+inline std::uint64_t to_uint64(Dson * obj, const std::uint64_t def = 0)
 {
 	if (!obj)
 		return def;
-	if (auto dson = dynamic_cast<Dson *>(obj))
+	if (!obj->is_host_order())
 	{
-		return to_uint64(dson, def);
+		Dson::converters().to_host(*obj);
 	}
-	return def;
+	return host_data_to_uint64(obj->data_type(), obj->data(), def);
 }
 
-inline std::int64_t to_int64(Dson * obj, const std::int64_t def = 0)
+inline std::uint64_t to_uint64(DsonObj * obj, const std::uint64_t def = 0)
 {
 	if (!obj)
 		return def;
-	if (!obj->is_host_order())
+	if (auto dson = dson_cast<Dson>(obj))
 	{
-		Dson::converters().to_host(*obj);
+		return to_uint64(dson, def);
 	}
-	switch (obj->data_type())
+	return def;
+}
+
+inline std::int64_t host_data_to_int64(const TypeMarker data_type, const void * data, const std::int64_t def = 0)
+{
+	switch (data_type)
 	{
 	case types_map<std::int32_t>::value:
-		return *(static_cast<std::int32_t *>(obj->data()));
+		return *(static_cast<const std::int32_t *>(data));
 	case types_map<std::uint32_t>::value:
-		return static_cast<std::int64_t>(*(static_cast<std::uint32_t *>(obj->data())));
+		return static_cast<std::int64_t>(*(static_cast<const std::uint32_t *>(data)));
 	case types_map<std::uint64_t>::value:
 		{
-			const std::uint64_t re = *(static_cast<std::uint64_t *>(obj->data()));
+			const std::uint64_t re = *(static_cast<const std::uint64_t *>(data));
 			if (re <= std::numeric_limits<std::int64_t>::max())
 			{
 				return static_cast<std::int64_t>(re);
@@ -227,10 +244,10 @@ inline std::int64_t to_int64(Dson * obj, const std::int64_t def = 0)
 			return def;
 		}
 	case types_map<std::int64_t>::value:
-		return *(static_cast<std::int64_t *>(obj->data()));
+		return *(static_cast<const std::int64_t *>(data));
 	case types_map<double>::value:
 		{
-			const double re = *(static_cast<double *>(obj->data()));
+			const double re = *(static_cast<const double *>(data));
 			if (std::numeric_limits<std::int64_t>::lowest() <= re && re <= std::numeric_limits<std::int32_t>::max())
 			{
 				return static_cast<std::int64_t>(re);
@@ -243,48 +260,64 @@ inline std::int64_t to_int64(Dson * obj, const std::int64_t def = 0)
 	return def;
 }
 
-inline std::int64_t to_int64(DsonObj * obj, const std::int64_t def = 0)
+inline std::int64_t to_int64(Dson * obj, const std::int64_t def = 0)
 {
 	if (!obj)
 		return def;
-	if (auto dson = dynamic_cast<Dson *>(obj))
+	if (!obj->is_host_order())
 	{
-		return to_int64(dson, def);
+		Dson::converters().to_host(*obj);
 	}
-	return def;
+	return host_data_to_int64(obj->data_type(), obj->data(), def);
 }
 
-inline double to_double(Dson * obj, const double def = 0.0)
+inline std::int64_t to_int64(DsonObj * obj, const std::int64_t def = 0)
 {
 	if (!obj)
 		return def;
-	if (!obj->is_host_order())
+	if (auto dson = dson_cast<Dson>(obj))
 	{
-		Dson::converters().to_host(*obj);
+		return to_int64(dson, def);
 	}
-	switch (obj->data_type())
+	return def;
+}
+
+inline double host_data_to_double(const TypeMarker data_type, const void * data, const double def = 0.0)
+{
+	switch (data_type)
 	{
 	case types_map<std::int32_t>::value:
-		return *(static_cast<std::int32_t *>(obj->data()));
+		return *(static_cast<const std::int32_t *>(data));
 	case types_map<std::uint32_t>::value:
-		return *(static_cast<std::uint32_t *>(obj->data()));
+		return *(static_cast<const std::uint32_t *>(data));
 	case types_map<std::uint64_t>::value:
-		return *(static_cast<std::uint64_t *>(obj->data()));
+		return *(static_cast<const std::uint64_t *>(data));
 	case types_map<std::int64_t>::value:
-		return *(static_cast<std::int64_t *>(obj->data()));
+		return *(static_cast<const std::int64_t *>(data));
 	case types_map<double>::value:
-		return *(static_cast<double *>(obj->data()));
+		return *(static_cast<const double *>(data));
 	default:
 		break;
 	}
 	return def;
 }
 
+inline double to_double(Dson * obj, const double def = 0.0)
+{
+	if (!obj)
+		return def;
+	if (!obj->is_host_order())
+	{
+		Dson::converters().to_host(*obj);
+	}
+	return host_data_to_double(obj->data_type(), obj->data(), def);
+}
+
 inline double to_double(DsonObj * obj, const double def = 0.0)
 {
 	if (!obj)
 		return def;
-	if (auto dson = dynamic_cast<Dson *>(obj))
+	if (auto dson = dson_cast<Dson>(obj))
 	{
 		return to_double(dson, def);
 	}
@@ -304,17 +337,146 @@ inline std::string_view to_string_view(DsonObj * obj)
 {
 	if (!obj)
 		return {};
-	if (auto dson = dynamic_cast<Dson *>(obj))
+	if (auto dson = dson_cast<Dson>(obj))
 	{
 		return to_string_view(dson);
 	}
-	if (auto dson = dynamic_cast<DsonStringObj *>(obj))
+	if (auto dson = dson_cast<DsonStringObj>(obj))
 	{
 		return dson->object();
 	}
 	return {};
 }
 
+/**
+ * @brief raw_field_to_host
+ * Копия данных скаляра в host order, исходный буфер не меняется
+ * @param field - поле из Dson::raw_field()
+ * @param tmp - куда копировать
+ * @return указатель на данные в host order или nullptr если это не скаляр
+ */
+inline const void * raw_field_to_host(const Dson::RawField & field, char * tmp)
+{
+	switch (field.data_type)
+	{
+	case types_map<std::uint32_t>::value:
+	case types_map<std::int32_t>::value:
+		{
+			if (field.data_size != static_cast<std::int32_t>(sizeof(std::uint32_t)))
+				return nullptr;
+			std::uint32_t var;
+			std::memcpy(&var, field.data, sizeof(var));
+			if (!field.host_order)
+			{
+				var = ntohl(var);
+			}
+			std::memcpy(tmp, &var, sizeof(var));
+			return tmp;
+		}
+	case types_map<std::uint64_t>::value:
+	case types_map<std::int64_t>::value:
+		{
+			if (field.data_size != static_cast<std::int32_t>(sizeof(std::uint64_t)))
+				return nullptr;
+			std::uint64_t var;
+			std::memcpy(&var, field.data, sizeof(var));
+			if (!field.host_order)
+			{
+				var = ntohll(var);
+			}
+			std::memcpy(tmp, &var, sizeof(var));
+			return tmp;
+		}
+	case types_map<double>::value:
+		{
+			if (field.data_size != buf_size_for_double)
+				return nullptr;
+			std::memcpy(tmp, field.data, buf_size_for_double);
+			if (!field.host_order)
+			{
+				double_in_buf_to_host_order(tmp);
+			}
+			return tmp;
+		}
+	default:
+		break;
+	}
+	return nullptr;
+}
+
+/*
+  Чтение скаляров по ключу прямо из буфера загруженного Dson:
+  дочерний Dson не создаётся и буфер не конвертируется в host order.
+  Пример: const auto id = hi::to_uint32(dson, Keys::Id);
+*/
+template <typename K>
+inline std::uint32_t to_uint32(Dson & dson, K key, const std::uint32_t def = 0)
+{
+	const Dson::RawField field = dson.raw_field(key);
+	alignas(std::uint64_t) char tmp[buf_size_for_double];
+	const void * data = raw_field_to_host(field, tmp);
+	if (!data)
+		return def;
+	return host_data_to_uint32(field.data_type, data, def);
+}
+
+template <typename K>
+inline std::int32_t to_int32(Dson & dson, K key, const std::int32_t def = 0)
+{
+	const Dson::RawField field = dson.raw_field(key);
+	alignas(std::uint64_t) char tmp[buf_size_for_double];
+	const void * data = raw_field_to_host(field, tmp);
+	if (!data)
+		return def;
+	return host_data_to_int32(field.data_type, data, def);
+}
+
+template <typename K>
+inline std::uint64_t to_uint64(Dson & dson, K key, const std::uint64_t def = 0)
+{
+	const Dson::RawField field = dson.raw_field(key);
+	alignas(std::uint64_t) char tmp[buf_size_for_double];
+	const void * data = raw_field_to_host(field, tmp);
+	if (!data)
+		return def;
+	return host_data_to_uint64(field.data_type, data, def);
+}
+
+template <typename K>
+inline std::int64_t to_int64(Dson & dson, K key, const std::int64_t def = 0)
+{
+	const Dson::RawField field = dson.raw_field(key);
+	alignas(std::uint64_t) char tmp[buf_size_for_double];
+	const void * data = raw_field_to_host(field, tmp);
+	if (!data)
+		return def;
+	return host_data_to_int64(field.data_type, data, def);
+}
+
+template <typename K>
+inline double to_double(Dson & dson, K key, const double def = 0.0)
+{
+	const Dson::RawField field = dson.raw_field(key);
+	alignas(std::uint64_t) char tmp[buf_size_for_double];
+	const void * data = raw_field_to_host(field, tmp);
+	if (!data)
+		return def;
+	return host_data_to_double(field.data_type, data, def);
+}
+
+template <typename K>
+inline std::string_view to_string_view(Dson & dson, K key)
+{
+	const Dson::RawField field = dson.raw_field(key);
+	if (!field.data)
+	{
+		// Не Dson (например DsonStringObj)
+		return to_string_view(dson.get(key));
+	}
+	if (field.data_type != types_map<std::string>::value)
+		return {};
+	return std::string_view{field.data, static_cast<std::uint32_t>(field.data_size)};
+}
 /**
  * @brief to_string
  * Преобразование объектов в строку (чисел и др.).
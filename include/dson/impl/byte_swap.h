@@ -0,0 +1,227 @@
+#ifndef DSON_BYTE_SWAP_H
+#define DSON_BYTE_SWAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#	define DSON_X86_SIMD 1
+#	if defined(_MSC_VER)
+#		include <intrin.h>
+#	endif
+#	include <immintrin.h>
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#	define DSON_TARGET(arch) __attribute__((target(arch)))
+#else
+#	define DSON_TARGET(arch)
+#endif
+
+#if __BIG_ENDIAN__ || (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+#	define DSON_BIG_ENDIAN 1
+#endif
+
+/*
+  Перестановка байт массивов 32-битных слов (host <-> network byte order).
+  Ядра: scalar, SSE2, SSSE3, AVX2. Лучшее доступное ядро выбирается один раз
+  при первом вызове по возможностям процессора.
+  Данные могут быть не выровнены.
+*/
+namespace hi
+{
+
+using ByteSwap32Fn = void (*)(std::uint32_t * data, std::size_t count);
+
+inline std::uint32_t byte_swap32(std::uint32_t x) noexcept
+{
+#if defined(__GNUC__) || defined(__clang__)
+	return __builtin_bswap32(x);
+#elif defined(_MSC_VER)
+	return _byteswap_ulong(x);
+#else
+	return ((x & 0x000000FFu) << 24) | ((x & 0x0000FF00u) << 8) | ((x & 0x00FF0000u) >> 8)
+		| ((x & 0xFF000000u) >> 24);
+#endif
+}
+
+inline void byte_swap32_scalar(std::uint32_t * data, std::size_t count) noexcept
+{
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		std::uint32_t var;
+		std::memcpy(&var, data + i, sizeof(var));
+		var = byte_swap32(var);
+		std::memcpy(data + i, &var, sizeof(var));
+	}
+}
+
+#ifdef DSON_X86_SIMD
+
+// SSE2 без pshufb: обмен байт в 16-битных словах сдвигами, затем обмен 16-битных слов
+DSON_TARGET("sse2") inline __m128i byte_swap32_sse2_reg(__m128i x) noexcept
+{
+	x = _mm_or_si128(_mm_slli_epi16(x, 8), _mm_srli_epi16(x, 8));
+	x = _mm_shufflelo_epi16(x, _MM_SHUFFLE(2, 3, 0, 1));
+	return _mm_shufflehi_epi16(x, _MM_SHUFFLE(2, 3, 0, 1));
+}
+
+DSON_TARGET("sse2") inline void byte_swap32_sse2(std::uint32_t * data, std::size_t count) noexcept
+{
+	std::size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128i * ptr = reinterpret_cast<__m128i *>(data + i);
+		_mm_storeu_si128(ptr, byte_swap32_sse2_reg(_mm_loadu_si128(ptr)));
+	}
+	byte_swap32_scalar(data + i, count - i);
+}
+
+DSON_TARGET("ssse3") inline void byte_swap32_ssse3(std::uint32_t * data, std::size_t count) noexcept
+{
+	const __m128i mask = _mm_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+	std::size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		__m128i * ptr = reinterpret_cast<__m128i *>(data + i);
+		const __m128i a = _mm_loadu_si128(ptr);
+		const __m128i b = _mm_loadu_si128(ptr + 1);
+		_mm_storeu_si128(ptr, _mm_shuffle_epi8(a, mask));
+		_mm_storeu_si128(ptr + 1, _mm_shuffle_epi8(b, mask));
+	}
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128i * ptr = reinterpret_cast<__m128i *>(data + i);
+		_mm_storeu_si128(ptr, _mm_shuffle_epi8(_mm_loadu_si128(ptr), mask));
+	}
+	byte_swap32_scalar(data + i, count - i);
+}
+
+DSON_TARGET("avx2") inline void byte_swap32_avx2(std::uint32_t * data, std::size_t count) noexcept
+{
+	const __m256i mask = _mm256_set_epi8(
+		12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3,
+		12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+	std::size_t i = 0;
+	for (; i + 16 <= count; i += 16)
+	{
+		__m256i * ptr = reinterpret_cast<__m256i *>(data + i);
+		const __m256i a = _mm256_loadu_si256(ptr);
+		const __m256i b = _mm256_loadu_si256(ptr + 1);
+		_mm256_storeu_si256(ptr, _mm256_shuffle_epi8(a, mask));
+		_mm256_storeu_si256(ptr + 1, _mm256_shuffle_epi8(b, mask));
+	}
+	for (; i + 8 <= count; i += 8)
+	{
+		__m256i * ptr = reinterpret_cast<__m256i *>(data + i);
+		_mm256_storeu_si256(ptr, _mm256_shuffle_epi8(_mm256_loadu_si256(ptr), mask));
+	}
+	byte_swap32_scalar(data + i, count - i);
+}
+
+struct CpuFeatures
+{
+	bool sse2_{false};
+	bool ssse3_{false};
+	bool avx2_{false};
+
+	static CpuFeatures detect() noexcept
+	{
+		CpuFeatures re;
+#	if defined(_MSC_VER) && !defined(__clang__)
+		int info[4];
+		__cpuid(info, 0);
+		const int max_leaf = info[0];
+		__cpuid(info, 1);
+		re.sse2_ = (info[3] & (1 << 26)) != 0;
+		re.ssse3_ = (info[2] & (1 << 9)) != 0;
+		// AVX2 требует ещё и поддержки сохранения ymm регистров со стороны ОС
+		const bool osxsave = (info[2] & (1 << 27)) != 0;
+		if (max_leaf >= 7 && osxsave && (_xgetbv(0) & 0x6) == 0x6)
+		{
+			__cpuidex(info, 7, 0);
+			re.avx2_ = (info[1] & (1 << 5)) != 0;
+		}
+#	else
+		__builtin_cpu_init();
+		re.sse2_ = __builtin_cpu_supports("sse2");
+		re.ssse3_ = __builtin_cpu_supports("ssse3");
+		re.avx2_ = __builtin_cpu_supports("avx2");
+#	endif
+		return re;
+	}
+};
+
+#endif // DSON_X86_SIMD
+
+/**
+ * @brief select_byte_swap32
+ * Выбор лучшего ядра перестановки байт для текущего процессора
+ */
+inline ByteSwap32Fn select_byte_swap32() noexcept
+{
+#ifdef DSON_X86_SIMD
+	const CpuFeatures cpu = CpuFeatures::detect();
+	if (cpu.avx2_)
+		return &byte_swap32_avx2;
+	if (cpu.ssse3_)
+		return &byte_swap32_ssse3;
+	if (cpu.sse2_)
+		return &byte_swap32_sse2;
+#endif
+	return &byte_swap32_scalar;
+}
+
+/**
+ * @brief byte_swap32_array
+ * Перестановка байт в каждом 32-битном слове массива
+ * @param data массив (выравнивание не требуется)
+ * @param count количество слов
+ */
+inline void byte_swap32_array(std::uint32_t * data, std::size_t count) noexcept
+{
+	if (count < 4)
+	{
+		byte_swap32_scalar(data, count);
+		return;
+	}
+	static const ByteSwap32Fn kernel = select_byte_swap32();
+	kernel(data, count);
+}
+
+/**
+ * @brief array32_network_host
+ * Преобразование массива 32-битных слов host <-> network byte order
+ * (операция симметрична, для big endian ничего не делает)
+ */
+inline void array32_network_host(std::uint32_t * data, std::size_t count) noexcept
+{
+#ifdef DSON_BIG_ENDIAN
+	(void)data;
+	(void)count;
+#else
+	byte_swap32_array(data, count);
+#endif
+}
+
+/**
+ * @brief header_network_host
+ * Преобразование 16 байт заголовка (4 слова) host <-> network byte order.
+ * На x86 одной SSE2 операцией (SSE2 есть на любом x86-64, диспетчеризация не нужна).
+ */
+inline void header_network_host(std::uint32_t * header) noexcept
+{
+#if defined(DSON_BIG_ENDIAN)
+	(void)header;
+#elif defined(DSON_X86_SIMD) && (defined(__SSE2__) || defined(_M_X64))
+	__m128i * ptr = reinterpret_cast<__m128i *>(header);
+	_mm_storeu_si128(ptr, byte_swap32_sse2_reg(_mm_loadu_si128(ptr)));
+#else
+	byte_swap32_scalar(header, 4);
+#endif
+}
+
+} // namespace hi
+
+#endif // DSON_BYTE_SWAP_H
@@ -0,0 +1,192 @@
+#ifndef DSON_ARENA_H
+#define DSON_ARENA_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+namespace hi
+{
+
+/**
+ * @brief The DsonArena class
+ * Монотонный аллокатор для буферов и дочерних узлов Dson.
+ * Память выдаётся последовательно из крупных блоков, поштучно не освобождается,
+ * а сбрасывается целиком через reset() за O(1).
+ *
+ * Используется так: на одно соединение создаётся одна арена,
+ * принимаемые Dson берут из неё буфер данных и узлы детей при разборе,
+ * после обработки сообщения clear() возвращает всю память арене.
+ *
+ * Потоко небезопасно (как и Dson), кроме borrow()/release():
+ * смуванные из арены сообщения могут освобождаться в других потоках.
+ * @note если за цикл понадобилось несколько блоков, то reset() заменит их одним блоком
+ * суммарного размера - со следующего сообщения память выдаётся из одного блока
+ */
+class DsonArena
+{
+public:
+	static constexpr std::size_t default_block_size{16 * 1024};
+
+	explicit DsonArena(std::size_t block_size = default_block_size)
+		: block_size_{block_size}
+	{
+	}
+
+	DsonArena(const DsonArena &) = delete;
+	DsonArena & operator=(const DsonArena &) = delete;
+	DsonArena(DsonArena &&) = delete;
+	DsonArena & operator=(DsonArena &&) = delete;
+
+	~DsonArena()
+	{
+		free_blocks();
+	}
+
+	/**
+	 * @brief allocate
+	 * Выделение памяти из арены
+	 * @param size размер
+	 * @param align выравнивание (степень двойки)
+	 * @return указатель на память или nullptr если не удалось аллоцировать блок
+	 */
+	void * allocate(std::size_t size, std::size_t align = alignof(std::max_align_t)) noexcept
+	{
+		if (!size)
+			size = 1;
+		if (blocks_)
+		{
+			if (void * re = allocate_from(blocks_, size, align))
+				return re;
+		}
+		if (!add_block(size + align))
+			return nullptr;
+		return allocate_from(blocks_, size, align);
+	}
+
+	/**
+	 * @brief reset
+	 * Вернуть всю выданную память арене.
+	 * Всё что было выделено из арены становится невалидным.
+	 */
+	void reset() noexcept
+	{
+		if (blocks_ && blocks_->next_)
+		{
+			// Арена выросла: объединяем блоки в один, чтобы дальше работать без роста
+			std::size_t capacity{0};
+			for (Block * block = blocks_; block; block = block->next_)
+			{
+				capacity += block->capacity_;
+			}
+			free_blocks();
+			add_block(capacity);
+			return;
+		}
+		if (blocks_)
+		{
+			blocks_->used_ = 0;
+		}
+	}
+
+	/**
+	 * @brief borrow
+	 * Память арены используется деревом, которое ушло от владельца арены
+	 * (например сообщение смувано в очередь отправки).
+	 * Пока есть такие деревья владелец не сбрасывает арену.
+	 */
+	void borrow() noexcept
+	{
+		borrowers_.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	void release() noexcept
+	{
+		borrowers_.fetch_sub(1, std::memory_order_release);
+	}
+
+	bool is_borrowed() const noexcept
+	{
+		return borrowers_.load(std::memory_order_acquire) != 0;
+	}
+
+	// Сколько памяти было выдано из текущего блока и всех предыдущих
+	std::size_t used() const noexcept
+	{
+		std::size_t re{0};
+		for (Block * block = blocks_; block; block = block->next_)
+		{
+			re += block->used_;
+		}
+		return re;
+	}
+
+	// Суммарный размер всех блоков арены
+	std::size_t capacity() const noexcept
+	{
+		std::size_t re{0};
+		for (Block * block = blocks_; block; block = block->next_)
+		{
+			re += block->capacity_;
+		}
+		return re;
+	}
+
+private:
+	struct alignas(std::max_align_t) Block
+	{
+		Block * next_;
+		std::size_t capacity_;
+		std::size_t used_;
+
+		char * data() noexcept
+		{
+			return reinterpret_cast<char *>(this + 1);
+		}
+	};
+
+	static void * allocate_from(Block * block, std::size_t size, std::size_t align) noexcept
+	{
+		const auto base = reinterpret_cast<std::uintptr_t>(block->data());
+		const auto begin = (base + block->used_ + align - 1) & ~(static_cast<std::uintptr_t>(align) - 1);
+		const std::size_t used = static_cast<std::size_t>(begin - base) + size;
+		if (used > block->capacity_)
+			return nullptr;
+		block->used_ = used;
+		return reinterpret_cast<void *>(begin);
+	}
+
+	bool add_block(std::size_t min_capacity) noexcept
+	{
+		const std::size_t capacity = min_capacity > block_size_ ? min_capacity : block_size_;
+		void * mem = std::malloc(sizeof(Block) + capacity);
+		if (!mem)
+			return false;
+		Block * block = new (mem) Block{blocks_, capacity, 0};
+		blocks_ = block;
+		return true;
+	}
+
+	void free_blocks() noexcept
+	{
+		while (blocks_)
+		{
+			Block * next = blocks_->next_;
+			std::free(blocks_);
+			blocks_ = next;
+		}
+	}
+
+private:
+	const std::size_t block_size_;
+	// Текущий блок, из которого идёт выдача памяти, за ним более старые
+	Block * blocks_{nullptr};
+	// Сколько смуванных деревьев ещё используют память арены
+	std::atomic<std::int32_t> borrowers_{0};
+};
+
+} // namespace hi
+
+#endif // DSON_ARENA_H
@@ -9,6 +9,8 @@
 #include <cstdint>
 #include <cstring>
 #include <fstream>
+#include <istream>
+#include <ostream>
 #include <iterator>
 #include <vector>
 
@@ -33,8 +35,26 @@ using DsonKey = std::int32_t;
 struct DsonObj
 {
 public:
+	/**
+	 * Вид объекта библиотеки: проверка вида - одно сравнение вместо dynamic_cast (см. dson_cast()).
+	 * Пользовательские объекты - Kind::Custom
+	 */
+	enum class Kind : std::uint8_t
+	{
+		Custom,
+		Dson,
+		RouteObj,
+		StringObj
+	};
+
+	DsonObj() = default;
 	virtual ~DsonObj() = default;
 
+	Kind kind() const noexcept
+	{
+		return kind_;
+	}
+
 	/**
 	 * @brief is_host_order
 	 * Находятся ли заголовок и данные в host byte order
@@ -56,6 +76,17 @@ public:
 	 */
 	virtual bool is_network_order() const noexcept = 0;
 	virtual std::int32_t data_size() const noexcept = 0;
+	/**
+	 * @brief is_data_size_fixed
+	 * Может ли data_size() измениться без ведома контейнера.
+	 * Контейнер кэширует свой размер только если у всех детей размер зафиксирован,
+	 * иначе пересчитывает его при каждом запросе.
+	 * @return true если размер не меняется после создания объекта
+	 */
+	virtual bool is_data_size_fixed() const noexcept
+	{
+		return false;
+	}
 	virtual DsonKey key() const noexcept = 0;
 	virtual void set_key(DsonKey _key) noexcept = 0;
 	//    template<typename K>
@@ -65,8 +96,33 @@ public:
 	//    }
 	virtual TypeMarker data_type() const noexcept = 0;
 
-	virtual void copy_to_stream_host_order(std::ofstream & out) = 0;
-	virtual void copy_to_stream_network_order(std::ofstream & out) = 0;
+	/**
+	 * @brief copy_to_stream_host_order
+	 * Выгрузка в любой std::ostream.
+	 * По умолчанию через промежуточный буфер (copy_to_buf_host_order()),
+	 * объекты библиотеки пишут в поток напрямую
+	 */
+	virtual void copy_to_stream_host_order(std::ostream & out)
+	{
+		copy_to_stream_via_buf<false>(out);
+	}
+	virtual void copy_to_stream_network_order(std::ostream & out)
+	{
+		copy_to_stream_via_buf<true>(out);
+	}
+	/*
+	 * Прежняя сигнатура: пользовательские типы с override для std::ofstream собираются без изменений
+	 * и вызываются при выгрузке прямо в std::ofstream (в том числе operator<<).
+	 * По умолчанию - выгрузка в std::ostream
+	 */
+	virtual void copy_to_stream_host_order(std::ofstream & out)
+	{
+		copy_to_stream_host_order(static_cast<std::ostream &>(out));
+	}
+	virtual void copy_to_stream_network_order(std::ofstream & out)
+	{
+		copy_to_stream_network_order(static_cast<std::ostream &>(out));
+	}
 	virtual Result copy_to_fd_host_order(std::int32_t fd) = 0;
 	virtual Result copy_to_fd_network_order(std::int32_t fd) = 0;
 	virtual Result copy_to_buf_host_order(char *& buf, std::int32_t & buf_size) = 0;
@@ -143,8 +199,53 @@ public:
 	State state_{State::Ready};
 	// Итератор загрузки/выгрузки
 	std::int32_t offset_{0};
+
+protected:
+	explicit DsonObj(const Kind kind) noexcept
+		: kind_{kind}
+	{
+	}
+
+	template <bool network_order>
+	void copy_to_stream_via_buf(std::ostream & out)
+	{
+		std::vector<char> buf(static_cast<std::size_t>(data_size() + header_size));
+		char * ptr = buf.data();
+		std::int32_t size = static_cast<std::int32_t>(buf.size());
+		const Result result = network_order ? copy_to_buf_network_order(ptr, size) : copy_to_buf_host_order(ptr, size);
+		if (result != Result::Ready)
+		{
+			reset_state();
+			out.setstate(std::ios_base::failbit);
+			return;
+		}
+		out.write(buf.data(), static_cast<std::streamsize>(buf.size()));
+	}
+
+	Kind kind_{Kind::Custom};
 };
 
+/**
+ * @brief dson_cast
+ * Приведение к объекту библиотеки по его виду (см. DsonObj::Kind), без RTTI
+ * @return nullptr если obj другого вида
+ * @note для пользовательских объектов - dynamic_cast
+ */
+template <typename T>
+T * dson_cast(DsonObj * obj) noexcept
+{
+	static_assert(T::obj_kind != DsonObj::Kind::Custom, "dson_cast is for library objects");
+	if (obj && obj->kind() == T::obj_kind)
+		return static_cast<T *>(obj);
+	return nullptr;
+}
+
+inline std::ostream & operator<<(std::ostream & out, DsonObj & dson)
+{
+	dson.copy_to_stream_network_order(out);
+	return out;
+}
+
 inline std::ofstream & operator<<(std::ofstream & out, DsonObj & dson)
 {
 	dson.copy_to_stream_network_order(out);
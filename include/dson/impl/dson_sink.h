@@ -0,0 +1,204 @@
+#ifndef DSON_SINK_H
+#define DSON_SINK_H
+
+#include <dson/impl/dson_obj.h>
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+namespace hi
+{
+
+/**
+ * @brief The DsonSink class
+ * Приёмник данных большого сообщения при загрузке из fd (см. Dson::load_from_fd(fd, sink, threshold)):
+ * данные не аллоцируются в Dson, а передаются приёмнику по мере чтения из fd
+ * (в заранее выделенный буфер, в файл, в колбэк).
+ */
+class DsonSink
+{
+public:
+	virtual ~DsonSink() = default;
+
+	/**
+	 * @brief begin
+	 * Начало данных сообщения
+	 * @param header заголовок сообщения в host order (data_size_ - сколько данных придёт)
+	 * @return false - отказ принимать (загрузка закончится Result::Error)
+	 */
+	virtual bool begin(const DsonObj::Header & header) = 0;
+
+	/**
+	 * @brief receive_from_fd
+	 * Принять следующие данные прямо из fd
+	 * @param fd откуда читать
+	 * @param size сколько данных сообщения осталось (больше читать нельзя)
+	 * @return сколько принято, 0 если fd не готов, -1 при ошибке
+	 */
+	virtual std::int64_t receive_from_fd(std::int32_t fd, std::int64_t size) = 0;
+
+	/**
+	 * @brief end
+	 * Все данные сообщения приняты
+	 * @return false - ошибка (загрузка закончится Result::Error)
+	 */
+	virtual bool end()
+	{
+		return true;
+	}
+};
+
+/**
+ * @brief The DsonBufSink class
+ * Данные читаются прямо в заранее выделенный (зарегистрированный) буфер
+ */
+class DsonBufSink : public DsonSink
+{
+public:
+	DsonBufSink(char * buf, const std::int64_t capacity)
+		: buf_{buf}
+		, capacity_{capacity}
+	{
+	}
+
+	bool begin(const DsonObj::Header & header) override
+	{
+		header_ = header;
+		size_ = 0;
+		return header.data_size_ <= capacity_;
+	}
+
+	std::int64_t receive_from_fd(std::int32_t fd, std::int64_t size) override
+	{
+		const auto readed = read_from_fd(fd, buf_ + size_, size);
+		if (readed > 0)
+			size_ += readed;
+		return readed;
+	}
+
+	// Заголовок принятого сообщения (host order)
+	const DsonObj::Header & header() const noexcept
+	{
+		return header_;
+	}
+
+	// Сколько данных принято в буфер
+	std::int64_t size() const noexcept
+	{
+		return size_;
+	}
+
+private:
+	char * const buf_;
+	const std::int64_t capacity_;
+	DsonObj::Header header_{};
+	std::int64_t size_{0};
+};
+
+/**
+ * @brief The DsonFileSink class
+ * Данные переносятся в файл через splice() (из сокета/pipe в файл без копирования в user space),
+ * иначе через буфер (read + write)
+ */
+class DsonFileSink : public DsonSink
+{
+public:
+	/**
+	 * @brief DsonFileSink
+	 * @param fd файл (не закрывается приёмником)
+	 * @param offset позиция записи первого сообщения, -1 - текущая позиция файла
+	 * @note следующие сообщения пишутся следом за предыдущими
+	 */
+	explicit DsonFileSink(const std::int32_t fd, const std::int64_t offset = -1)
+		: fd_{fd}
+		, offset_{offset}
+	{
+	}
+
+	bool begin(const DsonObj::Header & header) override
+	{
+		header_ = header;
+		size_ = 0;
+		return fd_ >= 0;
+	}
+
+	std::int64_t receive_from_fd(std::int32_t fd, std::int64_t size) override
+	{
+		const auto moved = receive_to_file(fd, fd_, offset_ >= 0 ? &offset_ : nullptr, size, pipe_);
+		if (moved > 0)
+			size_ += moved;
+		return moved;
+	}
+
+	const DsonObj::Header & header() const noexcept
+	{
+		return header_;
+	}
+
+	// Сколько данных последнего сообщения записано в файл
+	std::int64_t size() const noexcept
+	{
+		return size_;
+	}
+
+private:
+	const std::int32_t fd_;
+	std::int64_t offset_;
+	SplicePipe pipe_;
+	DsonObj::Header header_{};
+	std::int64_t size_{0};
+};
+
+/**
+ * @brief The DsonCallbackSink class
+ * Данные отдаются колбэку кусками не больше chunk_size
+ */
+class DsonCallbackSink : public DsonSink
+{
+public:
+	/**
+	 * @brief Callback
+	 * @param header заголовок сообщения (host order)
+	 * @param data очередной кусок данных
+	 * @param size размер куска
+	 * @return false - прервать загрузку (Result::Error)
+	 */
+	using Callback = std::function<bool(const DsonObj::Header & header, const char * data, std::int32_t size)>;
+
+	static constexpr std::int32_t default_chunk_size{64 * 1024};
+
+	explicit DsonCallbackSink(Callback callback, const std::int32_t chunk_size = default_chunk_size)
+		: callback_{std::move(callback)}
+		, chunk_size_{std::max(chunk_size, 1)}
+	{
+	}
+
+	bool begin(const DsonObj::Header & header) override
+	{
+		header_ = header;
+		// Буфер не больше сообщения
+		chunk_.resize(static_cast<std::size_t>(std::min(chunk_size_, header.data_size_)));
+		return !!callback_;
+	}
+
+	std::int64_t receive_from_fd(std::int32_t fd, std::int64_t size) override
+	{
+		const auto readed = read_from_fd(fd, chunk_.data(), std::min<std::int64_t>(size, chunk_.size()));
+		if (readed <= 0)
+			return readed;
+		if (!callback_(header_, chunk_.data(), static_cast<std::int32_t>(readed)))
+			return -1;
+		return readed;
+	}
+
+private:
+	Callback callback_;
+	const std::int32_t chunk_size_;
+	std::vector<char> chunk_;
+	DsonObj::Header header_{};
+};
+
+} // namespace hi
+
+#endif // DSON_SINK_H
@@ -1,6 +1,7 @@
 #ifndef DSON_TOOLS_H
 #define DSON_TOOLS_H
 
+#include <dson/impl/byte_swap.h>
 #include <dson/os/system_switch.h>
 
 #include <cfloat>
@@ -0,0 +1,224 @@
+#ifndef FLAT_MAP_H
+#define FLAT_MAP_H
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace hi
+{
+
+/**
+ * @brief The FlatMap class
+ * Отсортированный по ключу непрерывный массив пар ключ->значение.
+ * Замена std::map для небольших контейнеров (типичный Dson - 5..30 ключей):
+ *  - нет аллокации узла дерева на каждый элемент
+ *  - поиск идёт по непрерывной памяти (линейно для малых размеров, бинарно для больших)
+ *  - итерация в порядке возрастания ключа, как у std::map
+ * Элементы - std::pair<K, V>, поэтому обход через structured bindings работает как с std::map.
+ * @note вставка в середину O(n), но при загрузке из буфера ключи идут по возрастанию
+ * и вставка сводится к push_back
+ * @note итераторы инвалидируются при вставке (как у std::vector), для обхода с возобновлением
+ * следует использовать индекс и by_index()
+ */
+template <typename K, typename V>
+class FlatMap
+{
+public:
+	using value_type = std::pair<K, V>;
+	using container_type = std::vector<value_type>;
+	using iterator = typename container_type::iterator;
+	using const_iterator = typename container_type::const_iterator;
+
+	iterator begin() noexcept
+	{
+		return items_.begin();
+	}
+
+	iterator end() noexcept
+	{
+		return items_.end();
+	}
+
+	const_iterator begin() const noexcept
+	{
+		return items_.begin();
+	}
+
+	const_iterator end() const noexcept
+	{
+		return items_.end();
+	}
+
+	std::size_t size() const noexcept
+	{
+		return items_.size();
+	}
+
+	bool empty() const noexcept
+	{
+		return items_.empty();
+	}
+
+	void clear() noexcept
+	{
+		items_.clear();
+	}
+
+	void reserve(std::size_t size)
+	{
+		items_.reserve(size);
+	}
+
+	/**
+	 * @brief by_index
+	 * Доступ к элементу по порядковому номеру (в порядке возрастания ключа)
+	 * @param index порядковый номер, должен быть меньше size()
+	 * @return пара ключ->значение
+	 */
+	value_type & by_index(std::size_t index) noexcept
+	{
+		return items_[index];
+	}
+
+	const value_type & by_index(std::size_t index) const noexcept
+	{
+		return items_[index];
+	}
+
+	iterator find(const K key) noexcept
+	{
+		auto it = lower_bound(key);
+		if (it != items_.end() && it->first == key)
+			return it;
+		return items_.end();
+	}
+
+	const_iterator find(const K key) const noexcept
+	{
+		auto it = lower_bound(key);
+		if (it != items_.end() && it->first == key)
+			return it;
+		return items_.end();
+	}
+
+	std::size_t count(const K key) const noexcept
+	{
+		return find(key) == items_.end() ? 0 : 1;
+	}
+
+	bool contains(const K key) const noexcept
+	{
+		return find(key) != items_.end();
+	}
+
+	/**
+	 * @brief at
+	 * Значение по ключу, как у std::map
+	 * @throw std::out_of_range если ключа нет
+	 */
+	V & at(const K key)
+	{
+		auto it = find(key);
+		if (it == items_.end())
+			throw std::out_of_range("FlatMap::at");
+		return it->second;
+	}
+
+	const V & at(const K key) const
+	{
+		auto it = find(key);
+		if (it == items_.end())
+			throw std::out_of_range("FlatMap::at");
+		return it->second;
+	}
+
+	/**
+	 * @brief insert_or_assign
+	 * Добавление значения по ключу, если значение с таким ключём уже есть, то оно будет заменено
+	 * @return итератор на элемент и true если элемент был добавлен (false если заменён)
+	 */
+	template <typename M>
+	std::pair<iterator, bool> insert_or_assign(const K key, M && value)
+	{
+		// Частый случай - ключи приходят по возрастанию
+		if (items_.empty() || items_.back().first < key)
+		{
+			items_.emplace_back(key, std::forward<M>(value));
+			return {std::prev(items_.end()), true};
+		}
+		auto it = lower_bound(key);
+		if (it != items_.end() && it->first == key)
+		{
+			it->second = std::forward<M>(value);
+			return {it, false};
+		}
+		return {items_.emplace(it, key, std::forward<M>(value)), true};
+	}
+
+	std::size_t erase(const K key)
+	{
+		auto it = find(key);
+		if (it == items_.end())
+			return 0;
+		items_.erase(it);
+		return 1;
+	}
+
+	void swap(FlatMap & other) noexcept
+	{
+		items_.swap(other.items_);
+	}
+
+private:
+	iterator lower_bound(const K key) noexcept
+	{
+		return items_.begin() + lower_bound_index(key);
+	}
+
+	const_iterator lower_bound(const K key) const noexcept
+	{
+		return items_.begin() + lower_bound_index(key);
+	}
+
+	std::size_t lower_bound_index(const K key) const noexcept
+	{
+		const std::size_t size = items_.size();
+		if (size <= linear_search_limit)
+		{
+			// На малых размерах линейный проход по кэш-линиям быстрее бинарного поиска
+			std::size_t i = 0;
+			while (i < size && items_[i].first < key)
+			{
+				++i;
+			}
+			return i;
+		}
+		const auto it = std::lower_bound(
+			items_.begin(),
+			items_.end(),
+			key,
+			[](const value_type & item, const K k)
+			{
+				return item.first < k;
+			});
+		return static_cast<std::size_t>(it - items_.begin());
+	}
+
+private:
+	static constexpr std::size_t linear_search_limit{16};
+	container_type items_;
+};
+
+template <typename K, typename V>
+inline void swap(FlatMap<K, V> & lhs, FlatMap<K, V> & rhs) noexcept
+{
+	lhs.swap(rhs);
+}
+
+} // namespace hi
+
+#endif // FLAT_MAP_H
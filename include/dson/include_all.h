@@ -1,8 +1,13 @@
 #ifndef INCLUDE_ALL_H
 #define INCLUDE_ALL_H
 
+#include <dson/custom_dson_objs/dson_file_obj.h>
+#include <dson/custom_dson_objs/dson_producer_obj.h>
 #include <dson/custom_dson_objs/dson_route_obj.h>
 #include <dson/dson.h>
+#include <dson/dson_broadcast.h>
+#include <dson/dson_enum.h>
+#include <dson/dson_fd_reader.h>
 #include <dson/from_dson_converters.h>
 
 #endif // INCLUDE_ALL_H
@@ -1 +1,3 @@
 #include <dson/os/linux/linux_network.h>
+#include <dson/os/linux/linux_mmap.h>
+#include <dson/os/linux/linux_sendfile.h>
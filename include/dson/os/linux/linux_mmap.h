@@ -0,0 +1,133 @@
+/*
+ * This is the source code of thread_highways library
+ *
+ * Copyright (c) Dmitriy Bondarenko
+ * feel free to contact me: bondarenkoda@gmail.com
+ */
+
+#ifndef LINUX_MMAP_H
+#define LINUX_MMAP_H
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdint>
+
+namespace hi
+{
+
+/**
+ * @brief The MappedFile class
+ * Файл, отображённый в память (mmap) только для чтения с copy-on-write:
+ * страницы подгружаются с диска при первом обращении,
+ * запись в отображение (например перевод байт в host order) не меняет файл.
+ * Отображение снимается в деструкторе.
+ */
+class MappedFile
+{
+public:
+	// Подсказка ядру о характере доступа (madvise)
+	enum class Advice
+	{
+		Normal,
+		// Чтение подряд: агрессивное упреждающее чтение, прочитанные страницы можно вытеснять
+		Sequential,
+		// Выборочное чтение нескольких ключей: без упреждающего чтения
+		Random
+	};
+
+	MappedFile() = default;
+	MappedFile(const MappedFile &) = delete;
+	MappedFile & operator=(const MappedFile &) = delete;
+
+	~MappedFile()
+	{
+		unmap();
+	}
+
+	/**
+	 * @brief map
+	 * Отобразить файл целиком
+	 * @param path путь к файлу
+	 * @param advice характер доступа
+	 * @return false если файл не открылся, пустой или mmap не удался
+	 */
+	bool map(const char * path, Advice advice) noexcept
+	{
+		unmap();
+		const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+		if (fd < 0)
+			return false;
+		struct stat st;
+		if (::fstat(fd, &st) != 0 || st.st_size <= 0)
+		{
+			::close(fd);
+			return false;
+		}
+		void * addr = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+		// Отображение держит файл само
+		::close(fd);
+		if (addr == MAP_FAILED)
+			return false;
+		data_ = static_cast<char *>(addr);
+		size_ = static_cast<std::int64_t>(st.st_size);
+		advise(advice);
+		return true;
+	}
+
+	/**
+	 * @brief advise
+	 * Сменить подсказку о характере доступа (например после выборочного чтения индекса
+	 * дальше читается подряд)
+	 */
+	void advise(Advice advice) noexcept
+	{
+		if (!data_)
+			return;
+		int flag{MADV_NORMAL};
+		switch (advice)
+		{
+		case Advice::Normal:
+			flag = MADV_NORMAL;
+			break;
+		case Advice::Sequential:
+			flag = MADV_SEQUENTIAL;
+			break;
+		case Advice::Random:
+			flag = MADV_RANDOM;
+			break;
+		}
+		// Подсказка: ошибка не мешает работе
+		::madvise(data_, static_cast<size_t>(size_), flag);
+	}
+
+	void unmap() noexcept
+	{
+		if (data_)
+		{
+			::munmap(data_, static_cast<size_t>(size_));
+			data_ = nullptr;
+			size_ = 0;
+		}
+	}
+
+	char * data() const noexcept
+	{
+		return data_;
+	}
+
+	std::int64_t size() const noexcept
+	{
+		return size_;
+	}
+
+private:
+	char * data_{nullptr};
+	std::int64_t size_{0};
+};
+
+} // namespace hi
+
+#endif // LINUX_MMAP_H
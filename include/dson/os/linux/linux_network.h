@@ -9,9 +9,11 @@
 #define LINUX_NETWORK_H
 
 #include <arpa/inet.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 #include <cerrno>
+#include <climits>
 #include <cstdint>
 
 namespace hi
@@ -36,6 +38,38 @@ inline std::int64_t write_to_fd(std::int32_t fd, const void * buf, std::int64_t
 	return re;
 }
 
+// Сколько буферов можно передать в один writev()
+#ifdef IOV_MAX
+inline constexpr std::int32_t max_iovec_count{IOV_MAX};
+#else
+inline constexpr std::int32_t max_iovec_count{1024};
+#endif
+
+/**
+ * @brief writev_to_fd
+ * Запись списка буферов одним системным вызовом
+ * @return сколько байт записано, 0 если fd не готов (EAGAIN), -1 при ошибке
+ */
+inline std::int64_t writev_to_fd(std::int32_t fd, const iovec * iov, std::int32_t count)
+{
+	if (count > max_iovec_count)
+		count = max_iovec_count;
+	const auto re = ::writev(fd, iov, count);
+	if (re < 0)
+	{
+		const auto err = errno;
+		if (EAGAIN == err || EWOULDBLOCK == err)
+		{
+			return 0;
+		}
+		else
+		{
+			return -1;
+		}
+	}
+	return re;
+}
+
 inline std::int64_t read_from_fd(std::int32_t fd, void * buf, std::int64_t buf_size)
 {
 	// todo обработать кейс когда int64_t больше чем может read
@@ -0,0 +1,282 @@
+/*
+ * This is the source code of thread_highways library
+ *
+ * Copyright (c) Dmitriy Bondarenko
+ * feel free to contact me: bondarenkoda@gmail.com
+ */
+
+#ifndef LINUX_SENDFILE_H
+#define LINUX_SENDFILE_H
+
+#include <dson/os/linux/linux_network.h>
+
+#if defined(__linux__)
+#	include <fcntl.h>
+#	include <sys/sendfile.h>
+#endif
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+
+namespace hi
+{
+
+/**
+ * @brief send_file_to_fd_copy
+ * Передача участка файла через буфер (pread + write) там, где sendfile() нет или он не поддерживает in_fd
+ * @return см. send_file_to_fd()
+ */
+inline std::int64_t send_file_to_fd_copy(
+	std::int32_t out_fd,
+	std::int32_t in_fd,
+	std::int64_t & offset,
+	std::int64_t size)
+{
+	char buf[16 * 1024];
+	const auto readed = ::pread(in_fd, buf, static_cast<size_t>(std::min<std::int64_t>(size, sizeof(buf))), offset);
+	if (readed <= 0)
+	{
+		// Файл короче заявленного или ошибка чтения
+		return -1;
+	}
+	const auto writed = write_to_fd(out_fd, buf, readed);
+	if (writed > 0)
+		offset += writed;
+	// Недописанное будет прочитано заново при следующем вызове
+	return writed;
+}
+
+/**
+ * @brief send_file_to_fd
+ * Передача участка файла в fd (сокет/pipe/файл) без копирования данных в user space (sendfile())
+ * @param out_fd куда
+ * @param in_fd файл откуда (позиция чтения in_fd не меняется)
+ * @param offset позиция в in_fd, сдвигается на переданное
+ * @param size сколько передать
+ * @return сколько байт передано, 0 если out_fd не готов (EAGAIN),
+ * -1 при ошибке (в том числе если файл закончился раньше)
+ */
+inline std::int64_t send_file_to_fd(
+	std::int32_t out_fd,
+	std::int32_t in_fd,
+	std::int64_t & offset,
+	std::int64_t size)
+{
+#if defined(__linux__)
+	off_t off = static_cast<off_t>(offset);
+	const auto re = ::sendfile(out_fd, in_fd, &off, static_cast<size_t>(size));
+	if (re < 0)
+	{
+		const auto err = errno;
+		if (EAGAIN == err || EWOULDBLOCK == err)
+			return 0;
+		if (EINVAL == err || ENOSYS == err)
+		{
+			// Файловая система in_fd не поддерживает sendfile()
+			return send_file_to_fd_copy(out_fd, in_fd, offset, size);
+		}
+		return -1;
+	}
+	if (re == 0)
+	{
+		// Файл закончился раньше
+		return -1;
+	}
+	offset = static_cast<std::int64_t>(off);
+	return re;
+#else
+	return send_file_to_fd_copy(out_fd, in_fd, offset, size);
+#endif
+}
+
+/**
+ * @brief write_all_to_file
+ * Запись в файл целиком (блокирующий fd): данные уже прочитаны из источника и не должны потеряться
+ * @param offset позиция записи (сдвигается), nullptr - текущая позиция файла
+ * @return false при ошибке записи
+ */
+inline bool write_all_to_file(std::int32_t out_fd, const char * buf, std::int64_t size, std::int64_t * offset)
+{
+	while (size > 0)
+	{
+		const auto writed = offset ? ::pwrite(out_fd, buf, static_cast<size_t>(size), *offset)
+								   : ::write(out_fd, buf, static_cast<size_t>(size));
+		if (writed <= 0)
+		{
+			if (writed < 0 && EINTR == errno)
+				continue;
+			return false;
+		}
+		buf += writed;
+		size -= writed;
+		if (offset)
+			*offset += writed;
+	}
+	return true;
+}
+
+/**
+ * @brief receive_to_file_copy
+ * Перенос из in_fd в файл через буфер (read + write) там, где splice() нет или он не поддерживает fd
+ * @return см. receive_to_file()
+ */
+inline std::int64_t receive_to_file_copy(
+	std::int32_t in_fd,
+	std::int32_t out_fd,
+	std::int64_t * out_offset,
+	std::int64_t size)
+{
+	char buf[16 * 1024];
+	const auto readed = read_from_fd(in_fd, buf, std::min<std::int64_t>(size, sizeof(buf)));
+	if (readed <= 0)
+		return readed;
+	if (!write_all_to_file(out_fd, buf, readed, out_offset))
+		return -1;
+	return readed;
+}
+
+/**
+ * @brief The SplicePipe class
+ * Промежуточный pipe для splice(): in_fd -> pipe -> out_fd.
+ * Если pipe не создался (или splice() нет) - is_open() == false, перенос идёт через буфер.
+ */
+class SplicePipe
+{
+public:
+	SplicePipe()
+	{
+#if defined(__linux__)
+		int fds[2];
+		if (::pipe2(fds, O_CLOEXEC | O_NONBLOCK) == 0)
+		{
+			read_fd_ = fds[0];
+			write_fd_ = fds[1];
+		}
+#endif
+	}
+
+	SplicePipe(const SplicePipe &) = delete;
+	SplicePipe & operator=(const SplicePipe &) = delete;
+
+	~SplicePipe()
+	{
+		close();
+	}
+
+	bool is_open() const noexcept
+	{
+		return read_fd_ >= 0;
+	}
+
+	void close() noexcept
+	{
+		if (read_fd_ >= 0)
+		{
+			::close(read_fd_);
+			::close(write_fd_);
+			read_fd_ = -1;
+			write_fd_ = -1;
+		}
+	}
+
+	std::int32_t read_fd() const noexcept
+	{
+		return read_fd_;
+	}
+
+	std::int32_t write_fd() const noexcept
+	{
+		return write_fd_;
+	}
+
+private:
+	std::int32_t read_fd_{-1};
+	std::int32_t write_fd_{-1};
+};
+
+/**
+ * @brief receive_to_file
+ * Перенос до size байт из in_fd (сокет/pipe) в файл out_fd без копирования в user space:
+ * splice() из in_fd в pipe, затем из pipe в файл (всё что попало в pipe дописывается в файл сразу).
+ * Если splice() для этих fd не поддерживается - pipe закрывается и дальше перенос идёт через буфер.
+ * @param pipe промежуточный pipe
+ * @param out_offset позиция записи в файл (сдвигается), nullptr - текущая позиция файла
+ * @return сколько перенесено, 0 если in_fd не готов (или закрыт), -1 при ошибке
+ */
+inline std::int64_t receive_to_file(
+	std::int32_t in_fd,
+	std::int32_t out_fd,
+	std::int64_t * out_offset,
+	std::int64_t size,
+	SplicePipe & pipe)
+{
+#if defined(__linux__)
+	if (pipe.is_open())
+	{
+		const auto moved = ::splice(
+			in_fd,
+			nullptr,
+			pipe.write_fd(),
+			nullptr,
+			static_cast<size_t>(size),
+			SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+		if (moved < 0)
+		{
+			const auto err = errno;
+			if (EAGAIN == err || EWOULDBLOCK == err)
+				return 0;
+			if (EINVAL != err)
+				return -1;
+			// in_fd или out_fd не поддерживают splice()
+			pipe.close();
+			return receive_to_file_copy(in_fd, out_fd, out_offset, size);
+		}
+		std::int64_t left = moved;
+		while (left > 0)
+		{
+			loff_t off = out_offset ? static_cast<loff_t>(*out_offset) : 0;
+			const auto writed = ::splice(
+				pipe.read_fd(),
+				nullptr,
+				out_fd,
+				out_offset ? &off : nullptr,
+				static_cast<size_t>(left),
+				SPLICE_F_MOVE);
+			if (writed <= 0)
+			{
+				if (writed < 0 && EINTR == errno)
+					continue;
+				if (writed < 0 && EINVAL == errno)
+				{
+					// Файл не поддерживает splice(): данные из pipe дописываются через буфер
+					char buf[16 * 1024];
+					while (left > 0)
+					{
+						const auto readed
+							= ::read(pipe.read_fd(), buf, static_cast<size_t>(std::min<std::int64_t>(left, sizeof(buf))));
+						if (readed <= 0 || !write_all_to_file(out_fd, buf, readed, out_offset))
+							return -1;
+						left -= readed;
+					}
+					pipe.close();
+					return moved;
+				}
+				return -1;
+			}
+			if (out_offset)
+				*out_offset = static_cast<std::int64_t>(off);
+			left -= writed;
+		}
+		return moved;
+	}
+#else
+	(void)pipe;
+#endif
+	return receive_to_file_copy(in_fd, out_fd, out_offset, size);
+}
+
+} // namespace hi
+
+#endif // LINUX_SENDFILE_H
@@ -0,0 +1,75 @@
+#include <dson/dson.h>
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <vector>
+
+/*
+  Пропускная способность ядер перестановки байт (<dson/impl/byte_swap.h>) в GB/s.
+  Маленький массив помещается в L1, большой - мерит работу с памятью.
+  Сборка для замеров: cmake -DCMAKE_BUILD_TYPE=Release
+*/
+
+namespace
+{
+
+constexpr std::size_t bytes_per_test{1024ull * 1024 * 1024};
+
+double measure_gb_per_s(hi::ByteSwap32Fn kernel, std::vector<std::uint32_t> & data)
+{
+	const std::size_t bytes = data.size() * sizeof(std::uint32_t);
+	const std::size_t rounds = std::max<std::size_t>(1, bytes_per_test / bytes);
+	const auto start = std::chrono::steady_clock::now();
+	for (std::size_t r = 0; r < rounds; ++r)
+	{
+		kernel(data.data(), data.size());
+	}
+	const auto finish = std::chrono::steady_clock::now();
+	const double seconds = std::chrono::duration<double>(finish - start).count();
+	return static_cast<double>(rounds * bytes) / seconds / 1e9;
+}
+
+} // namespace
+
+int main(int /* argc */, char ** /* argv */)
+{
+	struct Kernel
+	{
+		const char * name;
+		hi::ByteSwap32Fn fn;
+		bool available;
+	};
+	std::vector<Kernel> kernels{{"scalar", &hi::byte_swap32_scalar, true}};
+#ifdef DSON_X86_SIMD
+	const hi::CpuFeatures cpu = hi::CpuFeatures::detect();
+	kernels.push_back({"sse2", &hi::byte_swap32_sse2, cpu.sse2_});
+	kernels.push_back({"ssse3", &hi::byte_swap32_ssse3, cpu.ssse3_});
+	kernels.push_back({"avx2", &hi::byte_swap32_avx2, cpu.avx2_});
+#endif
+	kernels.push_back({"dispatch", &hi::byte_swap32_array, true});
+
+	std::cout << "GB/s" << std::endl;
+	std::cout << std::setw(10) << "kernel" << std::setw(14) << "4 KB" << std::setw(14) << "256 KB" << std::setw(14)
+			  << "64 MB" << std::endl;
+	std::cout << std::fixed << std::setprecision(2);
+	for (const auto & kernel : kernels)
+	{
+		std::cout << std::setw(10) << kernel.name;
+		if (!kernel.available)
+		{
+			std::cout << "  not supported by this CPU" << std::endl;
+			continue;
+		}
+		for (const std::size_t bytes : {4ull * 1024, 256ull * 1024, 64ull * 1024 * 1024})
+		{
+			std::vector<std::uint32_t> data(bytes / sizeof(std::uint32_t));
+			std::iota(data.begin(), data.end(), 0u);
+			std::cout << std::setw(14) << measure_gb_per_s(kernel.fn, data);
+		}
+		std::cout << std::endl;
+	}
+	std::cout << "Tests finished" << std::endl;
+	return 0;
+}
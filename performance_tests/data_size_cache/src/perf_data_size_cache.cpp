@@ -0,0 +1,128 @@
+#include <dson/dson.h>
+#include <dson/from_dson_converters.h>
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+
+/*
+  Размер контейнера Dson: закэшированный data_size() против рекурсивного пересчёта.
+  Дерево глубиной 5 уровней (4 уровня контейнеров по 10 детей + листья), 10000 листьев.
+  До кэширования сериализация вызывала data_size() на каждом уровне вложенности,
+  то есть каждый лист обходился depth раз: это и эмулирует recursive_size_per_level().
+  Сборка для замеров: cmake -DCMAKE_BUILD_TYPE=Release
+*/
+
+namespace
+{
+
+constexpr std::int32_t fanout{10};
+constexpr std::int32_t container_levels{4};
+constexpr std::int32_t rounds{50};
+
+hi::Dson make_tree(std::int32_t level)
+{
+	hi::Dson dson;
+	for (std::int32_t key = 0; key < fanout; ++key)
+	{
+		if (level + 1 == container_levels)
+		{
+			dson.emplace(key, static_cast<std::uint32_t>(key));
+		}
+		else
+		{
+			dson.emplace(key, make_tree(level + 1));
+		}
+	}
+	return dson;
+}
+
+// Размер как он считался без кэша: рекурсивный обход всех детей
+std::int32_t recursive_size(hi::Dson & dson)
+{
+	if (dson.data_type() != hi::types_map<hi::DsonContainer>::value)
+		return dson.data_size();
+	std::int32_t re{0};
+	for (auto & it : dson.map())
+	{
+		re += recursive_size(*static_cast<hi::Dson *>(it.second.get())) + hi::DsonObj::header_size;
+	}
+	return re;
+}
+
+// Пересчёт на каждом уровне вложенности, как при выгрузке без кэша
+std::int64_t recursive_size_per_level(hi::Dson & dson)
+{
+	if (dson.data_type() != hi::types_map<hi::DsonContainer>::value)
+		return 0;
+	std::int64_t re = recursive_size(dson);
+	for (auto & it : dson.map())
+	{
+		re += recursive_size_per_level(*static_cast<hi::Dson *>(it.second.get()));
+	}
+	return re;
+}
+
+template <typename F>
+double measure_us(F && f)
+{
+	const auto start = std::chrono::steady_clock::now();
+	for (std::int32_t i = 0; i < rounds; ++i)
+	{
+		f();
+	}
+	const auto finish = std::chrono::steady_clock::now();
+	return static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(finish - start).count())
+		/ rounds;
+}
+
+} // namespace
+
+int main(int /* argc */, char ** /* argv */)
+{
+	hi::Dson tree = make_tree(0);
+	std::int64_t sink{0};
+	std::cout << "tree: depth " << container_levels + 1 << ", leaves " << fanout * fanout * fanout * fanout
+			  << ", data_size " << tree.data_size() << std::endl;
+	std::cout << std::fixed << std::setprecision(1);
+
+	const double per_level = measure_us(
+		[&]
+		{
+			sink += recursive_size_per_level(tree);
+		});
+	const double cached = measure_us(
+		[&]
+		{
+			sink += tree.data_size();
+		});
+	std::vector<char> buf(static_cast<std::size_t>(tree.data_size() + hi::DsonObj::header_size));
+	const double serialize = measure_us(
+		[&]
+		{
+			char * ptr = buf.data();
+			std::int32_t size = static_cast<std::int32_t>(buf.size());
+			tree.copy_to_buf_host_order(ptr, size);
+			sink += size;
+		});
+	const double modify_and_size = measure_us(
+		[&]
+		{
+			// изменение одного листа сбрасывает кэш только вверх по своей ветке
+			auto leaf_parent = static_cast<hi::Dson *>(tree.get(1));
+			leaf_parent = static_cast<hi::Dson *>(leaf_parent->get(2));
+			leaf_parent = static_cast<hi::Dson *>(leaf_parent->get(3));
+			leaf_parent->emplace(4, std::uint32_t{4});
+			sink += tree.data_size();
+		});
+
+	std::cout << "us per call:" << std::endl;
+	std::cout << std::setw(40) << "recursive size on every level: " << per_level << std::endl;
+	std::cout << std::setw(40) << "cached data_size(): " << cached << std::endl;
+	std::cout << std::setw(40) << "copy_to_buf_host_order (cached): " << serialize << std::endl;
+	std::cout << std::setw(40) << "modify leaf + data_size(): " << modify_and_size << std::endl;
+	if (sink == 0)
+		std::cout << "";
+	std::cout << "Tests finished" << std::endl;
+	return 0;
+}
@@ -0,0 +1,118 @@
+#include <dson/dson.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+/*
+  Повторная отправка редко меняющегося состояния: обход дерева при каждой выгрузке
+  против закэшированного закодированного вида (Dson::cache_encoded()).
+  Дерево 3 уровня контейнеров по 10 детей, 1000 листьев, network order.
+  Сборка для замеров: cmake -DCMAKE_BUILD_TYPE=Release
+*/
+
+namespace
+{
+
+constexpr std::int32_t fanout{10};
+constexpr std::int32_t container_levels{3};
+constexpr std::int32_t rounds{2000};
+
+hi::Dson make_tree(std::int32_t level)
+{
+	hi::Dson dson;
+	for (std::int32_t key = 0; key < fanout; ++key)
+	{
+		if (level + 1 == container_levels)
+		{
+			dson.emplace(key, static_cast<std::uint32_t>(key));
+		}
+		else
+		{
+			dson.emplace(key, make_tree(level + 1));
+		}
+	}
+	return dson;
+}
+
+template <typename F>
+double measure_us(F && f)
+{
+	const auto start = std::chrono::steady_clock::now();
+	for (std::int32_t i = 0; i < rounds; ++i)
+	{
+		f();
+	}
+	const auto finish = std::chrono::steady_clock::now();
+	return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(finish - start).count())
+		/ rounds / 1000.0;
+}
+
+} // namespace
+
+int main(int /* argc */, char ** /* argv */)
+{
+	hi::Dson plain = make_tree(0);
+	hi::Dson cached = make_tree(0);
+	cached.cache_encoded();
+	std::vector<char> buf(static_cast<std::size_t>(plain.data_size() + hi::DsonObj::header_size));
+	std::int64_t sink{0};
+	std::cout << "tree: leaves " << fanout * fanout * fanout << ", data_size " << plain.data_size() << std::endl;
+	std::cout << std::fixed << std::setprecision(2);
+
+	auto to_buf = [&](hi::Dson & dson)
+	{
+		char * ptr = buf.data();
+		std::int32_t size = static_cast<std::int32_t>(buf.size());
+		dson.copy_to_buf_network_order(ptr, size);
+		sink += size + buf[20];
+	};
+	const double buf_plain = measure_us(
+		[&]
+		{
+			to_buf(plain);
+		});
+	const double buf_cached = measure_us(
+		[&]
+		{
+			to_buf(cached);
+		});
+
+	const int fd = ::open("/dev/null", O_WRONLY);
+	const double fd_plain = measure_us(
+		[&]
+		{
+			sink += static_cast<std::int64_t>(plain.copy_to_fd_network_order(fd));
+		});
+	const double fd_cached = measure_us(
+		[&]
+		{
+			sink += static_cast<std::int64_t>(cached.copy_to_fd_network_order(fd));
+		});
+	::close(fd);
+
+	const double modify_cached = measure_us(
+		[&]
+		{
+			// изменение листа: перекодирование один раз, затем снова кэш
+			auto leaf_parent = static_cast<hi::Dson *>(cached.get(1));
+			leaf_parent = static_cast<hi::Dson *>(leaf_parent->get(2));
+			leaf_parent->emplace(3, std::uint32_t{3});
+			to_buf(cached);
+		});
+
+	std::cout << "us per send:" << std::endl;
+	std::cout << std::setw(40) << "copy_to_buf walk tree: " << buf_plain << std::endl;
+	std::cout << std::setw(40) << "copy_to_buf cached: " << buf_cached << std::endl;
+	std::cout << std::setw(40) << "copy_to_fd walk tree: " << fd_plain << std::endl;
+	std::cout << std::setw(40) << "copy_to_fd cached: " << fd_cached << std::endl;
+	std::cout << std::setw(40) << "modify leaf + copy_to_buf cached: " << modify_cached << std::endl;
+	if (sink == 0)
+		std::cout << "";
+	std::cout << "Tests finished" << std::endl;
+	return 0;
+}
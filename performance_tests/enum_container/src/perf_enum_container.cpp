@@ -0,0 +1,96 @@
+#include <dson/dson_enum.h>
+#include <dson/from_dson_converters.h>
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+/*
+  Доступ к полям сообщения с плотными enum ключами:
+  Dson (поиск по FlatMap) против DsonEnum (слот по индексу ключа).
+  Сообщение из 16 полей uint32, за раунд читаются все поля.
+  Сборка для замеров: cmake -DCMAKE_BUILD_TYPE=Release
+*/
+
+namespace
+{
+
+enum class Keys : std::int32_t
+{
+	max = 16
+};
+
+constexpr std::int32_t fields{static_cast<std::int32_t>(Keys::max)};
+constexpr std::int32_t rounds{200000};
+
+template <typename F>
+double measure_ns(F && f)
+{
+	const auto start = std::chrono::steady_clock::now();
+	for (std::int32_t i = 0; i < rounds; ++i)
+	{
+		f();
+	}
+	const auto finish = std::chrono::steady_clock::now();
+	return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(finish - start).count())
+		/ rounds / fields;
+}
+
+} // namespace
+
+int main(int /* argc */, char ** /* argv */)
+{
+	hi::Dson dson;
+	hi::DsonEnum<Keys> message;
+	for (std::int32_t key = 0; key < fields; ++key)
+	{
+		dson.emplace(key, static_cast<std::uint32_t>(key));
+		message.emplace(static_cast<Keys>(key), static_cast<std::uint32_t>(key));
+	}
+	std::uint64_t sink{0};
+	std::cout << std::fixed << std::setprecision(2);
+
+	const double get_dson = measure_ns(
+		[&]
+		{
+			for (std::int32_t key = 0; key < fields; ++key)
+			{
+				sink += hi::to_uint32(dson.get(key));
+			}
+		});
+	const double get_enum = measure_ns(
+		[&]
+		{
+			for (std::int32_t key = 0; key < fields; ++key)
+			{
+				sink += hi::to_uint32(message.get(static_cast<Keys>(key)));
+			}
+		});
+	const double emplace_dson = measure_ns(
+		[&]
+		{
+			for (std::int32_t key = 0; key < fields; ++key)
+			{
+				dson.emplace(key, static_cast<std::uint32_t>(key));
+			}
+		});
+	const double emplace_enum = measure_ns(
+		[&]
+		{
+			for (std::int32_t key = 0; key < fields; ++key)
+			{
+				message.emplace(static_cast<Keys>(key), static_cast<std::uint32_t>(key));
+			}
+		});
+
+	std::cout << "ns per field:" << std::endl;
+	std::cout << std::setw(30) << "Dson get: " << get_dson << std::endl;
+	std::cout << std::setw(30) << "DsonEnum get: " << get_enum << std::endl;
+	std::cout << std::setw(30) << "Dson emplace: " << emplace_dson << std::endl;
+	std::cout << std::setw(30) << "DsonEnum emplace: " << emplace_enum << std::endl;
+	if (sink == 0)
+		std::cout << "";
+	std::cout << "Tests finished" << std::endl;
+	return 0;
+}
@@ -0,0 +1,175 @@
+#include <dson/dson.h>
+#include <dson/from_dson_converters.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <numeric>
+#include <random>
+
+/*
+  Сравнение хранилища дочерних объектов Dson:
+  std::map (как было) против hi::FlatMap (Dson::ObjectsMap).
+  Значения - пустые std::unique_ptr<DsonObj>, чтобы мерить только сам контейнер.
+  Сборка для замеров: cmake -DCMAKE_BUILD_TYPE=Release
+*/
+
+namespace
+{
+
+using Value = std::unique_ptr<hi::DsonObj>;
+using StdMap = std::map<std::int32_t, Value>;
+using FlatMap = hi::FlatMap<std::int32_t, Value>;
+
+// Сколько всего операций делать на каждом замере (независимо от размера контейнера)
+constexpr std::size_t ops_per_test{4'000'000};
+
+template <typename F>
+double measure_ns_per_op(std::size_t ops, F && f)
+{
+	const auto start = std::chrono::steady_clock::now();
+	f();
+	const auto finish = std::chrono::steady_clock::now();
+	return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(finish - start).count())
+		/ static_cast<double>(ops);
+}
+
+template <typename Map>
+double bench_insert(const std::vector<std::int32_t> & keys)
+{
+	const std::size_t rounds = std::max<std::size_t>(1, ops_per_test / keys.size());
+	std::size_t sink{0};
+	const double re = measure_ns_per_op(
+		rounds * keys.size(),
+		[&]
+		{
+			for (std::size_t r = 0; r < rounds; ++r)
+			{
+				Map map;
+				for (const auto key : keys)
+				{
+					map.insert_or_assign(key, Value{});
+				}
+				sink += map.size();
+			}
+		});
+	if (sink == 0)
+		std::cout << "";
+	return re;
+}
+
+template <typename Map>
+double bench_find(const std::vector<std::int32_t> & keys)
+{
+	Map map;
+	for (const auto key : keys)
+	{
+		map.insert_or_assign(key, Value{});
+	}
+	std::vector<std::int32_t> lookup{keys};
+	std::shuffle(lookup.begin(), lookup.end(), std::mt19937{42});
+	const std::size_t rounds = std::max<std::size_t>(1, ops_per_test / keys.size());
+	std::size_t found{0};
+	const double re = measure_ns_per_op(
+		rounds * keys.size(),
+		[&]
+		{
+			for (std::size_t r = 0; r < rounds; ++r)
+			{
+				for (const auto key : lookup)
+				{
+					found += (map.find(key) != map.end());
+				}
+			}
+		});
+	if (found != rounds * keys.size())
+		std::cout << "ERROR: not all keys found" << std::endl;
+	return re;
+}
+
+template <typename Map>
+double bench_iterate(const std::vector<std::int32_t> & keys)
+{
+	Map map;
+	for (const auto key : keys)
+	{
+		map.insert_or_assign(key, Value{});
+	}
+	const std::size_t rounds = std::max<std::size_t>(1, ops_per_test / keys.size());
+	std::int64_t sum{0};
+	const double re = measure_ns_per_op(
+		rounds * keys.size(),
+		[&]
+		{
+			for (std::size_t r = 0; r < rounds; ++r)
+			{
+				for (const auto & [key, value] : map)
+				{
+					sum += key;
+				}
+			}
+		});
+	if (sum == 0)
+		std::cout << "";
+	return re;
+}
+
+// Полный цикл: сборка Dson, сериализация в буфер, загрузка, чтение всех полей
+double bench_dson_roundtrip(const std::vector<std::int32_t> & keys)
+{
+	const std::size_t rounds = std::max<std::size_t>(1, ops_per_test / 10 / keys.size());
+	std::uint64_t sum{0};
+	return measure_ns_per_op(
+		rounds * keys.size(),
+		[&]
+		{
+			for (std::size_t r = 0; r < rounds; ++r)
+			{
+				hi::Dson dson;
+				for (const auto key : keys)
+				{
+					dson.emplace(key, static_cast<std::uint32_t>(key));
+				}
+				const auto buf = dson.to_buf_host_order();
+				hi::Dson loaded;
+				loaded.load_from_buf(const_cast<char *>(buf.data()), static_cast<std::int32_t>(buf.size()));
+				for (const auto key : keys)
+				{
+					sum += hi::to_uint32(loaded.get(key));
+				}
+			}
+			if (sum == 0)
+				std::cout << "";
+		});
+}
+
+} // namespace
+
+int main(int /* argc */, char ** /* argv */)
+{
+	std::cout << "ns/op, std::map vs hi::FlatMap" << std::endl;
+	std::cout << std::setw(8) << "keys" << std::setw(14) << "insert map" << std::setw(14) << "insert flat"
+			  << std::setw(14) << "find map" << std::setw(14) << "find flat" << std::setw(14) << "iter map"
+			  << std::setw(14) << "iter flat" << std::setw(16) << "dson roundtrip" << std::endl;
+	std::cout << std::fixed << std::setprecision(2);
+	for (const std::size_t size : {5, 10, 20, 30, 100, 1000, 10000})
+	{
+		std::vector<std::int32_t> keys(size);
+		// разреженные ключи, вставка в случайном порядке (как при emplace)
+		std::iota(keys.begin(), keys.end(), 0);
+		for (auto & key : keys)
+		{
+			key *= 3;
+		}
+		std::shuffle(keys.begin(), keys.end(), std::mt19937{7});
+
+		std::cout << std::setw(8) << size << std::setw(14) << bench_insert<StdMap>(keys) << std::setw(14)
+				  << bench_insert<FlatMap>(keys) << std::setw(14) << bench_find<StdMap>(keys) << std::setw(14)
+				  << bench_find<FlatMap>(keys) << std::setw(14) << bench_iterate<StdMap>(keys) << std::setw(14)
+				  << bench_iterate<FlatMap>(keys) << std::setw(16) << bench_dson_roundtrip(keys) << std::endl;
+	}
+	std::cout << "Tests finished" << std::endl;
+	return 0;
+}
@@ -0,0 +1,129 @@
+#include <dson/dson.h>
+#include <dson/from_dson_converters.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <string>
+
+/*
+  Пропускная способность записи/чтения архива Dson через потоки.
+  Архив: сообщения по 1 MiB (контейнер: ключ, счётчик и строка), по умолчанию 1 GiB.
+  operator<< пишет через ostream::write, для сравнения - побайтовая запись
+  через std::ostream_iterator<char> (как было раньше) на части архива.
+  Размер архива в MiB можно передать первым аргументом.
+  Сборка для замеров: cmake -DCMAKE_BUILD_TYPE=Release
+*/
+
+namespace
+{
+
+constexpr std::int32_t message_size{1024 * 1024};
+constexpr std::int32_t ostream_iterator_limit_mib{64};
+constexpr const char * file_name{"perf_stream_io.bin"};
+
+hi::Dson make_message(std::int32_t id)
+{
+	hi::Dson dson;
+	dson.set_key(id);
+	dson.emplace(1, static_cast<std::uint32_t>(id));
+	// заголовки контейнера, счётчика и строки
+	const std::int32_t overhead = 3 * hi::DsonObj::header_size + static_cast<std::int32_t>(sizeof(std::uint32_t));
+	dson.emplace(2, std::string(static_cast<std::size_t>(message_size - overhead), static_cast<char>('a' + id % 26)));
+	return dson;
+}
+
+double seconds_since(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void print(const char * name, std::int64_t bytes, double seconds)
+{
+	std::cout << std::setw(36) << name << std::setw(10) << bytes / (1024 * 1024) << " MiB "
+			  << std::setw(10) << static_cast<double>(bytes) / (1024 * 1024) / seconds << " MiB/s" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char ** argv)
+{
+	std::int32_t total_mib{1024};
+	if (argc > 1)
+		total_mib = std::max(1, std::atoi(argv[1]));
+	std::cout << std::fixed << std::setprecision(1);
+
+	// Набор сообщений переиспользуется по кругу: в памяти не нужно держать весь архив
+	constexpr std::int32_t distinct{16};
+	std::vector<hi::Dson> messages;
+	for (std::int32_t i = 0; i < distinct; ++i)
+	{
+		messages.emplace_back(make_message(i));
+	}
+
+	std::int64_t written{0};
+	{
+		std::ofstream out(file_name, std::ios::binary);
+		const auto start = std::chrono::steady_clock::now();
+		for (std::int32_t i = 0; i < total_mib; ++i)
+		{
+			hi::Dson & dson = messages[static_cast<std::size_t>(i % distinct)];
+			out << dson;
+			written += dson.data_size() + hi::DsonObj::header_size;
+		}
+		out.flush();
+		print("operator<< (ostream::write):", written, seconds_since(start));
+	}
+
+	std::int64_t readed{0};
+	{
+		std::ifstream in(file_name, std::ios::binary);
+		hi::Dson dson;
+		const auto start = std::chrono::steady_clock::now();
+		for (std::int32_t i = 0; i < total_mib; ++i)
+		{
+			in >> dson;
+			if (dson.state() != hi::DsonObj::State::Ready)
+			{
+				std::cout << "ERROR: read failed on message " << i << std::endl;
+				return 1;
+			}
+			readed += dson.data_size() + hi::DsonObj::header_size;
+		}
+		print("operator>> (istream::read):", readed, seconds_since(start));
+		if (hi::to_uint32(dson, 1) != static_cast<std::uint32_t>((total_mib - 1) % distinct))
+		{
+			std::cout << "ERROR: wrong content" << std::endl;
+			return 1;
+		}
+	}
+
+	{
+		// Побайтовая запись: сериализованный буфер через std::ostream_iterator<char>
+		const std::int32_t count = std::min(total_mib, ostream_iterator_limit_mib);
+		std::vector<char> buf(static_cast<std::size_t>(message_size));
+		std::int64_t bytes{0};
+		std::ofstream out(file_name, std::ios::binary);
+		const auto start = std::chrono::steady_clock::now();
+		for (std::int32_t i = 0; i < count; ++i)
+		{
+			hi::Dson & dson = messages[static_cast<std::size_t>(i % distinct)];
+			char * ptr = buf.data();
+			std::int32_t size = static_cast<std::int32_t>(buf.size());
+			dson.copy_to_buf_network_order(ptr, size);
+			std::copy(buf.begin(), buf.end(), std::ostream_iterator<char>(out));
+			bytes += static_cast<std::int64_t>(buf.size());
+		}
+		out.flush();
+		print("std::ostream_iterator<char>:", bytes, seconds_since(start));
+	}
+
+	std::remove(file_name);
+	std::cout << "Tests finished" << std::endl;
+	return 0;
+}
@@ -0,0 +1,128 @@
+#include <dson/dson.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/*
+  Пересылка принятого сообщения в другом byte order: разбор на детей (map()) и обход дерева
+  против перевода прямо при копировании буфера (без разбора).
+  Принято в network order, отправляется в host order.
+  Дерево 3 уровня контейнеров по 10 детей, 1000 листьев (uint32 и строки).
+  Сборка для замеров: cmake -DCMAKE_BUILD_TYPE=Release
+*/
+
+namespace
+{
+
+constexpr std::int32_t fanout{10};
+constexpr std::int32_t container_levels{3};
+constexpr std::int32_t rounds{2000};
+
+hi::Dson make_tree(std::int32_t level)
+{
+	hi::Dson dson;
+	for (std::int32_t key = 0; key < fanout; ++key)
+	{
+		if (level + 1 < container_levels)
+		{
+			dson.emplace(key, make_tree(level + 1));
+		}
+		else if (key % 2)
+		{
+			dson.emplace(key, std::string(32, 's'));
+		}
+		else
+		{
+			dson.emplace(key, static_cast<std::uint32_t>(key));
+		}
+	}
+	return dson;
+}
+
+template <typename F>
+double measure_us(F && f)
+{
+	const auto start = std::chrono::steady_clock::now();
+	for (std::int32_t i = 0; i < rounds; ++i)
+	{
+		f();
+	}
+	const auto finish = std::chrono::steady_clock::now();
+	return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(finish - start).count())
+		/ rounds / 1000.0;
+}
+
+} // namespace
+
+int main(int /* argc */, char ** /* argv */)
+{
+	hi::Dson tree = make_tree(0);
+	std::vector<char> received(static_cast<std::size_t>(tree.data_size() + hi::DsonObj::header_size));
+	{
+		char * ptr = received.data();
+		std::int32_t size = static_cast<std::int32_t>(received.size());
+		tree.copy_to_buf_network_order(ptr, size);
+	}
+	std::vector<char> buf(received.size());
+	const std::int32_t received_size = static_cast<std::int32_t>(received.size());
+	std::int64_t sink{0};
+	std::cout << "tree: leaves " << fanout * fanout * fanout << ", data_size " << tree.data_size() << std::endl;
+	std::cout << std::fixed << std::setprecision(2);
+
+	auto to_buf = [&](hi::Dson & dson)
+	{
+		char * ptr = buf.data();
+		std::int32_t size = static_cast<std::int32_t>(buf.size());
+		dson.copy_to_buf_host_order(ptr, size);
+		sink += size + buf[20];
+	};
+	const double buf_parse = measure_us(
+		[&]
+		{
+			hi::Dson dson;
+			dson.load_from_buf(received.data(), received_size);
+			sink += static_cast<std::int64_t>(dson.map().size());
+			to_buf(dson);
+		});
+	const double buf_transcode = measure_us(
+		[&]
+		{
+			hi::Dson dson;
+			dson.load_from_buf(received.data(), received_size);
+			to_buf(dson);
+		});
+
+	const int fd = ::open("/dev/null", O_WRONLY);
+	const double fd_parse = measure_us(
+		[&]
+		{
+			hi::Dson dson;
+			dson.load_from_buf(received.data(), received_size);
+			sink += static_cast<std::int64_t>(dson.map().size());
+			sink += static_cast<std::int64_t>(dson.copy_to_fd_host_order(fd));
+		});
+	const double fd_transcode = measure_us(
+		[&]
+		{
+			hi::Dson dson;
+			dson.load_from_buf(received.data(), received_size);
+			sink += static_cast<std::int64_t>(dson.copy_to_fd_host_order(fd));
+		});
+	::close(fd);
+
+	std::cout << "us per forward (load + send):" << std::endl;
+	std::cout << std::setw(40) << "copy_to_buf parse + walk tree: " << buf_parse << std::endl;
+	std::cout << std::setw(40) << "copy_to_buf transcode: " << buf_transcode << std::endl;
+	std::cout << std::setw(40) << "copy_to_fd parse + walk tree: " << fd_parse << std::endl;
+	std::cout << std::setw(40) << "copy_to_fd transcode: " << fd_transcode << std::endl;
+	if (sink == 0)
+		std::cout << "";
+	std::cout << "Tests finished" << std::endl;
+	return 0;
+}
@@ -0,0 +1,140 @@
+/*
+ * This is the source code of thread_highways library
+ *
+ * Copyright (c) Dmitriy Bondarenko
+ * feel free to contact me: bondarenkoda@gmail.com
+ */
+
+#include <dson/dson.h>
+#include <dson/from_dson_converters.h>
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+namespace hi
+{
+namespace
+{
+
+std::vector<char> make_message(std::int32_t fields)
+{
+	Dson dson;
+	for (std::int32_t key = 0; key < fields; ++key)
+	{
+		dson.emplace(key, key * 10);
+	}
+	return dson.to_buf_host_order();
+}
+
+TEST(TestArena, ResetReusesMemory)
+{
+	DsonArena arena{1024};
+	void * first = arena.allocate(100);
+	ASSERT_NE(nullptr, first);
+	EXPECT_NE(nullptr, arena.allocate(100));
+	EXPECT_GE(arena.used(), 200u);
+	arena.reset();
+	EXPECT_EQ(0u, arena.used());
+	EXPECT_EQ(first, arena.allocate(100));
+}
+
+TEST(TestArena, GrowthMergedIntoOneBlock)
+{
+	DsonArena arena{64};
+	for (int i = 0; i < 10; ++i)
+	{
+		ASSERT_NE(nullptr, arena.allocate(50));
+	}
+	const auto capacity = arena.capacity();
+	arena.reset();
+	EXPECT_EQ(capacity, arena.capacity());
+	for (int i = 0; i < 10; ++i)
+	{
+		ASSERT_NE(nullptr, arena.allocate(50));
+	}
+	EXPECT_EQ(capacity, arena.capacity());
+}
+
+TEST(TestArena, DsonTreeInArena)
+{
+	auto arena = std::make_shared<DsonArena>();
+	Dson dson{arena};
+	auto message = make_message(20);
+	for (int round = 0; round < 3; ++round)
+	{
+		ASSERT_EQ(Result::Ready, dson.load_from_buf(message.data(), static_cast<std::int32_t>(message.size())));
+		for (std::int32_t key = 0; key < 20; ++key)
+		{
+			EXPECT_EQ(key * 10, to_int32(dson.get(key)));
+		}
+		EXPECT_GT(arena->used(), message.size());
+		dson.clear();
+		EXPECT_EQ(0u, arena->used());
+	}
+}
+
+TEST(TestArena, MovedMessageKeepsArenaAlive)
+{
+	auto arena = std::make_shared<DsonArena>();
+	Dson dson{arena};
+	auto message = make_message(5);
+	ASSERT_EQ(Result::Ready, dson.load_from_buf(message.data(), static_cast<std::int32_t>(message.size())));
+	EXPECT_EQ(40, to_int32(dson.get(4)));
+
+	Dson moved{std::move(dson)};
+	dson.clear();
+	// Память ещё используется смуванным сообщением
+	EXPECT_NE(0u, arena->used());
+	EXPECT_EQ(30, to_int32(moved.get(3)));
+	moved.emplace(100, 1);
+
+	moved.clear();
+	dson.clear();
+	EXPECT_EQ(0u, arena->used());
+}
+
+std::vector<char> make_string_message(char fill)
+{
+	Dson dson;
+	dson.emplace(1, std::string(100, fill));
+	dson.emplace(2, 7);
+	return dson.to_buf_host_order();
+}
+
+TEST(TestArena, ExtractedChildSurvivesReload)
+{
+	auto arena = std::make_shared<DsonArena>();
+	Dson dson{arena};
+	auto first = make_string_message('A');
+	auto second = make_string_message('Z');
+	ASSERT_EQ(Result::Ready, dson.load_from_buf(first.data(), static_cast<std::int32_t>(first.size())));
+
+	// Ребёнок - вьюха на буфер арены: уходит из сообщения вместе с занятой ареной
+	Dson kept = std::move(*dson_cast<Dson>(dson.get(1)));
+	Dson streamed;
+	auto stream_arena = std::make_shared<DsonArena>();
+	Dson loaded{stream_arena};
+	ASSERT_EQ(Result::Ready, loaded.load_from_buf(first.data(), static_cast<std::int32_t>(first.size())));
+	ASSERT_TRUE(loaded.next_loaded(streamed));
+
+	dson.clear();
+	loaded.clear();
+	EXPECT_TRUE(arena->is_borrowed());
+	EXPECT_TRUE(stream_arena->is_borrowed());
+	ASSERT_EQ(Result::Ready, dson.load_from_buf(second.data(), static_cast<std::int32_t>(second.size())));
+	EXPECT_EQ(std::string(100, 'Z'), to_string_view(dson, 1));
+	EXPECT_EQ(std::string(100, 'A'), to_string_view(&kept));
+	EXPECT_EQ(std::string(100, 'A'), to_string_view(&streamed));
+
+	kept.clear();
+	streamed.clear();
+	EXPECT_FALSE(arena->is_borrowed());
+	EXPECT_FALSE(stream_arena->is_borrowed());
+	dson.clear();
+	EXPECT_EQ(0u, arena->used());
+}
+
+} // namespace
+} // namespace hi
@@ -0,0 +1,146 @@
+/*
+ * This is the source code of thread_highways library
+ *
+ * Copyright (c) Dmitriy Bondarenko
+ * feel free to contact me: bondarenkoda@gmail.com
+ */
+
+#include "dson_test_io.h"
+
+#include <dson/dson.h>
+#include <dson/dson_broadcast.h>
+#include <dson/from_dson_converters.h>
+
+#include <gtest/gtest.h>
+
+#include <csignal>
+#include <string>
+#include <vector>
+
+namespace hi
+{
+namespace
+{
+
+Dson make_message(std::int32_t id)
+{
+	Dson dson;
+	dson.set_key(id);
+	dson.emplace(1, static_cast<std::uint32_t>(id));
+	dson.emplace(2, std::string(20000, static_cast<char>('a' + id)));
+	return dson;
+}
+
+class TestBroadcast : public ::testing::Test
+{
+protected:
+	static constexpr std::int32_t subscribers{3};
+
+	static constexpr auto mode{test::SocketPair::Mode::NonBlocking};
+	static constexpr int send_buf{test::SocketPair::small_send_buf};
+
+	test::SocketPair pairs_[subscribers]{
+		test::SocketPair{mode, send_buf},
+		test::SocketPair{mode, send_buf},
+		test::SocketPair{mode, send_buf}};
+	std::vector<char> received_[subscribers];
+};
+
+TEST_F(TestBroadcast, SameBytesForAllSubscribers)
+{
+	DsonBroadcast broadcast;
+	for (auto & pair : pairs_)
+	{
+		broadcast.add(pair.writer());
+	}
+	EXPECT_EQ(static_cast<std::size_t>(subscribers), broadcast.subscribers());
+
+	std::vector<char> expected;
+	for (std::int32_t id = 0; id < 5; ++id)
+	{
+		Dson message = make_message(id);
+		const DsonFrame frame = DsonFrame::encode_network_order(message);
+		ASSERT_FALSE(frame.empty());
+		expected.insert(expected.end(), frame.data(), frame.data() + frame.size());
+		broadcast.publish(frame);
+	}
+
+	Result result{Result::InProcess};
+	while (result == Result::InProcess)
+	{
+		for (std::int32_t i = 0; i < subscribers; ++i)
+		{
+			pairs_[i].drain(received_[i]);
+		}
+		result = broadcast.flush();
+	}
+	ASSERT_EQ(Result::Ready, result);
+	for (std::int32_t i = 0; i < subscribers; ++i)
+	{
+		pairs_[i].drain(received_[i]);
+		EXPECT_EQ(expected, received_[i]);
+	}
+
+	// Кадры разбираются обратно
+	char * ptr = received_[0].data();
+	std::int32_t size = static_cast<std::int32_t>(received_[0].size());
+	Dson loaded;
+	for (std::int32_t id = 0; id < 5; ++id)
+	{
+		std::int32_t consumed{0};
+		ASSERT_EQ(Result::Ready, loaded.load_from_buf(ptr, size, consumed));
+		EXPECT_EQ(static_cast<std::uint32_t>(id), to_uint32(loaded, 1));
+		ptr += consumed;
+		size -= consumed;
+	}
+}
+
+TEST_F(TestBroadcast, FrameSharedNotCopied)
+{
+	Dson message = make_message(1);
+	DsonFrame frame = DsonFrame::encode_network_order(message);
+	EXPECT_EQ(message.data_size() + DsonObj::header_size, frame.size());
+	// исходный Dson не изменился
+	EXPECT_TRUE(message.is_host_order());
+
+	DsonFdQueue first{pairs_[0].writer()};
+	DsonFdQueue second{pairs_[1].writer()};
+	for (std::int32_t i = 0; i < 10; ++i)
+	{
+		first.push(frame);
+		second.push(frame);
+	}
+	EXPECT_EQ(21, frame.use_count());
+	EXPECT_EQ(Result::InProcess, first.write());
+	while (first.write() != Result::Ready)
+	{
+		pairs_[0].drain(received_[0]);
+	}
+	EXPECT_TRUE(first.empty());
+	EXPECT_EQ(11, frame.use_count());
+}
+
+TEST_F(TestBroadcast, FailedSubscriberRemoved)
+{
+	// запись в закрытый сокет: EPIPE вместо завершения процесса
+	::signal(SIGPIPE, SIG_IGN);
+	DsonBroadcast broadcast;
+	broadcast.add(pairs_[0].writer());
+	broadcast.add(pairs_[1].writer());
+	// подписчик отключился
+	pairs_[1].close_reader();
+
+	Dson message = make_message(2);
+	broadcast.publish(message);
+	while (broadcast.flush() == Result::InProcess)
+	{
+		pairs_[0].drain(received_[0]);
+	}
+	EXPECT_EQ(1u, broadcast.subscribers());
+	const auto failed = broadcast.take_failed();
+	ASSERT_EQ(1u, failed.size());
+	EXPECT_EQ(pairs_[1].writer(), failed[0]);
+}
+
+} // namespace
+} // namespace hi
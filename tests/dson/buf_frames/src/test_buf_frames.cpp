@@ -0,0 +1,160 @@
+/*
+ * This is the source code of thread_highways library
+ *
+ * Copyright (c) Dmitriy Bondarenko
+ * feel free to contact me: bondarenkoda@gmail.com
+ */
+
+#include "dson_test_io.h"
+
+#include <dson/dson.h>
+#include <dson/from_dson_converters.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace hi
+{
+namespace
+{
+
+Dson make_frame(std::int32_t key)
+{
+	Dson dson;
+	dson.set_key(key);
+	dson.emplace(1, static_cast<std::uint32_t>(key));
+	dson.emplace(2, std::string(static_cast<std::size_t>(key * 7), 'x'));
+	return dson;
+}
+
+// Несколько Dson подряд в одном буфере
+std::vector<char> make_stream(std::int32_t count)
+{
+	std::vector<char> re;
+	for (std::int32_t key = 0; key < count; ++key)
+	{
+		Dson dson = make_frame(key);
+		const std::size_t offset = re.size();
+		re.resize(offset + static_cast<std::size_t>(dson.data_size() + DsonObj::header_size));
+		char * ptr = re.data() + offset;
+		std::int32_t size = static_cast<std::int32_t>(re.size() - offset);
+		const Result result = key % 2 ? dson.copy_to_buf_network_order(ptr, size) : dson.copy_to_buf_host_order(ptr, size);
+		EXPECT_EQ(Result::Ready, result);
+	}
+	return re;
+}
+
+void check(Dson & dson, std::int32_t key)
+{
+	EXPECT_EQ(key, dson.key());
+	EXPECT_EQ(static_cast<std::uint32_t>(key), to_uint32(dson, 1));
+	EXPECT_EQ(std::string(static_cast<std::size_t>(key * 7), 'x'), to_string_view(dson, 2));
+}
+
+TEST(TestBufFrames, WholeBufferZeroCopy)
+{
+	constexpr std::int32_t count{10};
+	std::vector<char> stream = make_stream(count);
+	char * buf = stream.data();
+	std::int32_t buf_size = static_cast<std::int32_t>(stream.size());
+
+	Dson dson;
+	for (std::int32_t key = 0; key < count; ++key)
+	{
+		std::int32_t consumed{0};
+		ASSERT_EQ(Result::Ready, dson.load_from_buf(buf, buf_size, consumed));
+		// вьюха на окно: данные не копировались
+		EXPECT_EQ(buf + DsonObj::header_size, static_cast<char *>(dson.data()));
+		EXPECT_EQ(dson.data_size() + DsonObj::header_size, consumed);
+		check(dson, key);
+		buf += consumed;
+		buf_size -= consumed;
+	}
+	EXPECT_EQ(0, buf_size);
+}
+
+TEST(TestBufFrames, FramesCrossWindowBoundary)
+{
+	constexpr std::int32_t count{20};
+	const std::vector<char> stream = make_stream(count);
+
+	for (const std::int32_t window_size : {5, 16, 40, 97, 1000})
+	{
+		std::vector<char> window(static_cast<std::size_t>(window_size));
+		std::size_t stream_offset{0};
+		std::int32_t next_key{0};
+		Dson dson;
+		while (stream_offset < stream.size())
+		{
+			// Окно перезаписывается очередным куском (как кольцо shared mem)
+			const std::size_t len = std::min(window.size(), stream.size() - stream_offset);
+			std::memcpy(window.data(), stream.data() + stream_offset, len);
+			char * buf = window.data();
+			std::int32_t buf_size = static_cast<std::int32_t>(len);
+			while (buf_size)
+			{
+				std::int32_t consumed{0};
+				const Result result = dson.load_from_buf(buf, buf_size, consumed);
+				ASSERT_NE(Result::Error, result);
+				ASSERT_LT(0, consumed);
+				buf += consumed;
+				buf_size -= consumed;
+				if (result == Result::Ready)
+				{
+					check(dson, next_key++);
+				}
+			}
+			stream_offset += len;
+		}
+		EXPECT_EQ(count, next_key) << window_size;
+	}
+}
+
+TEST(TestBufFrames, ForwardFrameView)
+{
+	// Вьюха на кадр пересылается дальше целиком (в том числе после загрузки предыдущего кадра)
+	constexpr std::int32_t count{4};
+	std::vector<char> stream = make_stream(count);
+	char * buf = stream.data();
+	std::int32_t buf_size = static_cast<std::int32_t>(stream.size());
+
+	test::SocketPair pair;
+	Dson dson;
+	for (std::int32_t key = 0; key < count; ++key)
+	{
+		std::int32_t consumed{0};
+		ASSERT_EQ(Result::Ready, dson.load_from_buf(buf, buf_size, consumed));
+		Dson frame = make_frame(key);
+		for (const bool network_order : {false, true})
+		{
+			const std::vector<char> expected = test::to_buf(frame, network_order);
+			EXPECT_EQ(expected, test::to_buf(dson, network_order)) << key;
+			const auto sent = pair.transfer(
+				[&](std::int32_t fd)
+				{
+					return network_order ? dson.copy_to_fd_network_order(fd) : dson.copy_to_fd_host_order(fd);
+				});
+			ASSERT_EQ(Result::Ready, sent.result);
+			EXPECT_EQ(expected, sent.received) << key;
+		}
+		check(dson, key);
+		buf += consumed;
+		buf_size -= consumed;
+	}
+}
+
+TEST(TestBufFrames, CorruptedHeader)
+{
+	std::vector<char> stream(64, '\x7f');
+	Dson dson;
+	std::int32_t consumed{-1};
+	EXPECT_EQ(Result::Error, dson.load_from_buf(stream.data(), static_cast<std::int32_t>(stream.size()), consumed));
+	EXPECT_EQ(0, consumed);
+}
+
+} // namespace
+} // namespace hi
@@ -0,0 +1,115 @@
+/*
+ * This is the source code of thread_highways library
+ *
+ * Copyright (c) Dmitriy Bondarenko
+ * feel free to contact me: bondarenkoda@gmail.com
+ */
+
+#include <dson/dson.h>
+#include <dson/from_dson_converters.h>
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <vector>
+
+namespace hi
+{
+namespace
+{
+
+std::vector<ByteSwap32Fn> available_kernels()
+{
+	std::vector<ByteSwap32Fn> re{&byte_swap32_scalar};
+#ifdef DSON_X86_SIMD
+	const CpuFeatures cpu = CpuFeatures::detect();
+	if (cpu.sse2_)
+		re.push_back(&byte_swap32_sse2);
+	if (cpu.ssse3_)
+		re.push_back(&byte_swap32_ssse3);
+	if (cpu.avx2_)
+		re.push_back(&byte_swap32_avx2);
+#endif
+	return re;
+}
+
+TEST(TestByteSwap, KernelsMatchNtohl)
+{
+	for (const auto kernel : available_kernels())
+	{
+		// все хвосты и невыровненные адреса
+		for (std::size_t count = 0; count < 70; ++count)
+		{
+			for (std::size_t shift = 0; shift < 4; ++shift)
+			{
+				std::vector<char> raw(count * sizeof(std::uint32_t) + shift);
+				for (std::size_t i = 0; i < raw.size(); ++i)
+				{
+					raw[i] = static_cast<char>(i * 7 + 1);
+				}
+				// при count == 0 data() пустого вектора может быть nullptr: memcpy не вызывается
+				std::vector<std::uint32_t> expected(count);
+				if (count)
+					std::memcpy(expected.data(), raw.data() + shift, count * sizeof(std::uint32_t));
+				for (auto & it : expected)
+				{
+					it = ntohl(it);
+				}
+				kernel(reinterpret_cast<std::uint32_t *>(raw.data() + shift), count);
+				std::vector<std::uint32_t> result(count);
+				if (count)
+					std::memcpy(result.data(), raw.data() + shift, count * sizeof(std::uint32_t));
+				ASSERT_EQ(expected, result) << "count " << count << " shift " << shift;
+			}
+		}
+	}
+}
+
+TEST(TestByteSwap, Header)
+{
+	std::uint32_t header[4]{1, 2, 0x01020304, 0xA0B0C0D0};
+	header_network_host(header);
+	EXPECT_EQ(htonl(1u), header[0]);
+	EXPECT_EQ(htonl(2u), header[1]);
+	EXPECT_EQ(htonl(0x01020304u), header[2]);
+	EXPECT_EQ(htonl(0xA0B0C0D0u), header[3]);
+	header_network_host(header);
+	EXPECT_EQ(0x01020304u, header[2]);
+}
+
+TEST(TestByteSwap, Uint32ArrayRoundTrip)
+{
+	constexpr std::uint32_t count{1001};
+	Dson array;
+	auto data = static_cast<std::uint32_t *>(
+		array.init(1, types_map<std::vector<std::uint32_t>>::value, count * sizeof(std::uint32_t)));
+	ASSERT_NE(nullptr, data);
+	for (std::uint32_t i = 0; i < count; ++i)
+	{
+		data[i] = i * 0x01010101u;
+	}
+	Dson dson;
+	dson.emplace(1, std::move(array));
+	std::vector<char> buf(static_cast<std::size_t>(dson.data_size() + DsonObj::header_size));
+	char * ptr = buf.data();
+	std::int32_t size = static_cast<std::int32_t>(buf.size());
+	ASSERT_EQ(Result::Ready, dson.copy_to_buf_network_order(ptr, size));
+
+	// в буфере network order
+	std::uint32_t first_network;
+	std::memcpy(&first_network, buf.data() + 2 * DsonObj::header_size + sizeof(std::uint32_t), sizeof(first_network));
+	EXPECT_EQ(htonl(0x01010101u), first_network);
+
+	Dson loaded;
+	ASSERT_EQ(Result::Ready, loaded.load_from_buf(buf.data(), static_cast<std::int32_t>(buf.size())));
+	auto obj = dynamic_cast<Dson *>(loaded.get(1));
+	ASSERT_NE(nullptr, obj);
+	auto loaded_data = static_cast<std::uint32_t *>(obj->data());
+	for (std::uint32_t i = 0; i < count; ++i)
+	{
+		ASSERT_EQ(i * 0x01010101u, loaded_data[i]);
+	}
+}
+
+} // namespace
+} // namespace hi
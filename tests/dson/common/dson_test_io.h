@@ -0,0 +1,194 @@
+/*
+ * This is the source code of thread_highways library
+ *
+ * Copyright (c) Dmitriy Bondarenko
+ * feel free to contact me: bondarenkoda@gmail.com
+ */
+
+#ifndef DSON_TEST_IO_H
+#define DSON_TEST_IO_H
+
+#include <dson/dson.h>
+
+#include <gtest/gtest.h>
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <vector>
+
+/*
+ * Общие для тестов помощники ввода-вывода:
+ * выгрузка в std::vector и пара сокетов с вычитыванием того, что в неё выгружено
+ */
+namespace hi
+{
+namespace test
+{
+
+/**
+ * @brief to_buf
+ * Выгрузка obj (Dson, DsonEnum, ...) в буфер целиком
+ * @param window - выгружать окнами по window байт (0 - одним окном)
+ */
+template <typename T>
+std::vector<char> to_buf(T & obj, const bool network_order, std::int32_t window = 0)
+{
+	std::vector<char> re(static_cast<std::size_t>(obj.data_size() + DsonObj::header_size));
+	char * ptr = re.data();
+	std::int32_t left = static_cast<std::int32_t>(re.size());
+	if (!window)
+		window = left;
+	Result result{Result::InProcess};
+	while (result == Result::InProcess)
+	{
+		std::int32_t size = std::min(window, left);
+		const std::int32_t before = size;
+		result = network_order ? obj.copy_to_buf_network_order(ptr, size) : obj.copy_to_buf_host_order(ptr, size);
+		left -= before - size;
+	}
+	EXPECT_EQ(Result::Ready, result);
+	EXPECT_EQ(0, left);
+	return re;
+}
+
+/*
+ * Соединённая пара сокетов: тестируемый объект пишет в writer(), читается reader().
+ * Сокеты закрываются в деструкторе.
+ */
+class SocketPair
+{
+public:
+	enum class Mode
+	{
+		// Выгрузка copy_to_fd_* в цикле с вычитыванием (transfer())
+		NonBlocking,
+		// Отправка из потока (send()), загрузка load_from_fd() в цикле
+		BlockingWriter,
+		// Оба конца блокирующие (receive())
+		Blocking
+	};
+
+	// маленький буфер сокета => много частичных записей
+	static constexpr int small_send_buf{4096};
+
+	explicit SocketPair(const Mode mode = Mode::NonBlocking, const int send_buf_size = 0)
+	{
+		int fds[2];
+		EXPECT_EQ(0, ::socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+		writer_ = fds[0];
+		reader_ = fds[1];
+		if (send_buf_size)
+			::setsockopt(writer_, SOL_SOCKET, SO_SNDBUF, &send_buf_size, sizeof(send_buf_size));
+		if (mode == Mode::NonBlocking)
+			::fcntl(writer_, F_SETFL, ::fcntl(writer_, F_GETFL) | O_NONBLOCK);
+		if (mode != Mode::Blocking)
+			::fcntl(reader_, F_SETFL, ::fcntl(reader_, F_GETFL) | O_NONBLOCK);
+	}
+
+	SocketPair(const SocketPair &) = delete;
+	SocketPair & operator=(const SocketPair &) = delete;
+
+	~SocketPair()
+	{
+		if (writer_ >= 0)
+			::close(writer_);
+		if (reader_ >= 0)
+			::close(reader_);
+	}
+
+	int writer() const noexcept
+	{
+		return writer_;
+	}
+
+	int reader() const noexcept
+	{
+		return reader_;
+	}
+
+	// Второй конец отключился: запись в writer() завершается ошибкой
+	void close_reader()
+	{
+		::close(reader_);
+		reader_ = -1;
+	}
+
+	// Вычитать всё, что уже пришло в reader()
+	void drain(std::vector<char> & received)
+	{
+		char buf[8192];
+		for (;;)
+		{
+			const auto readed = read_from_fd(reader_, buf, sizeof(buf));
+			if (readed <= 0)
+				break;
+			received.insert(received.end(), buf, buf + readed);
+		}
+	}
+
+	struct Transferred
+	{
+		Result result;
+		// Сколько раз выгрузка вернула InProcess (буфер сокета был заполнен)
+		std::int32_t in_process;
+		std::vector<char> received;
+	};
+
+	/**
+	 * @brief transfer
+	 * Вызов copy(writer()) до завершения выгрузки с вычитыванием из reader()
+	 */
+	template <typename F>
+	Transferred transfer(F && copy)
+	{
+		Transferred re{Result::InProcess, 0, {}};
+		while (re.result == Result::InProcess)
+		{
+			re.result = copy(writer_);
+			if (re.result == Result::InProcess)
+				++re.in_process;
+			drain(re.received);
+		}
+		return re;
+	}
+
+	// Отправка bytes[offset, end) целиком (блокирующий writer())
+	void send(const std::vector<char> & bytes, std::size_t offset, const std::size_t end)
+	{
+		while (offset < end)
+		{
+			const auto writed = ::write(writer_, bytes.data() + offset, end - offset);
+			if (writed <= 0)
+				return;
+			offset += static_cast<std::size_t>(writed);
+		}
+	}
+
+	// Чтение ровно size байт (блокирующий reader())
+	std::vector<char> receive(const std::size_t size)
+	{
+		std::vector<char> re(size);
+		std::size_t got{0};
+		while (got < size)
+		{
+			const auto readed = ::read(reader_, re.data() + got, size - got);
+			if (readed <= 0)
+				break;
+			got += static_cast<std::size_t>(readed);
+		}
+		re.resize(got);
+		return re;
+	}
+
+private:
+	int writer_{-1};
+	int reader_{-1};
+};
+
+} // namespace test
+} // namespace hi
+
+#endif // DSON_TEST_IO_H
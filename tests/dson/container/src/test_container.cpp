@@ -0,0 +1,125 @@
+/*
+ * This is the source code of thread_highways library
+ *
+ * Copyright (c) Dmitriy Bondarenko
+ * feel free to contact me: bondarenkoda@gmail.com
+ */
+
+#include <dson/dson.h>
+#include <dson/from_dson_converters.h>
+
+#include <gtest/gtest.h>
+
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace hi
+{
+namespace
+{
+
+TEST(TestContainer, FlatMapKeepsKeysSorted)
+{
+	FlatMap<std::int32_t, std::int32_t> map;
+	for (const std::int32_t key : {7, 3, 100, -5, 3, 42, 0})
+	{
+		map.insert_or_assign(key, key * 2);
+	}
+	// дубликат 3 заменился, а не добавился
+	EXPECT_EQ(6u, map.size());
+	std::int32_t prev = std::numeric_limits<std::int32_t>::lowest();
+	for (const auto & [key, value] : map)
+	{
+		EXPECT_LT(prev, key);
+		EXPECT_EQ(key * 2, value);
+		prev = key;
+	}
+	EXPECT_NE(map.end(), map.find(42));
+	EXPECT_EQ(map.end(), map.find(41));
+	EXPECT_EQ(1u, map.erase(42));
+	EXPECT_EQ(map.end(), map.find(42));
+}
+
+TEST(TestContainer, FlatMapBinarySearch)
+{
+	FlatMap<std::int32_t, std::int32_t> map;
+	for (std::int32_t key = 1000; key > 0; key -= 3)
+	{
+		map.insert_or_assign(key, key);
+	}
+	for (std::int32_t key = 1000; key > 0; --key)
+	{
+		const auto it = map.find(key);
+		if ((1000 - key) % 3 == 0)
+		{
+			ASSERT_NE(map.end(), it);
+			EXPECT_EQ(key, it->second);
+		}
+		else
+		{
+			EXPECT_EQ(map.end(), it);
+		}
+	}
+}
+
+TEST(TestContainer, FlatMapStdMapLookups)
+{
+	Dson dson;
+	dson.emplace(3, std::uint32_t{30});
+	auto & map = dson.map();
+	EXPECT_EQ(1u, map.count(3));
+	EXPECT_EQ(0u, map.count(4));
+	EXPECT_TRUE(map.contains(3));
+	EXPECT_FALSE(map.contains(4));
+	EXPECT_EQ(30u, to_uint32(map.at(3).get()));
+	EXPECT_THROW(map.at(4), std::out_of_range);
+}
+
+TEST(TestContainer, DsonEmplaceGetReplace)
+{
+	Dson dson;
+	for (std::int32_t key = 30; key >= 0; --key)
+	{
+		dson.emplace(key, key);
+	}
+	dson.emplace(5, std::uint32_t{12345});
+	EXPECT_EQ(31u, dson.map().size());
+	EXPECT_EQ(12345u, to_uint32(dson.get(5)));
+	EXPECT_EQ(17, to_int32(dson.get(17)));
+	EXPECT_EQ(nullptr, dson.get(31));
+}
+
+TEST(TestContainer, DsonResumableCopyToSmallBuf)
+{
+	Dson dson;
+	for (std::int32_t key = 0; key < 20; ++key)
+	{
+		dson.emplace(key, std::to_string(key));
+	}
+	const std::vector<char> expected = dson.to_buf_host_order();
+
+	// Выгрузка маленькими окнами: итерация по детям должна возобновляться
+	std::vector<char> received;
+	char window[7];
+	Result result{Result::InProcess};
+	while (result == Result::InProcess)
+	{
+		char * ptr = window;
+		std::int32_t size{sizeof(window)};
+		result = dson.copy_to_buf_network_order(ptr, size);
+		received.insert(received.end(), window, ptr);
+	}
+	ASSERT_EQ(Result::Ready, result);
+	ASSERT_EQ(expected.size(), received.size());
+
+	Dson loaded;
+	ASSERT_EQ(Result::Ready, loaded.load_from_buf(received.data(), static_cast<std::int32_t>(received.size())));
+	for (std::int32_t key = 0; key < 20; ++key)
+	{
+		EXPECT_EQ(std::to_string(key), to_string_view(loaded.get(key)));
+	}
+}
+
+} // namespace
+} // namespace hi
@@ -0,0 +1,121 @@
+/*
+ * This is the source code of thread_highways library
+ *
+ * Copyright (c) Dmitriy Bondarenko
+ * feel free to contact me: bondarenkoda@gmail.com
+ */
+
+#include "dson_test_io.h"
+
+#include <dson/dson.h>
+#include <dson/from_dson_converters.h>
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+namespace hi
+{
+namespace
+{
+
+constexpr TypeMarker sparse_type{54322};
+
+TEST(TestConverters, BuiltinTypesUseFunctionPointers)
+{
+	auto & converters = Dson::converters();
+	for (const TypeMarker type :
+		 {types_map<std::int32_t>::value,
+		  types_map<std::uint32_t>::value,
+		  types_map<std::int64_t>::value,
+		  types_map<std::uint64_t>::value,
+		  types_map<double>::value,
+		  types_map<std::vector<std::uint32_t>>::value})
+	{
+		auto to_host = converters.dispatch<false>(type);
+		ASSERT_NE(nullptr, to_host);
+		EXPECT_NE(nullptr, to_host->fn_);
+		auto to_network = converters.dispatch<true>(type);
+		ASSERT_NE(nullptr, to_network);
+		EXPECT_NE(nullptr, to_network->fn_);
+	}
+	// Строки не преобразуются
+	EXPECT_EQ(nullptr, converters.dispatch<false>(types_map<std::string>::value));
+}
+
+TEST(TestConverters, BuiltinRoundTrip)
+{
+	Dson dson;
+	dson.emplace(1, std::uint32_t{0x01020304});
+	dson.emplace(2, std::int32_t{-5});
+	dson.emplace(3, -0.125);
+	std::vector<char> buf = test::to_buf(dson, true);
+
+	Dson loaded;
+	ASSERT_EQ(Result::Ready, loaded.load_from_buf(buf.data(), static_cast<std::int32_t>(buf.size())));
+	EXPECT_EQ(0x01020304u, to_uint32(loaded.get(1)));
+	EXPECT_EQ(-5, to_int32(loaded.get(2)));
+	EXPECT_DOUBLE_EQ(-0.125, to_double(loaded.get(3)));
+}
+
+TEST(TestConverters, SparseUserTypeWithCapture)
+{
+	auto & converters = Dson::converters();
+	std::int32_t to_host_calls{0};
+	std::int32_t to_network_calls{0};
+	converters.register_converter(
+		sparse_type,
+		[&](Dson::Header & header, char * data)
+		{
+			++to_host_calls;
+			Dson::Converters::uint32_to_host(header, data);
+		},
+		[&](Dson::Header & header, char * data)
+		{
+			++to_network_calls;
+			Dson::Converters::uint32_to_network(header, data);
+		});
+	auto dispatch = converters.dispatch<false>(sparse_type);
+	ASSERT_NE(nullptr, dispatch);
+	EXPECT_EQ(nullptr, dispatch->fn_);
+	EXPECT_NE(nullptr, dispatch->function_);
+
+	Dson user;
+	auto data = static_cast<std::uint32_t *>(user.init(7, sparse_type, sizeof(std::uint32_t)));
+	ASSERT_NE(nullptr, data);
+	*data = 0xAABBCCDD;
+	Dson container;
+	container.emplace(7, std::move(user));
+	std::vector<char> buf = test::to_buf(container, true);
+	EXPECT_EQ(1, to_network_calls);
+
+	Dson loaded;
+	ASSERT_EQ(Result::Ready, loaded.load_from_buf(buf.data(), static_cast<std::int32_t>(buf.size())));
+	auto obj = dynamic_cast<Dson *>(loaded.get(7));
+	ASSERT_NE(nullptr, obj);
+	EXPECT_EQ(1, to_host_calls);
+	EXPECT_EQ(0xAABBCCDDu, *static_cast<std::uint32_t *>(obj->data()));
+
+	converters.remove_converter(sparse_type);
+	EXPECT_EQ(nullptr, converters.dispatch<false>(sparse_type));
+}
+
+TEST(TestConverters, ReplacedConverterIsDispatchedAtOnce)
+{
+	auto & converters = Dson::converters();
+	converters.register_converter(sparse_type, &Dson::Converters::uint32_to_host, &Dson::Converters::uint32_to_network);
+	auto dispatch = converters.dispatch<true>(sparse_type);
+	ASSERT_NE(nullptr, dispatch);
+	EXPECT_EQ(&Dson::Converters::uint32_to_network, dispatch->fn_);
+
+	converters.register_converter(sparse_type, &Dson::Converters::uint64_to_host, &Dson::Converters::uint64_to_network);
+	dispatch = converters.dispatch<true>(sparse_type);
+	ASSERT_NE(nullptr, dispatch);
+	EXPECT_EQ(&Dson::Converters::uint64_to_network, dispatch->fn_);
+
+	converters.remove_converter(sparse_type);
+	EXPECT_EQ(nullptr, converters.dispatch<true>(sparse_type));
+}
+
+} // namespace
+} // namespace hi
@@ -0,0 +1,184 @@
+/*
+ * This is the source code of thread_highways library
+ *
+ * Copyright (c) Dmitriy Bondarenko
+ * feel free to contact me: bondarenkoda@gmail.com
+ */
+
+#include <dson/dson.h>
+#include <dson/from_dson_converters.h>
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+namespace hi
+{
+namespace
+{
+
+// Объект, размер которого меняется без ведома контейнера
+class ResizableObj : public DsonObj
+{
+public:
+	explicit ResizableObj(const DsonKey key)
+		: key_{key}
+	{
+	}
+
+	std::int32_t size_{4};
+
+public: // DsonObj
+	bool is_host_order() const noexcept override
+	{
+		return true;
+	}
+	bool is_network_order() const noexcept override
+	{
+		return false;
+	}
+	std::int32_t data_size() const noexcept override
+	{
+		return size_;
+	}
+	DsonKey key() const noexcept override
+	{
+		return key_;
+	}
+	void set_key(DsonKey key) noexcept override
+	{
+		key_ = key;
+	}
+	TypeMarker data_type() const noexcept override
+	{
+		return types_map<std::string>::value;
+	}
+	void copy_to_stream_host_order(std::ostream &) override
+	{
+	}
+	void copy_to_stream_network_order(std::ostream &) override
+	{
+	}
+	Result copy_to_fd_host_order(std::int32_t) override
+	{
+		return Result::Error;
+	}
+	Result copy_to_fd_network_order(std::int32_t) override
+	{
+		return Result::Error;
+	}
+	Result copy_to_buf_host_order(char *&, std::int32_t &) override
+	{
+		return Result::Error;
+	}
+	Result copy_to_buf_network_order(char *&, std::int32_t &) override
+	{
+		return Result::Error;
+	}
+	State state() const noexcept override
+	{
+		return State::Ready;
+	}
+	void reset_state() noexcept override
+	{
+	}
+
+private:
+	DsonKey key_;
+};
+
+constexpr std::int32_t header_size = DsonObj::header_size;
+
+TEST(TestDataSizeCache, NestedEmplaceInvalidatesParents)
+{
+	Dson root;
+	Dson level1;
+	Dson level2;
+	level2.emplace(0, std::uint32_t{1});
+	level1.emplace(0, std::move(level2));
+	root.emplace(0, std::move(level1));
+	root.emplace(1, std::string{"abc"});
+	const std::int32_t before = root.data_size();
+	EXPECT_EQ(3 * header_size + 4 + header_size + 3, before);
+
+	auto l1 = dynamic_cast<Dson *>(root.get(0));
+	ASSERT_NE(nullptr, l1);
+	auto l2 = dynamic_cast<Dson *>(l1->get(0));
+	ASSERT_NE(nullptr, l2);
+	l2->emplace(1, std::string{"12345"});
+	EXPECT_EQ(before + header_size + 5, root.data_size());
+
+	// Замена ребёнка
+	l2->emplace(1, std::string{"1"});
+	EXPECT_EQ(before + header_size + 1, root.data_size());
+
+	// Очистка и загрузка вложенного объекта
+	l1->clear();
+	EXPECT_EQ(header_size + header_size + 3, root.data_size());
+}
+
+TEST(TestDataSizeCache, MovedContainerKeepsTracking)
+{
+	Dson inner;
+	inner.emplace(0, std::uint32_t{1});
+	Dson root;
+	root.emplace(7, std::move(inner));
+	Dson moved{std::move(root)};
+	const std::int32_t before = moved.data_size();
+
+	auto child = dynamic_cast<Dson *>(moved.get(7));
+	ASSERT_NE(nullptr, child);
+	child->emplace(1, std::uint32_t{2});
+	EXPECT_EQ(before + header_size + 4, moved.data_size());
+}
+
+TEST(TestDataSizeCache, VolatileChildIsRecounted)
+{
+	Dson root;
+	Dson inner;
+	auto obj = std::make_unique<ResizableObj>(1);
+	ResizableObj * raw = obj.get();
+	inner.emplace(std::move(obj));
+	root.emplace(0, std::move(inner));
+	root.emplace(1, std::uint32_t{5});
+	EXPECT_FALSE(root.is_data_size_fixed());
+	const std::int32_t before = root.data_size();
+
+	raw->size_ = 100;
+	EXPECT_EQ(before + 96, root.data_size());
+
+	// Без изменчивых детей размер снова кэшируется
+	auto child = dynamic_cast<Dson *>(root.get(0));
+	ASSERT_NE(nullptr, child);
+	child->emplace(1, std::uint32_t{1});
+	EXPECT_TRUE(root.is_data_size_fixed());
+	EXPECT_EQ(header_size + header_size + 4 + header_size + 4, root.data_size());
+}
+
+TEST(TestDataSizeCache, SerializedSizeMatches)
+{
+	Dson root;
+	for (std::int32_t i = 0; i < 10; ++i)
+	{
+		Dson inner;
+		for (std::int32_t j = 0; j < 10; ++j)
+		{
+			inner.emplace(j, std::to_string(i * j));
+		}
+		root.emplace(i, std::move(inner));
+	}
+	EXPECT_EQ(static_cast<std::size_t>(root.data_size() + header_size), root.to_buf_host_order().size());
+	auto child = dynamic_cast<Dson *>(root.get(3));
+	ASSERT_NE(nullptr, child);
+	child->emplace(100, std::string(1000, 'x'));
+	const std::vector<char> buf = root.to_buf_host_order();
+	EXPECT_EQ(static_cast<std::size_t>(root.data_size() + header_size), buf.size());
+
+	Dson loaded;
+	std::vector<char> copy = buf;
+	ASSERT_EQ(Result::Ready, loaded.load_from_buf(copy.data(), static_cast<std::int32_t>(copy.size())));
+	EXPECT_EQ(root.data_size(), loaded.data_size());
+}
+
+} // namespace
+} // namespace hi
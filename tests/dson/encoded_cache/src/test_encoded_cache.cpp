@@ -0,0 +1,216 @@
+/*
+ * This is the source code of thread_highways library
+ *
+ * Copyright (c) Dmitriy Bondarenko
+ * feel free to contact me: bondarenkoda@gmail.com
+ */
+
+#include "dson_test_io.h"
+
+#include <dson/include_all.h>
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace hi
+{
+namespace
+{
+
+Dson make_state()
+{
+	Dson dson;
+	dson.set_key(9);
+	dson.emplace(1, std::uint32_t{100});
+	dson.emplace(2, std::string(3000, 's'));
+	Dson inner;
+	inner.emplace(1, std::uint32_t{7});
+	inner.emplace(2, std::string{"inner"});
+	dson.emplace(3, std::move(inner));
+	return dson;
+}
+
+// Поменять значение листа в обход Dson (кэш об этом не знает)
+void poke_uint32(Dson & dson, std::int32_t key, std::uint32_t value)
+{
+	auto leaf = dynamic_cast<Dson *>(dson.get(key));
+	ASSERT_NE(nullptr, leaf);
+	std::memcpy(leaf->data(), &value, sizeof(value));
+}
+
+TEST(TestEncodedCache, SameBytesAsWithoutCache)
+{
+	Dson plain = make_state();
+	Dson cached = make_state();
+	cached.cache_encoded();
+	EXPECT_TRUE(cached.is_encoded_cached());
+	for (int i = 0; i < 2; ++i)
+	{
+		EXPECT_EQ(test::to_buf(plain, true), test::to_buf(cached, true));
+		EXPECT_EQ(test::to_buf(plain, false), test::to_buf(cached, false));
+	}
+
+	std::stringstream plain_stream;
+	std::stringstream cached_stream;
+	plain.copy_to_stream_network_order(plain_stream);
+	cached.copy_to_stream_network_order(cached_stream);
+	EXPECT_EQ(plain_stream.str(), cached_stream.str());
+}
+
+TEST(TestEncodedCache, RepeatedSendUsesCache)
+{
+	Dson dson = make_state();
+	dson.cache_encoded();
+	const auto before = test::to_buf(dson, true);
+
+	// Изменение в обход Dson не видно: выгружается кэш
+	poke_uint32(dson, 1, 200);
+	EXPECT_EQ(before, test::to_buf(dson, true));
+
+	dson.invalidate_encoded();
+	const auto after = test::to_buf(dson, true);
+	EXPECT_NE(before, after);
+
+	// буфер переживает вьюху
+	std::vector<char> frame = after;
+	Dson loaded;
+	std::int32_t consumed{0};
+	ASSERT_EQ(Result::Ready, loaded.load_from_buf(frame.data(), static_cast<std::int32_t>(frame.size()), consumed));
+	EXPECT_EQ(200u, to_uint32(loaded, 1));
+}
+
+TEST(TestEncodedCache, MutationsInvalidate)
+{
+	Dson dson = make_state();
+	dson.cache_encoded();
+	auto bytes = test::to_buf(dson, true);
+
+	dson.emplace(4, std::uint32_t{4});
+	auto next = test::to_buf(dson, true);
+	EXPECT_NE(bytes, next);
+	bytes = next;
+
+	dson.set_key(10);
+	next = test::to_buf(dson, true);
+	EXPECT_NE(bytes, next);
+	bytes = next;
+
+	// Изменение вложенного Dson доходит до корня через parent_
+	auto inner = dynamic_cast<Dson *>(dson.get(3));
+	ASSERT_NE(nullptr, inner);
+	inner->emplace(3, std::uint32_t{3});
+	next = test::to_buf(dson, true);
+	EXPECT_NE(bytes, next);
+	bytes = next;
+
+	inner->set_key(30);
+	next = test::to_buf(dson, true);
+	EXPECT_NE(bytes, next);
+
+	Dson plain = make_state();
+	plain.emplace(4, std::uint32_t{4});
+	plain.set_key(10);
+	auto plain_inner = dynamic_cast<Dson *>(plain.get(3));
+	ASSERT_NE(nullptr, plain_inner);
+	plain_inner->emplace(3, std::uint32_t{3});
+	plain_inner->set_key(30);
+	EXPECT_EQ(test::to_buf(plain, true), next);
+
+	dson.clear();
+	EXPECT_EQ(static_cast<std::size_t>(DsonObj::header_size), test::to_buf(dson, true).size());
+}
+
+TEST(TestEncodedCache, ScalarRootBecomesContainer)
+{
+	// Скаляр переезжает в ребёнка, кэш остаётся у корня
+	Dson dson{std::uint32_t{7}};
+	dson.set_key(1);
+	dson.cache_encoded();
+	const auto scalar = test::to_buf(dson, true);
+	dson.emplace(2, std::uint32_t{2});
+	EXPECT_TRUE(dson.is_encoded_cached());
+	auto child = dynamic_cast<Dson *>(dson.get(1));
+	ASSERT_NE(nullptr, child);
+	EXPECT_FALSE(child->is_encoded_cached());
+	EXPECT_EQ(7u, to_uint32(child));
+
+	const auto container = test::to_buf(dson, true);
+	EXPECT_NE(scalar, container);
+	// Повторная выгрузка из кэша
+	EXPECT_EQ(container, test::to_buf(dson, true));
+
+	Dson loaded;
+	std::vector<char> frame = container;
+	ASSERT_EQ(Result::Ready, loaded.load_from_buf(frame.data(), static_cast<std::int32_t>(frame.size())));
+	EXPECT_EQ(7u, to_uint32(loaded, 1));
+	EXPECT_EQ(2u, to_uint32(loaded, 2));
+}
+
+TEST(TestEncodedCache, PartialBufCopy)
+{
+	Dson dson = make_state();
+	dson.cache_encoded();
+	const auto expected = test::to_buf(dson, false);
+
+	std::vector<char> out(expected.size());
+	char * ptr = out.data();
+	Result result{Result::InProcess};
+	while (result == Result::InProcess)
+	{
+		std::int32_t window = std::min<std::int32_t>(
+			100,
+			static_cast<std::int32_t>(out.data() + out.size() - ptr));
+		result = dson.copy_to_buf_host_order(ptr, window);
+	}
+	EXPECT_EQ(Result::Ready, result);
+	EXPECT_EQ(expected, out);
+	EXPECT_EQ(DsonObj::State::Ready, dson.state());
+}
+
+TEST(TestEncodedCache, FdSingleBuffer)
+{
+	test::SocketPair pair{test::SocketPair::Mode::Blocking};
+	Dson dson = make_state();
+	dson.cache_encoded();
+	const auto expected = test::to_buf(dson, true);
+
+	for (int i = 0; i < 3; ++i)
+	{
+		ASSERT_EQ(Result::Ready, dson.copy_to_fd_network_order(pair.writer()));
+		EXPECT_EQ(expected, pair.receive(expected.size()));
+	}
+}
+
+TEST(TestEncodedCache, CachedChildInsideParent)
+{
+	Dson root;
+	Dson child = make_state();
+	child.cache_encoded();
+	root.emplace(1, std::move(child));
+
+	Dson plain;
+	plain.emplace(1, make_state());
+	EXPECT_EQ(test::to_buf(plain, true), test::to_buf(root, true));
+
+	auto cached_child = dynamic_cast<Dson *>(root.get(1));
+	ASSERT_NE(nullptr, cached_child);
+	EXPECT_TRUE(cached_child->is_encoded_cached());
+	cached_child->emplace(5, std::uint32_t{5});
+	auto plain_child = dynamic_cast<Dson *>(plain.get(1));
+	ASSERT_NE(nullptr, plain_child);
+	plain_child->emplace(5, std::uint32_t{5});
+	EXPECT_EQ(test::to_buf(plain, true), test::to_buf(root, true));
+
+	std::stringstream plain_stream;
+	std::stringstream cached_stream;
+	plain.copy_to_stream_host_order(plain_stream);
+	root.copy_to_stream_host_order(cached_stream);
+	EXPECT_EQ(plain_stream.str(), cached_stream.str());
+}
+
+} // namespace
+} // namespace hi
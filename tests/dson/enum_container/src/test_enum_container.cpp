@@ -0,0 +1,218 @@
+/*
+ * This is the source code of thread_highways library
+ *
+ * Copyright (c) Dmitriy Bondarenko
+ * feel free to contact me: bondarenkoda@gmail.com
+ */
+
+#include "dson_test_io.h"
+
+#include <dson/dson_enum.h>
+#include <dson/from_dson_converters.h>
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace hi
+{
+namespace
+{
+
+enum class Keys : std::int32_t
+{
+	Id,
+	Name,
+	Payload,
+	Count,
+	max
+};
+
+Dson make_payload()
+{
+	Dson payload;
+	payload.emplace(1, std::string{"inner"});
+	return payload;
+}
+
+// Поля добавляются не по порядку ключей
+DsonEnum<Keys> make_enum()
+{
+	DsonEnum<Keys> re{5};
+	re.emplace(Keys::Count, static_cast<std::int32_t>(-3));
+	re.emplace(Keys::Id, static_cast<std::uint32_t>(7));
+	re.emplace(Keys::Payload, make_payload());
+	re.emplace(Keys::Name, std::string{"name"});
+	return re;
+}
+
+Dson make_dson()
+{
+	Dson re;
+	re.set_key(5);
+	re.emplace(Keys::Id, static_cast<std::uint32_t>(7));
+	re.emplace(Keys::Name, std::string{"name"});
+	re.emplace(Keys::Payload, make_payload());
+	re.emplace(Keys::Count, static_cast<std::int32_t>(-3));
+	return re;
+}
+
+void check(DsonEnum<Keys> & message)
+{
+	EXPECT_EQ(5, message.key());
+	EXPECT_EQ(7u, to_uint32(message.get(Keys::Id)));
+	EXPECT_EQ("name", to_string_view(message.get(Keys::Name)));
+	EXPECT_EQ(-3, to_int32(message[Keys::Count]));
+	auto payload = static_cast<Dson *>(message.get(Keys::Payload));
+	ASSERT_NE(nullptr, payload);
+	EXPECT_EQ("inner", to_string_view(*payload, 1));
+}
+
+TEST(TestEnumContainer, GetAndEmplace)
+{
+	DsonEnum<Keys> message = make_enum();
+	check(message);
+
+	EXPECT_TRUE(message.contains(Keys::Name));
+	message.erase(Keys::Name);
+	EXPECT_FALSE(message.contains(Keys::Name));
+	EXPECT_EQ(nullptr, message.get(Keys::Name));
+
+	message.emplace(Keys::Id, static_cast<std::uint32_t>(8));
+	EXPECT_EQ(8u, to_uint32(message.get(Keys::Id)));
+}
+
+TEST(TestEnumContainer, WireCompatibleWithDson)
+{
+	DsonEnum<Keys> message = make_enum();
+	Dson dson = make_dson();
+	ASSERT_EQ(dson.data_size(), message.data_size());
+	EXPECT_EQ(test::to_buf(dson, true), test::to_buf(message, true));
+	EXPECT_EQ(test::to_buf(dson, false), test::to_buf(message, false));
+
+	std::ostringstream dson_stream;
+	std::ostringstream message_stream;
+	dson.copy_to_stream_network_order(dson_stream);
+	message.copy_to_stream_network_order(message_stream);
+	EXPECT_EQ(dson_stream.str(), message_stream.str());
+
+	// Вложенный в Dson
+	Dson outer;
+	outer.emplace(1, make_enum());
+	Dson expected;
+	expected.emplace(1, make_dson());
+	EXPECT_EQ(test::to_buf(expected, true), test::to_buf(outer, true));
+}
+
+TEST(TestEnumContainer, FromLoadedDson)
+{
+	Dson dson = make_dson();
+	dson.emplace(100, std::string{"unknown key"});
+	std::vector<char> bytes = test::to_buf(dson, true);
+
+	// Контейнер не разобран
+	{
+		Dson loaded;
+		ASSERT_EQ(Result::Ready, loaded.load_from_buf(bytes.data(), static_cast<std::int32_t>(bytes.size())));
+		DsonEnum<Keys> message{std::move(loaded)};
+		check(message);
+		EXPECT_EQ(make_dson().data_size(), message.data_size());
+	}
+	// Контейнер уже разобран
+	{
+		Dson loaded;
+		ASSERT_EQ(Result::Ready, loaded.load_from_buf(bytes.data(), static_cast<std::int32_t>(bytes.size())));
+		loaded.map();
+		DsonEnum<Keys> message;
+		ASSERT_TRUE(message.assign(std::move(loaded)));
+		check(message);
+	}
+	// Ребёнок изменён через get() до разбора контейнера
+	{
+		Dson loaded;
+		ASSERT_EQ(Result::Ready, loaded.load_from_buf(bytes.data(), static_cast<std::int32_t>(bytes.size())));
+		static_cast<Dson *>(loaded.get(Keys::Payload))->emplace(2, static_cast<std::uint32_t>(9));
+		DsonEnum<Keys> message{std::move(loaded)};
+		check(message);
+		auto payload = static_cast<Dson *>(message.get(Keys::Payload));
+		EXPECT_EQ(9u, to_uint32(*payload, 2));
+		Dson expected = make_dson();
+		static_cast<Dson *>(expected.get(Keys::Payload))->emplace(2, static_cast<std::uint32_t>(9));
+		EXPECT_EQ(expected.data_size(), message.data_size());
+	}
+	// Часть детей уже выдана через next_loaded()
+	{
+		Dson loaded;
+		ASSERT_EQ(Result::Ready, loaded.load_from_buf(bytes.data(), static_cast<std::int32_t>(bytes.size())));
+		Dson first;
+		ASSERT_TRUE(loaded.next_loaded(first));
+		EXPECT_EQ(7u, to_uint32(&first));
+		DsonEnum<Keys> message{std::move(loaded)};
+		check(message);
+		EXPECT_EQ(make_dson().data_size(), message.data_size());
+	}
+	// Не контейнер
+	{
+		Dson leaf{static_cast<std::uint32_t>(1)};
+		DsonEnum<Keys> message;
+		EXPECT_FALSE(message.assign(std::move(leaf)));
+	}
+}
+
+TEST(TestEnumContainer, FromArenaBackedDson)
+{
+	Dson dson = make_dson();
+	std::vector<char> bytes = test::to_buf(dson, true);
+	Dson next_message;
+	next_message.emplace(Keys::Id, static_cast<std::uint32_t>(1000));
+	next_message.emplace(Keys::Name, std::string(200, 'z'));
+	std::vector<char> next_bytes = test::to_buf(next_message, true);
+
+	for (const bool parsed : {false, true})
+	{
+		auto arena = std::make_shared<DsonArena>();
+		Dson loaded{arena};
+		ASSERT_EQ(Result::Ready, loaded.load_from_buf(bytes.data(), static_cast<std::int32_t>(bytes.size())));
+		if (parsed)
+			loaded.map();
+		DsonEnum<Keys> message{std::move(loaded)};
+		// Слоты - вьюхи на буфер арены: следующее сообщение арены их не затирает
+		ASSERT_EQ(
+			Result::Ready,
+			loaded.load_from_buf(next_bytes.data(), static_cast<std::int32_t>(next_bytes.size())));
+		EXPECT_EQ(1000u, to_uint32(loaded, Keys::Id));
+		check(message);
+		loaded.clear();
+		check(message);
+		message.clear();
+		EXPECT_FALSE(arena->is_borrowed()) << parsed;
+	}
+}
+
+TEST(TestEnumContainer, CopyToFd)
+{
+	test::SocketPair pair{test::SocketPair::Mode::BlockingWriter};
+
+	DsonEnum<Keys> message = make_enum();
+	Result result{Result::InProcess};
+	while (result == Result::InProcess)
+	{
+		result = message.copy_to_fd_network_order(pair.writer());
+	}
+	ASSERT_EQ(Result::Ready, result);
+
+	Dson loaded;
+	result = Result::InProcess;
+	while (result == Result::InProcess)
+	{
+		result = loaded.load_from_fd(pair.reader());
+	}
+	ASSERT_EQ(Result::Ready, result);
+	DsonEnum<Keys> received{std::move(loaded)};
+	check(received);
+}
+
+} // namespace
+} // namespace hi
@@ -0,0 +1,230 @@
+/*
+ * This is the source code of thread_highways library
+ *
+ * Copyright (c) Dmitriy Bondarenko
+ * feel free to contact me: bondarenkoda@gmail.com
+ */
+
+#include <dson/dson.h>
+#include <dson/dson_fd_reader.h>
+#include <dson/from_dson_converters.h>
+
+#include <gtest/gtest.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace hi
+{
+namespace
+{
+
+std::vector<char> make_frame(std::int32_t key, std::int32_t payload_size, bool network_order)
+{
+	Dson dson;
+	dson.set_key(key);
+	dson.emplace(1, static_cast<std::uint32_t>(key));
+	dson.emplace(2, std::string(static_cast<std::size_t>(payload_size), 'a' + key % 26));
+	std::vector<char> re(static_cast<std::size_t>(dson.data_size() + DsonObj::header_size));
+	char * ptr = re.data();
+	std::int32_t size = static_cast<std::int32_t>(re.size());
+	const Result result = network_order ? dson.copy_to_buf_network_order(ptr, size) : dson.copy_to_buf_host_order(ptr, size);
+	EXPECT_EQ(Result::Ready, result);
+	return re;
+}
+
+void check_frame(Dson & dson, std::int32_t key, std::int32_t payload_size)
+{
+	EXPECT_EQ(key, dson.key());
+	EXPECT_EQ(static_cast<std::uint32_t>(key), to_uint32(dson, 1));
+	EXPECT_EQ(std::string(static_cast<std::size_t>(payload_size), 'a' + key % 26), to_string_view(dson, 2));
+}
+
+class TestFdReader : public ::testing::Test
+{
+protected:
+	void SetUp() override
+	{
+		ASSERT_EQ(0, ::pipe(fds_));
+		::fcntl(fds_[0], F_SETFL, ::fcntl(fds_[0], F_GETFL) | O_NONBLOCK);
+	}
+
+	void TearDown() override
+	{
+		::close(fds_[0]);
+		::close(fds_[1]);
+	}
+
+	void write_all(const std::vector<char> & buf)
+	{
+		ASSERT_EQ(static_cast<ssize_t>(buf.size()), ::write(fds_[1], buf.data(), buf.size()));
+	}
+
+	int fds_[2];
+};
+
+TEST_F(TestFdReader, ManyMessagesFromOneRead)
+{
+	std::vector<char> stream;
+	for (std::int32_t key = 0; key < 10; ++key)
+	{
+		const auto frame = make_frame(key, 10 + key, key % 2);
+		stream.insert(stream.end(), frame.begin(), frame.end());
+	}
+	write_all(stream);
+
+	DsonFdReader reader{fds_[0]};
+	ASSERT_EQ(Result::Ready, reader.read());
+	EXPECT_EQ(static_cast<std::int32_t>(stream.size()), reader.buffered());
+
+	Dson dson;
+	for (std::int32_t key = 0; key < 10; ++key)
+	{
+		ASSERT_TRUE(reader.next(dson));
+		check_frame(dson, key, 10 + key);
+	}
+	EXPECT_FALSE(reader.next(dson));
+	EXPECT_EQ(0, reader.buffered());
+	dson.clear();
+	EXPECT_EQ(Result::InProcess, reader.read());
+}
+
+TEST_F(TestFdReader, PartialTailKeptForNextRead)
+{
+	const auto first = make_frame(1, 100, false);
+	const auto second = make_frame(2, 100, true);
+	std::vector<char> stream{first};
+	stream.insert(stream.end(), second.begin(), second.end());
+
+	// Первое сообщение целиком и половина второго
+	const std::size_t split = first.size() + second.size() / 2;
+	write_all(std::vector<char>(stream.begin(), stream.begin() + static_cast<std::ptrdiff_t>(split)));
+
+	DsonFdReader reader{fds_[0]};
+	Dson dson;
+	ASSERT_EQ(Result::Ready, reader.read());
+	ASSERT_TRUE(reader.next(dson));
+	check_frame(dson, 1, 100);
+	EXPECT_FALSE(reader.next(dson));
+	dson.clear();
+
+	EXPECT_EQ(Result::InProcess, reader.read());
+	write_all(std::vector<char>(stream.begin() + static_cast<std::ptrdiff_t>(split), stream.end()));
+	ASSERT_EQ(Result::Ready, reader.read());
+	ASSERT_TRUE(reader.next(dson));
+	check_frame(dson, 2, 100);
+	EXPECT_FALSE(reader.next(dson));
+}
+
+TEST_F(TestFdReader, MessageBiggerThanBuffer)
+{
+	const auto small = make_frame(3, 10, true);
+	const auto big = make_frame(4, 50000, true);
+
+	DsonFdReader reader{fds_[0], 256};
+	Dson dson;
+	write_all(small);
+	ASSERT_EQ(Result::Ready, reader.read());
+
+	ASSERT_TRUE(reader.next(dson));
+	check_frame(dson, 3, 10);
+	dson.clear();
+
+	// Пишем большое сообщение частями: хвост сдвигается и буфер растёт
+	std::size_t written{0};
+	while (!reader.next(dson))
+	{
+		ASSERT_LT(written, big.size());
+		const std::size_t part = std::min<std::size_t>(4000, big.size() - written);
+		write_all(std::vector<char>(
+			big.begin() + static_cast<std::ptrdiff_t>(written),
+			big.begin() + static_cast<std::ptrdiff_t>(written + part)));
+		written += part;
+		ASSERT_NE(Result::Error, reader.read());
+	}
+	check_frame(dson, 4, 50000);
+	EXPECT_LE(static_cast<std::int32_t>(big.size()), reader.capacity());
+}
+
+TEST_F(TestFdReader, NextAfterReallocatingRead)
+{
+	const auto small = make_frame(6, 10, false);
+	const auto big = make_frame(7, 50000, false);
+
+	DsonFdReader reader{fds_[0], 256};
+	Dson dson;
+	write_all(small);
+	ASSERT_EQ(Result::Ready, reader.read());
+	ASSERT_TRUE(reader.next(dson));
+	check_frame(dson, 6, 10);
+
+	// Вьюха не отпущена: read() переаллоцирует буфер, next() переназначает вьюху
+	write_all(big);
+	Result result{Result::InProcess};
+	while (result == Result::InProcess)
+	{
+		result = reader.read();
+	}
+	ASSERT_EQ(Result::Ready, result);
+	EXPECT_LE(static_cast<std::int32_t>(big.size()), reader.capacity());
+	ASSERT_TRUE(reader.next(dson));
+	check_frame(dson, 7, 50000);
+}
+
+TEST_F(TestFdReader, ViewOutlivesReader)
+{
+	const auto frame = make_frame(8, 100, true);
+	write_all(frame);
+
+	Dson dson;
+	{
+		DsonFdReader reader{fds_[0]};
+		ASSERT_EQ(Result::Ready, reader.read());
+		ASSERT_TRUE(reader.next(dson));
+		check_frame(dson, 8, 100);
+	}
+	// Буфер читателя освобождён: вьюху можно очистить и переиспользовать
+	dson.clear();
+	dson.emplace(1, static_cast<std::uint32_t>(8));
+	EXPECT_EQ(8u, to_uint32(dson, 1));
+}
+
+TEST_F(TestFdReader, CorruptedHeader)
+{
+	write_all(std::vector<char>(DsonObj::header_size, '\x7f'));
+	DsonFdReader reader{fds_[0]};
+	EXPECT_EQ(Result::Error, reader.read());
+	Dson dson;
+	EXPECT_FALSE(reader.next(dson));
+}
+
+TEST_F(TestFdReader, OwnCopyWithArena)
+{
+	const auto frame = make_frame(5, 1000, true);
+	write_all(frame);
+	write_all(frame);
+
+	DsonFdReader reader{fds_[0]};
+	ASSERT_EQ(Result::Ready, reader.read());
+	Dson dson{std::make_shared<DsonArena>()};
+	char * ptr;
+	std::int32_t size;
+	std::int32_t count{0};
+	while (reader.next(ptr, size))
+	{
+		EXPECT_EQ(static_cast<std::int32_t>(frame.size()), size);
+		ASSERT_EQ(Result::Ready, dson.load_from_buf(ptr, size));
+		Dson own{std::move(dson)};
+		check_frame(own, 5, 1000);
+		dson.clear();
+		++count;
+	}
+	EXPECT_EQ(2, count);
+}
+
+} // namespace
+} // namespace hi
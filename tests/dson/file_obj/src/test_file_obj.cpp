@@ -0,0 +1,156 @@
+/*
+ * This is the source code of thread_highways library
+ *
+ * Copyright (c) Dmitriy Bondarenko
+ * feel free to contact me: bondarenkoda@gmail.com
+ */
+
+#include "dson_test_io.h"
+
+#include <dson/include_all.h>
+
+#include <gtest/gtest.h>
+
+#include <fcntl.h>
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace hi
+{
+namespace
+{
+
+constexpr const char * file_name{"test_file_obj.bin"};
+constexpr std::int32_t file_size{300000};
+constexpr std::int64_t part_offset{1000};
+constexpr std::int32_t part_size{200000};
+
+std::string file_content()
+{
+	std::string re(file_size, '\0');
+	for (std::int32_t i = 0; i < file_size; ++i)
+	{
+		re[static_cast<std::size_t>(i)] = static_cast<char>(i * 7 % 251);
+	}
+	return re;
+}
+
+class TestFileObj : public ::testing::Test
+{
+protected:
+	void SetUp() override
+	{
+		{
+			std::ofstream out(file_name, std::ios::binary);
+			const std::string content = file_content();
+			out.write(content.data(), static_cast<std::streamsize>(content.size()));
+		}
+		fd_ = ::open(file_name, O_RDONLY);
+		ASSERT_GE(fd_, 0);
+	}
+
+	void TearDown() override
+	{
+		::close(fd_);
+		std::remove(file_name);
+	}
+
+	Dson make_message()
+	{
+		Dson dson;
+		dson.emplace(1, std::uint32_t{77});
+		dson.emplace(std::make_unique<DsonFileObj>(2, fd_, part_offset, part_size));
+		dson.emplace(3, std::string{"after file"});
+		return dson;
+	}
+
+	static void check_message(std::vector<char> & frame)
+	{
+		Dson loaded;
+		std::int32_t consumed{0};
+		ASSERT_EQ(
+			Result::Ready,
+			loaded.load_from_buf(frame.data(), static_cast<std::int32_t>(frame.size()), consumed));
+		EXPECT_EQ(static_cast<std::int32_t>(frame.size()), consumed);
+		EXPECT_EQ(77u, to_uint32(loaded, 1));
+		EXPECT_EQ(file_content().substr(part_offset, part_size), to_string_view(loaded, 2));
+		EXPECT_EQ("after file", to_string_view(loaded, 3));
+	}
+
+	std::int32_t fd_{-1};
+};
+
+TEST_F(TestFileObj, CopyToFdNonBlocking)
+{
+	test::SocketPair pair{test::SocketPair::Mode::NonBlocking, test::SocketPair::small_send_buf};
+	Dson dson = make_message();
+	for (int round = 0; round < 2; ++round)
+	{
+		auto sent = pair.transfer(
+			[&](std::int32_t fd)
+			{
+				return dson.copy_to_fd_network_order(fd);
+			});
+		ASSERT_EQ(Result::Ready, sent.result);
+		// данные больше буфера сокета: выгрузка возобновлялась
+		EXPECT_GT(sent.in_process, 0);
+		check_message(sent.received);
+	}
+}
+
+TEST_F(TestFileObj, CopyToBufAndStream)
+{
+	Dson dson = make_message();
+	std::vector<char> frame(static_cast<std::size_t>(dson.data_size() + DsonObj::header_size));
+	char * ptr = frame.data();
+	std::int32_t size = static_cast<std::int32_t>(frame.size());
+	ASSERT_EQ(Result::Ready, dson.copy_to_buf_host_order(ptr, size));
+	EXPECT_EQ(0, size);
+	check_message(frame);
+
+	std::stringstream stream;
+	stream << dson;
+	const std::string str = stream.str();
+	std::vector<char> from_stream(str.begin(), str.end());
+	check_message(from_stream);
+}
+
+TEST_F(TestFileObj, WholeFileByPath)
+{
+	DsonFileObj obj{5, file_name};
+	ASSERT_EQ(DsonObj::State::Ready, obj.state());
+	EXPECT_EQ(file_size, obj.data_size());
+	EXPECT_EQ(TypeMarker{types_map<std::string>::value}, obj.data_type());
+
+	std::vector<char> frame(static_cast<std::size_t>(obj.data_size() + DsonObj::header_size));
+	char * ptr = frame.data();
+	std::int32_t size = static_cast<std::int32_t>(frame.size());
+	ASSERT_EQ(Result::Ready, obj.copy_to_buf_network_order(ptr, size));
+	Dson loaded{frame.data()};
+	EXPECT_EQ(5, loaded.key());
+	EXPECT_EQ(file_content(), to_string_view(&loaded));
+
+	DsonFileObj missing{5, "no_such_file.bin"};
+	EXPECT_EQ(DsonObj::State::Error, missing.state());
+}
+
+TEST_F(TestFileObj, FileShorterThanDeclared)
+{
+	DsonFileObj obj{2, fd_, file_size - 10, 100};
+	const int out = ::open("/dev/null", O_WRONLY);
+	EXPECT_EQ(Result::Error, obj.copy_to_fd_network_order(out));
+	::close(out);
+	obj.reset_state();
+
+	std::vector<char> frame(static_cast<std::size_t>(obj.data_size() + DsonObj::header_size));
+	char * ptr = frame.data();
+	std::int32_t size = static_cast<std::int32_t>(frame.size());
+	EXPECT_EQ(Result::Error, obj.copy_to_buf_network_order(ptr, size));
+}
+
+} // namespace
+} // namespace hi
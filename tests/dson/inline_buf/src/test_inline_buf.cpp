@@ -0,0 +1,112 @@
+/*
+ * This is the source code of thread_highways library
+ *
+ * Copyright (c) Dmitriy Bondarenko
+ * feel free to contact me: bondarenkoda@gmail.com
+ */
+
+#include <dson/dson.h>
+#include <dson/from_dson_converters.h>
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+namespace hi
+{
+namespace
+{
+
+// Данные лежат внутри самого объекта (без аллокации)
+bool is_inline(Dson & dson)
+{
+	const char * data = static_cast<const char *>(dson.data());
+	const char * begin = reinterpret_cast<const char *>(&dson);
+	return begin <= data && data < begin + sizeof(Dson);
+}
+
+TEST(TestInlineBuf, ScalarsAreInline)
+{
+	Dson u32{std::uint32_t{42}};
+	Dson i32{std::int32_t{-42}};
+	Dson dbl{1.25};
+	Dson small{std::string(24, 'a')};
+	Dson big{std::string(25, 'b')};
+
+	EXPECT_TRUE(is_inline(u32));
+	EXPECT_TRUE(is_inline(i32));
+	EXPECT_TRUE(is_inline(dbl));
+	EXPECT_TRUE(is_inline(small));
+	EXPECT_FALSE(is_inline(big));
+
+	EXPECT_EQ(42u, to_uint32(&u32));
+	EXPECT_EQ(-42, to_int32(&i32));
+	EXPECT_DOUBLE_EQ(1.25, to_double(&dbl));
+	EXPECT_EQ(std::string(24, 'a'), to_string_view(&small));
+	EXPECT_EQ(std::string(25, 'b'), to_string_view(&big));
+}
+
+TEST(TestInlineBuf, MoveKeepsInlineData)
+{
+	Dson from{std::uint32_t{7}};
+	from.set_key(3);
+	Dson to{std::move(from)};
+	EXPECT_TRUE(is_inline(to));
+	EXPECT_EQ(3, to.key());
+	EXPECT_EQ(7u, to_uint32(&to));
+
+	Dson assigned;
+	assigned = std::move(to);
+	EXPECT_TRUE(is_inline(assigned));
+	EXPECT_EQ(7u, to_uint32(&assigned));
+}
+
+TEST(TestInlineBuf, ScalarBecomesContainer)
+{
+	// Первый объект уезжает в ребёнка вместе со встроенным буфером
+	Dson dson{std::uint32_t{100}};
+	dson.set_key(1);
+	dson.emplace(2, std::int32_t{-200});
+	dson.emplace(3, 3.5);
+	EXPECT_TRUE(dson.data_type() == types_map<DsonContainer>::value);
+	EXPECT_EQ(3u, dson.map().size());
+
+	Dson moved{std::move(dson)};
+	EXPECT_EQ(100u, to_uint32(moved.get(1)));
+	EXPECT_EQ(-200, to_int32(moved.get(2)));
+	EXPECT_DOUBLE_EQ(3.5, to_double(moved.get(3)));
+}
+
+TEST(TestInlineBuf, RoundTrip)
+{
+	Dson dson;
+	for (std::int32_t key = 0; key < 10; ++key)
+	{
+		dson.emplace(key, key * 10);
+	}
+	dson.emplace(10, std::string{"short"});
+	std::vector<char> buf(static_cast<std::size_t>(dson.data_size() + DsonObj::header_size));
+	char * ptr = buf.data();
+	std::int32_t size = static_cast<std::int32_t>(buf.size());
+	ASSERT_EQ(Result::Ready, dson.copy_to_buf_network_order(ptr, size));
+
+	Dson loaded;
+	ASSERT_EQ(Result::Ready, loaded.load_from_buf(buf.data(), static_cast<std::int32_t>(buf.size())));
+	for (std::int32_t key = 0; key < 10; ++key)
+	{
+		EXPECT_EQ(key * 10, to_int32(loaded.get(key)));
+	}
+	EXPECT_EQ("short", to_string_view(loaded.get(10)));
+
+	// Загруженный скаляр тоже хранится внутри
+	Dson scalar{std::uint32_t{5}};
+	std::vector<char> scalar_buf = scalar.to_buf_host_order();
+	Dson loaded_scalar;
+	ASSERT_EQ(Result::Ready, loaded_scalar.load_from_buf(scalar_buf.data(), static_cast<std::int32_t>(scalar_buf.size())));
+	EXPECT_TRUE(is_inline(loaded_scalar));
+	EXPECT_EQ(5u, to_uint32(&loaded_scalar));
+}
+
+} // namespace
+} // namespace hi
@@ -0,0 +1,131 @@
+/*
+ * This is the source code of thread_highways library
+ *
+ * Copyright (c) Dmitriy Bondarenko
+ * feel free to contact me: bondarenkoda@gmail.com
+ */
+
+#include <dson/dson.h>
+#include <dson/from_dson_converters.h>
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+namespace hi
+{
+namespace
+{
+
+constexpr std::int32_t fields{8};
+
+std::vector<char> make_message_bytes()
+{
+	Dson dson;
+	for (std::int32_t key = 0; key < fields; ++key)
+	{
+		dson.emplace(key, static_cast<std::uint32_t>(key + 100));
+	}
+	std::vector<char> re(static_cast<std::size_t>(dson.data_size() + DsonObj::header_size));
+	char * ptr = re.data();
+	std::int32_t size = static_cast<std::int32_t>(re.size());
+	EXPECT_EQ(Result::Ready, dson.copy_to_buf_network_order(ptr, size));
+	return re;
+}
+
+// Смещение ребёнка key в сообщении (все дети uint32)
+std::size_t child_offset(std::int32_t key)
+{
+	return static_cast<std::size_t>(DsonObj::header_size + key * (DsonObj::header_size + 4));
+}
+
+TEST(TestLazyHostOrder, ChildrenConvertedOnAccess)
+{
+	if (mark_host_order == mark_network_order)
+		GTEST_SKIP() << "host order is network order";
+
+	std::vector<char> bytes = make_message_bytes();
+	const std::vector<char> original = bytes;
+	// Вьюха: дети переводятся в host order прямо в bytes
+	Dson loaded;
+	std::int32_t consumed{0};
+	ASSERT_EQ(
+		Result::Ready,
+		loaded.load_from_buf(bytes.data(), static_cast<std::int32_t>(bytes.size()), consumed));
+
+	auto children = loaded.children();
+	ASSERT_EQ(static_cast<std::size_t>(fields), children.size());
+	std::vector<DsonKey> keys;
+	for (auto it = children.begin(); it != children.end(); ++it)
+	{
+		keys.push_back(it.key());
+	}
+	EXPECT_EQ(static_cast<std::size_t>(fields), keys.size());
+	// Ключи без перевода
+	EXPECT_EQ(original, bytes);
+
+	auto [key, obj] = *children.begin();
+	EXPECT_EQ(0, key);
+	EXPECT_EQ(100u, to_uint32(obj));
+	EXPECT_EQ(103u, to_uint32(children.find(3)));
+	EXPECT_EQ(nullptr, children.find(fields));
+	for (std::int32_t i = 0; i < fields; ++i)
+	{
+		const bool converted = std::memcmp(
+			bytes.data() + child_offset(i),
+			original.data() + child_offset(i),
+			DsonObj::header_size + 4);
+		EXPECT_EQ(i == 0 || i == 3, !!converted) << i;
+	}
+
+	std::uint32_t sum{0};
+	for (auto [k, child] : loaded.children())
+	{
+		EXPECT_TRUE(child->is_host_order());
+		sum += to_uint32(child) - static_cast<std::uint32_t>(k);
+	}
+	EXPECT_EQ(static_cast<std::uint32_t>(fields * 100), sum);
+}
+
+TEST(TestLazyHostOrder, MapConvertsChangedChildren)
+{
+	std::vector<char> bytes = make_message_bytes();
+	// Внешние буферы детей должны пережить loaded
+	std::vector<char> other = make_message_bytes();
+	std::vector<char> single = make_message_bytes();
+	Dson loaded;
+	ASSERT_EQ(Result::Ready, loaded.load_from_buf(bytes.data(), static_cast<std::int32_t>(bytes.size())));
+	for (auto & it : loaded.map())
+	{
+		EXPECT_TRUE(it.second->is_host_order());
+	}
+
+	// Ребёнок переведён в network order снаружи
+	auto child = static_cast<Dson *>(loaded.map().by_index(2).second.get());
+	Dson::converters().to_network(*child);
+	EXPECT_TRUE(child->is_network_order());
+	loaded.map();
+	EXPECT_TRUE(child->is_host_order());
+	EXPECT_EQ(102u, to_uint32(child));
+
+	// Добавлен ребёнок в network order
+	Dson view{other.data() + child_offset(5)};
+	EXPECT_TRUE(view.is_network_order());
+	loaded.emplace(20, std::move(view));
+	auto added = loaded.map().find(20);
+	ASSERT_NE(loaded.map().end(), added);
+	EXPECT_TRUE(added->second->is_host_order());
+
+	// Ребёнок перезагружен
+	Dson & first = *static_cast<Dson *>(loaded.map().by_index(0).second.get());
+	ASSERT_EQ(
+		Result::Ready,
+		first.load_from_buf(single.data() + child_offset(7), DsonObj::header_size + 4));
+	loaded.map();
+	EXPECT_TRUE(first.is_host_order());
+	EXPECT_EQ(107u, to_uint32(&first));
+}
+
+} // namespace
+} // namespace hi
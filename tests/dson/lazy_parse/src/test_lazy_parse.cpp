@@ -0,0 +1,198 @@
+/*
+ * This is the source code of thread_highways library
+ *
+ * Copyright (c) Dmitriy Bondarenko
+ * feel free to contact me: bondarenkoda@gmail.com
+ */
+
+#include <dson/dson.h>
+#include <dson/from_dson_converters.h>
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace hi
+{
+namespace
+{
+
+enum Keys : std::int32_t
+{
+	Id,
+	Name,
+	Negative,
+	Ratio,
+	Inner,
+	InnerValue,
+	InnerName
+};
+
+Dson make_message()
+{
+	Dson inner;
+	inner.emplace(Keys::InnerValue, std::uint32_t{77});
+	inner.emplace(Keys::InnerName, std::string{"inner"});
+
+	Dson dson;
+	dson.emplace(Keys::Id, std::uint32_t{123456});
+	dson.emplace(Keys::Name, std::string{"lazy"});
+	dson.emplace(Keys::Negative, std::int32_t{-42});
+	dson.emplace(Keys::Ratio, 2.5);
+	dson.emplace(Keys::Inner, std::move(inner));
+	return dson;
+}
+
+std::vector<char> to_network_buf(Dson & dson)
+{
+	std::vector<char> buf(static_cast<std::size_t>(dson.data_size() + DsonObj::header_size));
+	char * ptr = buf.data();
+	std::int32_t size = static_cast<std::int32_t>(buf.size());
+	EXPECT_EQ(Result::Ready, dson.copy_to_buf_network_order(ptr, size));
+	return buf;
+}
+
+TEST(TestLazyParse, RawReadsDoNotMaterializeChildren)
+{
+	Dson message = make_message();
+	std::vector<char> buf = to_network_buf(message);
+	const std::vector<char> original = buf;
+
+	Dson loaded;
+	ASSERT_EQ(Result::Ready, loaded.load_from_buf(buf.data(), static_cast<std::int32_t>(buf.size())));
+	EXPECT_EQ(123456u, to_uint32(loaded, Keys::Id));
+	EXPECT_EQ(123456u, to_uint64(loaded, Keys::Id));
+	EXPECT_EQ(-42, to_int32(loaded, Keys::Negative));
+	EXPECT_EQ(-42, to_int64(loaded, Keys::Negative));
+	EXPECT_DOUBLE_EQ(2.5, to_double(loaded, Keys::Ratio));
+	EXPECT_EQ("lazy", to_string_view(loaded, Keys::Name));
+	EXPECT_EQ(7u, to_uint32(loaded, 100, 7u));
+
+	// Буфер не конвертировался в host order
+	EXPECT_EQ(0, std::memcmp(original.data() + DsonObj::header_size, loaded.data(), original.size() - DsonObj::header_size));
+}
+
+TEST(TestLazyParse, GetMaterializesOnlyRequestedChild)
+{
+	Dson message = make_message();
+	std::vector<char> buf = to_network_buf(message);
+	const std::vector<char> buf_copy = buf;
+
+	// Вьюха на буфер: объекты конвертируются прямо в нём
+	Dson loaded{buf.data()};
+	DsonObj * id = loaded.get(Keys::Id);
+	ASSERT_NE(nullptr, id);
+	EXPECT_EQ(123456u, to_uint32(id));
+	// В host order переведён только запрошенный объект (Id первый в буфере)
+	const std::size_t id_size = 2 * DsonObj::header_size + sizeof(std::uint32_t);
+	EXPECT_EQ(0, std::memcmp(buf_copy.data() + id_size, buf.data() + id_size, buf.size() - id_size));
+	// Повторный get возвращает тот же объект
+	EXPECT_EQ(id, loaded.get(Keys::Id));
+	EXPECT_EQ(nullptr, loaded.get(100));
+
+	auto inner = dynamic_cast<Dson *>(loaded.get(Keys::Inner));
+	ASSERT_NE(nullptr, inner);
+	EXPECT_EQ(77u, to_uint32(*inner, Keys::InnerValue));
+	EXPECT_EQ("inner", to_string_view(inner->get(Keys::InnerName)));
+	EXPECT_EQ(5u, loaded.map().size());
+}
+
+TEST(TestLazyParse, ReserializeParsedMessage)
+{
+	Dson message = make_message();
+	const std::vector<char> expected = message.to_buf_host_order();
+	std::vector<char> buf = to_network_buf(message);
+
+	Dson loaded;
+	ASSERT_EQ(Result::Ready, loaded.load_from_buf(buf.data(), static_cast<std::int32_t>(buf.size())));
+	// Часть детей создана до полного разбора, часть - при обходе
+	EXPECT_EQ(123456u, to_uint32(loaded.get(Keys::Id)));
+	auto inner = dynamic_cast<Dson *>(loaded.get(Keys::Inner));
+	ASSERT_NE(nullptr, inner);
+	EXPECT_EQ(77u, to_uint32(inner->get(Keys::InnerValue)));
+
+	std::int32_t count{0};
+	for (const auto & it : loaded.map())
+	{
+		EXPECT_NE(nullptr, it.second);
+		++count;
+	}
+	EXPECT_EQ(5, count);
+
+	std::vector<char> again = loaded.to_buf_host_order();
+	EXPECT_EQ(expected.size(), again.size());
+	Dson reloaded;
+	ASSERT_EQ(Result::Ready, reloaded.load_from_buf(again.data(), static_cast<std::int32_t>(again.size())));
+	EXPECT_EQ(123456u, to_uint32(reloaded, Keys::Id));
+	EXPECT_EQ("lazy", to_string_view(reloaded, Keys::Name));
+	EXPECT_EQ(-42, to_int32(reloaded, Keys::Negative));
+	EXPECT_DOUBLE_EQ(2.5, to_double(reloaded, Keys::Ratio));
+	inner = dynamic_cast<Dson *>(reloaded.get(Keys::Inner));
+	ASSERT_NE(nullptr, inner);
+	EXPECT_EQ(77u, to_uint32(*inner, Keys::InnerValue));
+	EXPECT_EQ("inner", to_string_view(*inner, Keys::InnerName));
+}
+
+TEST(TestLazyParse, MutateLazilyFetchedChild)
+{
+	Dson message = make_message();
+	std::vector<char> buf = to_network_buf(message);
+
+	Dson loaded;
+	ASSERT_EQ(Result::Ready, loaded.load_from_buf(buf.data(), static_cast<std::int32_t>(buf.size())));
+	auto inner = dson_cast<Dson>(loaded.get(Keys::Inner));
+	ASSERT_NE(nullptr, inner);
+	// Изменение ребёнка меняет размер ещё не разобранного родителя
+	inner->emplace(Keys::Id, std::uint32_t{9});
+	static_cast<Dson *>(message.get(Keys::Inner))->emplace(Keys::Id, std::uint32_t{9});
+	ASSERT_EQ(message.data_size(), loaded.data_size());
+
+	std::vector<char> again(static_cast<std::size_t>(loaded.data_size() + DsonObj::header_size));
+	char * ptr = again.data();
+	std::int32_t size = static_cast<std::int32_t>(again.size());
+	ASSERT_EQ(Result::Ready, loaded.copy_to_buf_host_order(ptr, size));
+	EXPECT_EQ(0, size);
+
+	Dson reloaded;
+	ASSERT_EQ(Result::Ready, reloaded.load_from_buf(again.data(), static_cast<std::int32_t>(again.size())));
+	inner = dson_cast<Dson>(reloaded.get(Keys::Inner));
+	ASSERT_NE(nullptr, inner);
+	EXPECT_EQ(9u, to_uint32(*inner, Keys::Id));
+	EXPECT_EQ(77u, to_uint32(*inner, Keys::InnerValue));
+	EXPECT_EQ("inner", to_string_view(*inner, Keys::InnerName));
+	EXPECT_EQ("lazy", to_string_view(reloaded, Keys::Name));
+	EXPECT_DOUBLE_EQ(2.5, to_double(reloaded, Keys::Ratio));
+}
+
+TEST(TestLazyParse, DuplicateKeysLastWins)
+{
+	Dson first{std::uint32_t{1}};
+	first.set_key(Keys::Id);
+	Dson second{std::string{"name"}};
+	second.set_key(Keys::Name);
+	Dson third{std::uint32_t{3}};
+	third.set_key(Keys::Id);
+	std::vector<char> payload;
+	for (Dson * dson : {&first, &second, &third})
+	{
+		const std::vector<char> part = dson->to_buf_host_order();
+		payload.insert(payload.end(), part.begin(), part.end());
+	}
+	Dson container;
+	std::vector<char> buf = container.to_buf_host_order();
+	auto header = std::launder(reinterpret_cast<DsonObj::Header *>(buf.data()));
+	header->data_size_ = static_cast<std::int32_t>(payload.size());
+	header->data_type_ = types_map<DsonContainer>::value;
+	buf.insert(buf.end(), payload.begin(), payload.end());
+
+	Dson loaded;
+	ASSERT_EQ(Result::Ready, loaded.load_from_buf(buf.data(), static_cast<std::int32_t>(buf.size())));
+	EXPECT_EQ(3u, to_uint32(loaded, Keys::Id));
+	EXPECT_EQ("name", to_string_view(loaded, Keys::Name));
+	EXPECT_EQ(3u, to_uint32(loaded.get(Keys::Id)));
+}
+
+} // namespace
+} // namespace hi
@@ -0,0 +1,200 @@
+/*
+ * This is the source code of thread_highways library
+ *
+ * Copyright (c) Dmitriy Bondarenko
+ * feel free to contact me: bondarenkoda@gmail.com
+ */
+
+#include "dson_test_io.h"
+
+#include <dson/dson.h>
+#include <dson/from_dson_converters.h>
+
+#include <gtest/gtest.h>
+
+#include <csignal>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace hi
+{
+namespace
+{
+
+constexpr std::int32_t fields{20};
+
+std::string payload(std::int32_t key)
+{
+	// Ненужные поля большие
+	return std::string(key % 2 ? 64 * 1024 : 100, static_cast<char>('a' + key));
+}
+
+Dson make_message()
+{
+	Dson dson;
+	for (std::int32_t key = 0; key < fields; ++key)
+	{
+		Dson inner;
+		inner.emplace(1, static_cast<std::uint32_t>(key + 100));
+		inner.emplace(2, payload(key));
+		dson.emplace(key, std::move(inner));
+	}
+	return dson;
+}
+
+void check_inner(Dson & dson, std::int32_t key)
+{
+	auto inner = static_cast<Dson *>(dson.get(key));
+	ASSERT_NE(nullptr, inner);
+	EXPECT_EQ(static_cast<std::uint32_t>(key + 100), to_uint32(*inner, 1));
+	EXPECT_EQ(payload(key), to_string_view(*inner, 2));
+}
+
+class TestLoadFilter : public ::testing::Test
+{
+protected:
+	void SetUp() override
+	{
+		::signal(SIGPIPE, SIG_IGN);
+	}
+
+	// Отправка bytes из потока и загрузка в dson
+	Result send_and_load(const std::vector<char> & bytes, Dson & dson)
+	{
+		std::thread sender(
+			[&]
+			{
+				pair_.send(bytes, 0, bytes.size());
+			});
+		Result result{Result::InProcess};
+		while (result == Result::InProcess)
+		{
+			result = dson.load_from_fd(pair_.reader());
+		}
+		sender.join();
+		return result;
+	}
+
+	test::SocketPair pair_{test::SocketPair::Mode::BlockingWriter};
+};
+
+TEST_F(TestLoadFilter, OnlyWantedKeysLoaded)
+{
+	Dson message = make_message();
+	const std::vector<char> bytes = test::to_buf(message, true);
+
+	Dson loaded;
+	loaded.set_load_filter(std::vector<DsonKey>{17, 4, 99});
+	ASSERT_EQ(Result::Ready, send_and_load(bytes, loaded));
+
+	EXPECT_EQ(2u, loaded.map().size());
+	EXPECT_EQ(nullptr, loaded.get(3));
+	check_inner(loaded, 4);
+	check_inner(loaded, 17);
+
+	// Отфильтрованный Dson - обычный контейнер
+	Dson expected;
+	expected.emplace(4, std::move(*static_cast<Dson *>(message.get(4))));
+	expected.emplace(17, std::move(*static_cast<Dson *>(message.get(17))));
+	EXPECT_EQ(expected.data_size(), loaded.data_size());
+	EXPECT_EQ(test::to_buf(expected, true), test::to_buf(loaded, true));
+}
+
+TEST_F(TestLoadFilter, FilterAppliesToEachLoad)
+{
+	Dson message = make_message();
+	const std::vector<char> bytes = test::to_buf(message, true);
+
+	std::vector<DsonKey> asked;
+	Dson loaded;
+	loaded.set_load_filter(
+		[&](const DsonKey key)
+		{
+			asked.push_back(key);
+			return key == 0;
+		});
+	for (int i = 0; i < 2; ++i)
+	{
+		ASSERT_EQ(Result::Ready, send_and_load(bytes, loaded));
+		EXPECT_EQ(1u, loaded.map().size());
+		check_inner(loaded, 0);
+	}
+	EXPECT_EQ(static_cast<std::size_t>(fields * 2), asked.size());
+
+	// Фильтр остаётся в этом Dson, загруженное сообщение уходит целиком
+	Dson moved{std::move(loaded)};
+	check_inner(moved, 0);
+	ASSERT_EQ(Result::Ready, send_and_load(bytes, loaded));
+	EXPECT_EQ(1u, loaded.map().size());
+
+	loaded.set_load_filter(nullptr);
+	ASSERT_EQ(Result::Ready, send_and_load(bytes, loaded));
+	EXPECT_EQ(static_cast<std::size_t>(fields), loaded.map().size());
+	check_inner(loaded, 19);
+}
+
+TEST_F(TestLoadFilter, Arena)
+{
+	Dson message = make_message();
+	const std::vector<char> bytes = test::to_buf(message, true);
+
+	Dson loaded{std::make_shared<DsonArena>()};
+	loaded.set_load_filter(std::vector<DsonKey>{5});
+	ASSERT_EQ(Result::Ready, send_and_load(bytes, loaded));
+	EXPECT_EQ(1u, loaded.map().size());
+	check_inner(loaded, 5);
+
+	// Ни одного нужного ребёнка: пустой контейнер
+	Dson other;
+	other.emplace(3, std::string{"value"});
+	ASSERT_EQ(Result::Ready, send_and_load(test::to_buf(other, true), loaded));
+	EXPECT_TRUE(loaded.map().empty());
+	EXPECT_EQ(0, loaded.data_size());
+	EXPECT_EQ(other.key(), loaded.key());
+}
+
+TEST_F(TestLoadFilter, EmptyChildren)
+{
+	// Нужные дети без данных загружаются одним заголовком
+	Dson message;
+	message.emplace(1, std::string{});
+	message.emplace(2, static_cast<std::uint32_t>(77));
+	message.emplace(3, Dson{});
+	message.emplace(4, static_cast<std::uint32_t>(99));
+
+	Dson loaded;
+	loaded.set_load_filter(std::vector<DsonKey>{1, 3, 4});
+	ASSERT_EQ(Result::Ready, send_and_load(test::to_buf(message, true), loaded));
+	EXPECT_EQ(3u, loaded.map().size());
+	ASSERT_NE(nullptr, loaded.get(1));
+	EXPECT_EQ(0, loaded.get(1)->data_size());
+	EXPECT_EQ(std::string_view{}, to_string_view(loaded, 1));
+	ASSERT_NE(nullptr, loaded.get(3));
+	EXPECT_EQ(0, loaded.get(3)->data_size());
+	EXPECT_EQ(nullptr, loaded.get(2));
+	EXPECT_EQ(99u, to_uint32(loaded, 4));
+}
+
+TEST_F(TestLoadFilter, CorruptedChildHeader)
+{
+	Dson message = make_message();
+	std::vector<char> bytes = test::to_buf(message, true);
+	// Размер первого ребёнка больше сообщения
+	std::int32_t * child_header = reinterpret_cast<std::int32_t *>(bytes.data() + DsonObj::header_size);
+	child_header[1] = int32_to_network(static_cast<std::int32_t>(bytes.size()));
+
+	Dson loaded;
+	loaded.set_load_filter(std::vector<DsonKey>{1});
+	// Сообщение загружается до первого ребёнка
+	pair_.send(bytes, 0, DsonObj::header_size * 2);
+	Result result{Result::InProcess};
+	while (result == Result::InProcess)
+	{
+		result = loaded.load_from_fd(pair_.reader());
+	}
+	EXPECT_EQ(Result::Error, result);
+}
+
+} // namespace
+} // namespace hi
@@ -0,0 +1,153 @@
+/*
+ * This is the source code of thread_highways library
+ *
+ * Copyright (c) Dmitriy Bondarenko
+ * feel free to contact me: bondarenkoda@gmail.com
+ */
+
+#include "dson_test_io.h"
+
+#include <dson/dson.h>
+#include <dson/from_dson_converters.h>
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace hi
+{
+namespace
+{
+
+constexpr const char * file_name{"test_mmap.bin"};
+
+Dson make_archive()
+{
+	Dson dson;
+	dson.set_key(42);
+	for (std::int32_t key = 0; key < 8; ++key)
+	{
+		dson.emplace(key, std::string(100000, static_cast<char>('a' + key)));
+	}
+	dson.emplace(100, std::uint32_t{100500});
+	return dson;
+}
+
+void write_file(Dson & dson, bool network_order)
+{
+	std::ofstream out(file_name, std::ios::binary);
+	if (network_order)
+		dson.copy_to_stream_network_order(out);
+	else
+		dson.copy_to_stream_host_order(out);
+}
+
+std::vector<char> read_file()
+{
+	std::ifstream in(file_name, std::ios::binary);
+	return std::vector<char>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+class TestMmap : public ::testing::TestWithParam<bool>
+{
+protected:
+	void TearDown() override
+	{
+		std::remove(file_name);
+	}
+};
+
+TEST_P(TestMmap, ReadFewKeys)
+{
+	Dson archive = make_archive();
+	write_file(archive, GetParam());
+	const std::vector<char> file_before = read_file();
+
+	Dson dson;
+	ASSERT_EQ(Result::Ready, dson.map_file(file_name));
+	EXPECT_TRUE(dson.is_mapped());
+	EXPECT_EQ(42, dson.key());
+	EXPECT_EQ(100500u, to_uint32(dson, 100));
+	EXPECT_EQ(std::string(100000, 'e'), to_string_view(dson, 4));
+
+	// copy-on-write: перевод в host order не меняет файл
+	EXPECT_EQ(file_before, read_file());
+
+	// Отображение переезжает вместе с вьюхой
+	Dson moved{std::move(dson)};
+	EXPECT_TRUE(moved.is_mapped());
+	EXPECT_FALSE(dson.is_mapped());
+	EXPECT_EQ(std::string(100000, 'h'), to_string_view(moved, 7));
+
+	moved.clear();
+	EXPECT_FALSE(moved.is_mapped());
+}
+
+TEST_P(TestMmap, FullParseAndSequentialAdvice)
+{
+	Dson archive = make_archive();
+	write_file(archive, GetParam());
+
+	Dson dson;
+	ASSERT_EQ(Result::Ready, dson.map_file(file_name, MappedFile::Advice::Sequential));
+	std::int32_t count{0};
+	for (auto & it : dson.map())
+	{
+		(void)it;
+		++count;
+	}
+	EXPECT_EQ(9, count);
+	EXPECT_EQ(std::string(100000, 'a'), to_string_view(dson, 0));
+}
+
+TEST_P(TestMmap, ForwardMappedFile)
+{
+	// Отображённый файл пересылается без чтения в память: те же байты, что в файле
+	Dson archive = make_archive();
+	const bool network_order = GetParam();
+	write_file(archive, network_order);
+	const std::vector<char> file = read_file();
+
+	Dson dson;
+	ASSERT_EQ(Result::Ready, dson.map_file(file_name));
+	test::SocketPair pair;
+	for (std::int32_t round = 0; round < 2; ++round)
+	{
+		EXPECT_EQ(file, test::to_buf(dson, network_order)) << round;
+		const auto sent = pair.transfer(
+			[&](std::int32_t fd)
+			{
+				return network_order ? dson.copy_to_fd_network_order(fd) : dson.copy_to_fd_host_order(fd);
+			});
+		ASSERT_EQ(Result::Ready, sent.result);
+		EXPECT_EQ(file, sent.received) << round;
+		EXPECT_EQ(test::to_buf(archive, !network_order), test::to_buf(dson, !network_order)) << round;
+		// Второй раз - после чтения поля (ребёнок переведён в host order в отображении)
+		EXPECT_EQ(100500u, to_uint32(dson, 100));
+	}
+}
+
+INSTANTIATE_TEST_SUITE_P(ByteOrder, TestMmap, ::testing::Values(false, true));
+
+TEST(TestMmapErrors, MissingOrTruncatedFile)
+{
+	Dson dson;
+	EXPECT_EQ(Result::Error, dson.map_file("no_such_file.bin"));
+	EXPECT_FALSE(dson.is_mapped());
+
+	Dson archive = make_archive();
+	const std::vector<char> buf = test::to_buf(archive, false);
+	{
+		std::ofstream out(file_name, std::ios::binary);
+		out.write(buf.data(), static_cast<std::streamsize>(buf.size() / 2));
+	}
+	EXPECT_EQ(Result::Error, dson.map_file(file_name));
+	EXPECT_FALSE(dson.is_mapped());
+	std::remove(file_name);
+}
+
+} // namespace
+} // namespace hi
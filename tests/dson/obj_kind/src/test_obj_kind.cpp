@@ -0,0 +1,112 @@
+/*
+ * This is the source code of thread_highways library
+ *
+ * Copyright (c) Dmitriy Bondarenko
+ * feel free to contact me: bondarenkoda@gmail.com
+ */
+
+#include <dson/include_all.h>
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+namespace hi
+{
+
+// Пользовательский тип: Dson собирается без init() и без передачи вида в DsonObj
+struct ObjKindPoint
+{
+	std::uint32_t x_;
+	std::uint32_t y_;
+};
+
+template <>
+Dson::Dson(ObjKindPoint data)
+{
+	emplace(1, data.x_);
+	emplace(2, data.y_);
+}
+
+namespace
+{
+
+std::vector<char> serialize(Dson & dson)
+{
+	std::vector<char> re(static_cast<std::size_t>(dson.data_size() + DsonObj::header_size));
+	char * ptr = re.data();
+	std::int32_t size = static_cast<std::int32_t>(re.size());
+	EXPECT_EQ(Result::Ready, dson.copy_to_buf_network_order(ptr, size));
+	return re;
+}
+
+TEST(TestObjKind, DsonFromAnyConstructor)
+{
+	std::vector<std::unique_ptr<Dson>> all;
+	all.push_back(std::make_unique<Dson>());
+	all.push_back(std::make_unique<Dson>(static_cast<std::uint32_t>(1)));
+	all.push_back(std::make_unique<Dson>(static_cast<std::int32_t>(-1)));
+	all.push_back(std::make_unique<Dson>(std::string{"str"}));
+	all.push_back(std::make_unique<Dson>(std::string_view{"view"}));
+	all.push_back(std::make_unique<Dson>(1.5));
+	all.push_back(std::make_unique<Dson>(std::make_shared<DsonArena>()));
+	all.push_back(std::make_unique<Dson>(std::move(*all.back())));
+
+	// Буфер вьюхи разрушается раньше вьюхи: деструктор Dson не читает внешний буфер
+	Dson message;
+	message.emplace(1, std::string{"child"});
+	std::vector<char> bytes = serialize(message);
+	all.push_back(std::make_unique<Dson>(bytes.data()));
+	for (auto & dson : all)
+	{
+		EXPECT_EQ(DsonObj::Kind::Dson, dson->kind());
+		DsonObj * obj = dson.get();
+		EXPECT_EQ(dson.get(), dson_cast<Dson>(obj));
+		EXPECT_EQ(nullptr, dson_cast<DsonStringObj>(obj));
+	}
+
+	// Дети разобранного буфера
+	DsonObj * child = all.back()->get(1);
+	ASSERT_NE(nullptr, dson_cast<Dson>(child));
+	EXPECT_EQ("child", to_string_view(child));
+}
+
+TEST(TestObjKind, UserSpecializationWithoutInit)
+{
+	Dson outer;
+	outer.emplace(5, Dson{ObjKindPoint{3, 4}});
+	DsonObj * obj = outer.get(5);
+	auto point = dson_cast<Dson>(obj);
+	ASSERT_NE(nullptr, point);
+	EXPECT_EQ(DsonObj::Kind::Dson, point->kind());
+	EXPECT_EQ(3u, to_uint32(*point, 1));
+	EXPECT_EQ(4u, to_uint32(*point, 2));
+
+	std::unique_ptr<DsonObj> owned = std::make_unique<Dson>(ObjKindPoint{1, 2});
+	EXPECT_NE(nullptr, dson_cast<Dson>(owned.get()));
+}
+
+TEST(TestObjKind, LibraryObjects)
+{
+	DsonStringObj str{1, std::string{"text"}};
+	DsonRouteObj route{2};
+	DsonProducerObj producer{3, TypeMarker{types_map<std::string>::value}, 0, nullptr};
+
+	EXPECT_EQ(DsonObj::Kind::StringObj, str.kind());
+	EXPECT_EQ(DsonObj::Kind::RouteObj, route.kind());
+	EXPECT_EQ(DsonObj::Kind::Custom, producer.kind());
+
+	EXPECT_EQ(&str, dson_cast<DsonStringObj>(&str));
+	EXPECT_EQ(nullptr, dson_cast<Dson>(&str));
+	EXPECT_EQ(&route, dson_cast<DsonRouteObj>(&route));
+	EXPECT_EQ(nullptr, dson_cast<Dson>(&producer));
+	EXPECT_EQ(nullptr, dson_cast<Dson>(nullptr));
+
+	EXPECT_EQ("text", to_string_view(&str));
+	EXPECT_NE(nullptr, to_address(&route));
+	EXPECT_EQ(0u, to_uint32(&producer, 0));
+}
+
+} // namespace
+} // namespace hi
@@ -0,0 +1,174 @@
+/*
+ * This is the source code of thread_highways library
+ *
+ * Copyright (c) Dmitriy Bondarenko
+ * feel free to contact me: bondarenkoda@gmail.com
+ */
+
+#include "dson_test_io.h"
+
+#include <dson/include_all.h>
+
+#include <gtest/gtest.h>
+
+#include <fcntl.h>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace hi
+{
+namespace
+{
+
+constexpr std::int32_t payload_size{1024 * 1024 + 7};
+constexpr std::int32_t chunk_size{4096};
+
+char pattern(std::int32_t i)
+{
+	return static_cast<char>('a' + i % 26);
+}
+
+std::string expected_payload()
+{
+	std::string re(payload_size, '\0');
+	for (std::int32_t i = 0; i < payload_size; ++i)
+	{
+		re[static_cast<std::size_t>(i)] = pattern(i);
+	}
+	return re;
+}
+
+// Генератор данных, запоминает самый большой запрос
+struct Generator
+{
+	std::int32_t max_request_{0};
+	std::int32_t calls_{0};
+	std::int32_t fail_at_{-1};
+
+	std::unique_ptr<DsonProducerObj> make(DsonKey key)
+	{
+		return std::make_unique<DsonProducerObj>(
+			key,
+			TypeMarker{types_map<std::string>::value},
+			payload_size,
+			[this](char * buf, std::int32_t size, std::int32_t offset) -> std::int32_t
+			{
+				++calls_;
+				max_request_ = std::max(max_request_, size);
+				if (fail_at_ >= 0 && offset >= fail_at_)
+					return -1;
+				// отдаём не больше 1000 байт за раз: producer может выдавать меньше запрошенного
+				const std::int32_t count = std::min(size, 1000);
+				for (std::int32_t i = 0; i < count; ++i)
+				{
+					buf[i] = pattern(offset + i);
+				}
+				return count;
+			},
+			chunk_size);
+	}
+};
+
+Dson make_export(Generator & generator)
+{
+	Dson dson;
+	dson.emplace(1, std::uint32_t{42});
+	dson.emplace(generator.make(2));
+	dson.emplace(3, std::string{"tail"});
+	return dson;
+}
+
+void check_export(std::vector<char> & frame)
+{
+	Dson loaded;
+	std::int32_t consumed{0};
+	ASSERT_EQ(Result::Ready, loaded.load_from_buf(frame.data(), static_cast<std::int32_t>(frame.size()), consumed));
+	EXPECT_EQ(static_cast<std::int32_t>(frame.size()), consumed);
+	EXPECT_EQ(42u, to_uint32(loaded, 1));
+	EXPECT_EQ(expected_payload(), to_string_view(loaded, 2));
+	EXPECT_EQ("tail", to_string_view(loaded, 3));
+}
+
+TEST(TestProducerObj, CopyToBufGeneratesInPlace)
+{
+	Generator generator;
+	Dson dson = make_export(generator);
+	EXPECT_EQ(payload_size, dson.get(2)->data_size());
+
+	for (bool network_order : {true, false})
+	{
+		std::vector<char> frame(static_cast<std::size_t>(dson.data_size() + DsonObj::header_size));
+		char * ptr = frame.data();
+		std::int32_t size = static_cast<std::int32_t>(frame.size());
+		const Result result
+			= network_order ? dson.copy_to_buf_network_order(ptr, size) : dson.copy_to_buf_host_order(ptr, size);
+		ASSERT_EQ(Result::Ready, result);
+		EXPECT_EQ(0, size);
+		check_export(frame);
+	}
+}
+
+TEST(TestProducerObj, CopyToFdConstantMemory)
+{
+	test::SocketPair pair;
+	Generator generator;
+	Dson dson = make_export(generator);
+	auto sent = pair.transfer(
+		[&](std::int32_t fd)
+		{
+			return dson.copy_to_fd_network_order(fd);
+		});
+	ASSERT_EQ(Result::Ready, sent.result);
+	// данные не копировались целиком в промежуточный буфер writev
+	EXPECT_LE(generator.max_request_, chunk_size);
+	check_export(sent.received);
+}
+
+TEST(TestProducerObj, CopyToStream)
+{
+	Generator generator;
+	Dson dson = make_export(generator);
+	std::stringstream stream;
+	stream << dson;
+	EXPECT_LE(generator.max_request_, chunk_size);
+	std::string str = stream.str();
+	std::vector<char> frame(str.begin(), str.end());
+	check_export(frame);
+}
+
+TEST(TestProducerObj, ResendStartsFromBeginning)
+{
+	Generator generator;
+	auto producer = generator.make(5);
+	std::vector<char> first(static_cast<std::size_t>(payload_size + DsonObj::header_size));
+	std::vector<char> second(first.size());
+	for (auto * frame : {&first, &second})
+	{
+		char * ptr = frame->data();
+		std::int32_t size = static_cast<std::int32_t>(frame->size());
+		ASSERT_EQ(Result::Ready, producer->copy_to_buf_host_order(ptr, size));
+	}
+	EXPECT_EQ(first, second);
+}
+
+TEST(TestProducerObj, ProducerFailure)
+{
+	Generator generator;
+	generator.fail_at_ = 5000;
+	auto producer = generator.make(5);
+	std::vector<char> frame(static_cast<std::size_t>(payload_size + DsonObj::header_size));
+	char * ptr = frame.data();
+	std::int32_t size = static_cast<std::int32_t>(frame.size());
+	EXPECT_EQ(Result::Error, producer->copy_to_buf_network_order(ptr, size));
+	producer->reset_state();
+	EXPECT_EQ(DsonObj::State::Ready, producer->state());
+
+	const int fd = ::open("/dev/null", O_WRONLY);
+	EXPECT_EQ(Result::Error, producer->copy_to_fd_network_order(fd));
+	::close(fd);
+}
+
+} // namespace
+} // namespace hi
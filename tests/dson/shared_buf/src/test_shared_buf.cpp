@@ -0,0 +1,171 @@
+/*
+ * This is the source code of thread_highways library
+ *
+ * Copyright (c) Dmitriy Bondarenko
+ * feel free to contact me: bondarenkoda@gmail.com
+ */
+
+#include <dson/dson.h>
+#include <dson/from_dson_converters.h>
+
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <deque>
+#include <string>
+#include <vector>
+
+namespace hi
+{
+namespace
+{
+
+Dson make_message()
+{
+	Dson dson;
+	for (std::int32_t key = 0; key < 4; ++key)
+	{
+		Dson inner;
+		inner.emplace(1, static_cast<std::uint32_t>(key));
+		inner.emplace(2, std::string(1000, static_cast<char>('a' + key)));
+		dson.emplace(key, std::move(inner));
+	}
+	return dson;
+}
+
+std::vector<char> serialize(Dson & dson)
+{
+	std::vector<char> re(static_cast<std::size_t>(dson.data_size() + DsonObj::header_size));
+	char * ptr = re.data();
+	std::int32_t size = static_cast<std::int32_t>(re.size());
+	EXPECT_EQ(Result::Ready, dson.copy_to_buf_network_order(ptr, size));
+	return re;
+}
+
+void check_inner(Dson & dson, std::int32_t key)
+{
+	EXPECT_EQ(static_cast<std::uint32_t>(key), to_uint32(dson, 1));
+	EXPECT_EQ(std::string(1000, static_cast<char>('a' + key)), to_string_view(dson, 2));
+}
+
+TEST(TestSharedBuf, ChildViewsOutliveLoadedParent)
+{
+	Dson message = make_message();
+	std::vector<char> buf = serialize(message);
+
+	std::deque<Dson> queue;
+	{
+		Dson loaded;
+		ASSERT_EQ(Result::Ready, loaded.load_from_buf(buf.data(), static_cast<std::int32_t>(buf.size())));
+		const char * payload = static_cast<char *>(loaded.data());
+		for (std::int32_t key = 0; key < 4; ++key)
+		{
+			auto child = static_cast<Dson *>(loaded.get(key));
+			ASSERT_NE(nullptr, child);
+			EXPECT_TRUE(child->is_buf_shared());
+			// дочерняя вьюха смотрит в буфер родителя
+			const char * child_data = static_cast<char *>(child->data());
+			EXPECT_TRUE(child_data > payload && child_data < payload + loaded.data_size());
+			queue.emplace_back(std::move(*child));
+			// move не копирует данные
+			EXPECT_EQ(child_data, static_cast<char *>(queue.back().data()));
+		}
+	} // родитель уничтожен, буфер держат дети
+
+	std::fill(buf.begin(), buf.end(), 0);
+	for (std::int32_t key = 0; key < 4; ++key)
+	{
+		check_inner(queue[static_cast<std::size_t>(key)], key);
+	}
+}
+
+TEST(TestSharedBuf, SharedBufferConstructor)
+{
+	Dson message = make_message();
+	const std::vector<char> bytes = serialize(message);
+	std::shared_ptr<char> buf(static_cast<char *>(std::malloc(bytes.size())), std::free);
+	std::memcpy(buf.get(), bytes.data(), bytes.size());
+	std::weak_ptr<char> weak = buf;
+
+	Dson retained;
+	{
+		Dson view{std::move(buf)};
+		EXPECT_TRUE(view.is_buf_shared());
+		auto child = static_cast<Dson *>(view.get(2));
+		ASSERT_NE(nullptr, child);
+		retained = std::move(*child);
+	}
+	EXPECT_FALSE(weak.expired());
+	check_inner(retained, 2);
+
+	retained.clear();
+	EXPECT_TRUE(weak.expired());
+}
+
+TEST(TestSharedBuf, NestedViewsShareOneBuffer)
+{
+	Dson outer;
+	outer.emplace(7, make_message());
+	const std::vector<char> bytes = serialize(outer);
+	std::shared_ptr<char> buf(new char[bytes.size()], std::default_delete<char[]>());
+	std::memcpy(buf.get(), bytes.data(), bytes.size());
+	std::weak_ptr<char> weak = buf;
+
+	Dson view{std::move(buf)};
+	Dson grandchild;
+	{
+		auto child = static_cast<Dson *>(view.get(7));
+		ASSERT_NE(nullptr, child);
+		grandchild = std::move(*static_cast<Dson *>(child->get(3)));
+	}
+	view.clear();
+	EXPECT_FALSE(weak.expired());
+	check_inner(grandchild, 3);
+}
+
+TEST(TestSharedBuf, ArenaBufferNotShared)
+{
+	Dson message = make_message();
+	std::vector<char> buf = serialize(message);
+	Dson loaded{std::make_shared<DsonArena>()};
+	ASSERT_EQ(Result::Ready, loaded.load_from_buf(buf.data(), static_cast<std::int32_t>(buf.size())));
+	auto child = static_cast<Dson *>(loaded.get(1));
+	ASSERT_NE(nullptr, child);
+	EXPECT_FALSE(child->is_buf_shared());
+	check_inner(*child, 1);
+}
+
+TEST(TestSharedBuf, ArenaChildViewsOutliveParent)
+{
+	Dson message = make_message();
+	std::vector<char> buf = serialize(message);
+	Dson other;
+	other.emplace(0, std::string(5000, 'x'));
+	std::vector<char> other_buf = serialize(other);
+
+	auto arena = std::make_shared<DsonArena>();
+	Dson loaded{arena};
+	ASSERT_EQ(Result::Ready, loaded.load_from_buf(buf.data(), static_cast<std::int32_t>(buf.size())));
+	// Дочерние вьюхи на буфер арены занимают арену: её не сбросят под ними
+	std::deque<Dson> queue;
+	queue.push_back(std::move(*static_cast<Dson *>(loaded.get(2))));
+	Dson grandchild;
+	{
+		auto child = static_cast<Dson *>(loaded.get(3));
+		ASSERT_NE(nullptr, child);
+		grandchild = std::move(*static_cast<Dson *>(child->get(2)));
+	}
+	loaded.clear();
+	ASSERT_EQ(Result::Ready, loaded.load_from_buf(other_buf.data(), static_cast<std::int32_t>(other_buf.size())));
+	EXPECT_EQ(std::string(5000, 'x'), to_string_view(loaded, 0));
+	loaded.clear();
+
+	check_inner(queue.front(), 2);
+	EXPECT_EQ(std::string(1000, 'd'), to_string_view(&grandchild));
+	queue.clear();
+	grandchild.clear();
+	EXPECT_FALSE(arena->is_borrowed());
+}
+
+} // namespace
+} // namespace hi
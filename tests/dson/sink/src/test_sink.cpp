@@ -0,0 +1,189 @@
+/*
+ * This is the source code of thread_highways library
+ *
+ * Copyright (c) Dmitriy Bondarenko
+ * feel free to contact me: bondarenkoda@gmail.com
+ */
+
+#include "dson_test_io.h"
+
+#include <dson/include_all.h>
+
+#include <gtest/gtest.h>
+
+#include <fcntl.h>
+
+#include <csignal>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace hi
+{
+namespace
+{
+
+constexpr const char * upload_name{"test_sink_upload.bin"};
+constexpr const char * received_name{"test_sink_received.bin"};
+constexpr std::int32_t upload_size{1024 * 1024 + 3};
+constexpr std::int32_t threshold{64 * 1024};
+
+std::string upload_content()
+{
+	std::string re(upload_size, '\0');
+	for (std::int32_t i = 0; i < upload_size; ++i)
+	{
+		re[static_cast<std::size_t>(i)] = static_cast<char>(i * 13 % 253);
+	}
+	return re;
+}
+
+std::string read_file(const char * name)
+{
+	std::ifstream in(name, std::ios::binary);
+	return std::string{std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+}
+
+class TestSink : public ::testing::Test
+{
+protected:
+	void SetUp() override
+	{
+		std::ofstream out(upload_name, std::ios::binary);
+		const std::string content = upload_content();
+		out.write(content.data(), static_cast<std::streamsize>(content.size()));
+	}
+
+	void TearDown() override
+	{
+		if (sender_.joinable())
+			sender_.join();
+		std::remove(upload_name);
+		std::remove(received_name);
+	}
+
+	// Загрузка файла (большое сообщение) и следом маленькое сообщение
+	void send_upload()
+	{
+		sender_ = std::thread(
+			[this]
+			{
+				DsonFileObj upload{7, upload_name};
+				Result result{Result::InProcess};
+				while (result == Result::InProcess)
+				{
+					result = upload.copy_to_fd_network_order(pair_.writer());
+				}
+				Dson small;
+				small.set_key(8);
+				small.emplace(1, std::uint32_t{88});
+				result = Result::InProcess;
+				while (result == Result::InProcess)
+				{
+					result = small.copy_to_fd_network_order(pair_.writer());
+				}
+			});
+	}
+
+	Result load(Dson & dson, DsonSink & sink)
+	{
+		Result result{Result::InProcess};
+		while (result == Result::InProcess)
+		{
+			result = dson.load_from_fd(pair_.reader(), sink, threshold);
+		}
+		return result;
+	}
+
+	void check_small(Dson & dson, DsonSink & sink)
+	{
+		ASSERT_EQ(Result::Ready, load(dson, sink));
+		EXPECT_FALSE(dson.is_data_in_sink());
+		EXPECT_EQ(8, dson.key());
+		EXPECT_EQ(88u, to_uint32(dson, 1));
+	}
+
+	test::SocketPair pair_{test::SocketPair::Mode::Blocking};
+	std::thread sender_;
+};
+
+TEST_F(TestSink, FileSink)
+{
+	const int file = ::open(received_name, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	ASSERT_GE(file, 0);
+	DsonFileSink sink{file, 0};
+	send_upload();
+
+	Dson dson;
+	ASSERT_EQ(Result::Ready, load(dson, sink));
+	EXPECT_TRUE(dson.is_data_in_sink());
+	EXPECT_EQ(7, dson.key());
+	EXPECT_EQ(0, dson.data_size());
+	EXPECT_EQ(upload_size, sink.header().data_size_);
+	EXPECT_EQ(7, sink.header().key_);
+	EXPECT_EQ(upload_size, sink.size());
+	::close(file);
+	EXPECT_EQ(upload_content(), read_file(received_name));
+
+	check_small(dson, sink);
+}
+
+TEST_F(TestSink, BufSink)
+{
+	std::vector<char> registered(upload_size);
+	DsonBufSink sink{registered.data(), static_cast<std::int64_t>(registered.size())};
+	send_upload();
+
+	Dson dson;
+	ASSERT_EQ(Result::Ready, load(dson, sink));
+	EXPECT_TRUE(dson.is_data_in_sink());
+	EXPECT_EQ(upload_size, sink.size());
+	EXPECT_EQ(upload_content(), std::string(registered.begin(), registered.end()));
+
+	check_small(dson, sink);
+}
+
+TEST_F(TestSink, BufSinkTooSmall)
+{
+	// отправитель получит EPIPE вместо завершения процесса
+	::signal(SIGPIPE, SIG_IGN);
+	std::vector<char> registered(threshold);
+	DsonBufSink sink{registered.data(), static_cast<std::int64_t>(registered.size())};
+	send_upload();
+
+	Dson dson;
+	EXPECT_EQ(Result::Error, load(dson, sink));
+	// разрываем соединение: отправитель не должен зависнуть
+	::shutdown(pair_.reader(), SHUT_RDWR);
+}
+
+TEST_F(TestSink, CallbackSink)
+{
+	std::string received;
+	std::int32_t max_chunk{0};
+	DsonCallbackSink sink{
+		[&](const DsonObj::Header & header, const char * data, std::int32_t size)
+		{
+			EXPECT_EQ(7, header.key_);
+			EXPECT_EQ(upload_size, header.data_size_);
+			max_chunk = std::max(max_chunk, size);
+			received.append(data, static_cast<std::size_t>(size));
+			return true;
+		},
+		4096};
+	send_upload();
+
+	Dson dson;
+	ASSERT_EQ(Result::Ready, load(dson, sink));
+	EXPECT_TRUE(dson.is_data_in_sink());
+	EXPECT_LE(max_chunk, 4096);
+	EXPECT_EQ(upload_content(), received);
+
+	check_small(dson, sink);
+}
+
+} // namespace
+} // namespace hi
@@ -0,0 +1,242 @@
+/*
+ * This is the source code of thread_highways library
+ *
+ * Copyright (c) Dmitriy Bondarenko
+ * feel free to contact me: bondarenkoda@gmail.com
+ */
+
+#include <dson/include_all.h>
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace hi
+{
+namespace
+{
+
+Dson make_message()
+{
+	Dson dson;
+	dson.set_key(7);
+	dson.emplace(1, std::uint32_t{100500});
+	dson.emplace(2, std::string(10000, 's'));
+	Dson inner;
+	inner.emplace(1, -2.5);
+	dson.emplace(3, std::move(inner));
+	dson.emplace(std::make_unique<DsonStringObj>(4, std::string{"string obj"}));
+	auto route = std::make_unique<DsonRouteObj>(5);
+	route->address()->from_cli_id = 1;
+	route->address()->to_cli_id = 2;
+	dson.emplace(std::move(route));
+	return dson;
+}
+
+void check_message(Dson & dson)
+{
+	EXPECT_EQ(7, dson.key());
+	EXPECT_EQ(100500u, to_uint32(dson, 1));
+	EXPECT_EQ(std::string(10000, 's'), to_string_view(dson, 2));
+	auto inner = dynamic_cast<Dson *>(dson.get(3));
+	ASSERT_NE(nullptr, inner);
+	EXPECT_DOUBLE_EQ(-2.5, to_double(*inner, 1));
+	EXPECT_EQ("string obj", to_string_view(dson, 4));
+	const auto address = to_address(dson.get(5));
+	ASSERT_NE(nullptr, address);
+	EXPECT_EQ(1u, address->from_cli_id);
+	EXPECT_EQ(2u, address->to_cli_id);
+}
+
+/*
+ * Пользовательский тип, написанный под прежнюю сигнатуру copy_to_stream_*(std::ofstream &):
+ * собирается без изменений, в std::ofstream пишет сам, в остальные потоки - через copy_to_buf_*
+ */
+class LegacyStreamObj : public DsonObj
+{
+public:
+	LegacyStreamObj(const DsonKey key, std::string data)
+		: key_{key}
+		, data_{std::move(data)}
+	{
+	}
+
+	bool is_host_order() const noexcept override
+	{
+		return true;
+	}
+
+	bool is_network_order() const noexcept override
+	{
+		return false;
+	}
+
+	std::int32_t data_size() const noexcept override
+	{
+		return static_cast<std::int32_t>(data_.size());
+	}
+
+	DsonKey key() const noexcept override
+	{
+		return key_;
+	}
+
+	void set_key(const DsonKey key) noexcept override
+	{
+		key_ = key;
+	}
+
+	TypeMarker data_type() const noexcept override
+	{
+		return types_map<std::string>::value;
+	}
+
+	void copy_to_stream_host_order(std::ofstream & out) override
+	{
+		++file_writes_;
+		const std::string frame = make_frame(false);
+		out.write(frame.data(), static_cast<std::streamsize>(frame.size()));
+	}
+
+	void copy_to_stream_network_order(std::ofstream & out) override
+	{
+		++file_writes_;
+		const std::string frame = make_frame(true);
+		out.write(frame.data(), static_cast<std::streamsize>(frame.size()));
+	}
+
+	Result copy_to_fd_host_order(std::int32_t) override
+	{
+		return Result::Error;
+	}
+
+	Result copy_to_fd_network_order(std::int32_t) override
+	{
+		return Result::Error;
+	}
+
+	Result copy_to_buf_host_order(char *& buf, std::int32_t & buf_size) override
+	{
+		return copy_to_buf(make_frame(false), buf, buf_size);
+	}
+
+	Result copy_to_buf_network_order(char *& buf, std::int32_t & buf_size) override
+	{
+		return copy_to_buf(make_frame(true), buf, buf_size);
+	}
+
+	State state() const noexcept override
+	{
+		return state_;
+	}
+
+	void reset_state() noexcept override
+	{
+		state_ = State::Ready;
+	}
+
+	std::int32_t file_writes_{0};
+
+private:
+	std::string make_frame(const bool network_order) const
+	{
+		Header header{mark_host_order, data_size(), key_, data_type()};
+		if (network_order)
+		{
+			header_network_host(reinterpret_cast<std::uint32_t *>(&header));
+		}
+		std::string re(reinterpret_cast<const char *>(&header), header_size);
+		re.append(data_);
+		return re;
+	}
+
+	// Для простоты выгружается только целиком
+	static Result copy_to_buf(const std::string & frame, char *& buf, std::int32_t & buf_size)
+	{
+		if (buf_size < static_cast<std::int32_t>(frame.size()))
+			return Result::Error;
+		std::memcpy(buf, frame.data(), frame.size());
+		buf += frame.size();
+		buf_size -= static_cast<std::int32_t>(frame.size());
+		return Result::Ready;
+	}
+
+	DsonKey key_;
+	std::string data_;
+};
+
+TEST(TestStreamIo, StringStreamRoundTrip)
+{
+	Dson message = make_message();
+	std::stringstream stream;
+	stream << message << message;
+	EXPECT_EQ(2 * static_cast<std::size_t>(message.data_size() + DsonObj::header_size), stream.str().size());
+
+	for (std::int32_t i = 0; i < 2; ++i)
+	{
+		Dson loaded;
+		stream >> loaded;
+		ASSERT_EQ(DsonObj::State::Ready, loaded.state());
+		check_message(loaded);
+	}
+	Dson end;
+	stream >> end;
+	EXPECT_EQ(DsonObj::State::Error, end.state());
+}
+
+TEST(TestStreamIo, StreamMatchesBuf)
+{
+	Dson message = make_message();
+	std::vector<char> expected(static_cast<std::size_t>(message.data_size() + DsonObj::header_size));
+	char * ptr = expected.data();
+	std::int32_t size = static_cast<std::int32_t>(expected.size());
+	ASSERT_EQ(Result::Ready, message.copy_to_buf_host_order(ptr, size));
+
+	std::ostringstream out;
+	message.copy_to_stream_host_order(out);
+	EXPECT_EQ(std::string(expected.begin(), expected.end()), out.str());
+}
+
+TEST(TestStreamIo, LegacyOfstreamOverride)
+{
+	constexpr const char * file_name{"test_stream_io.bin"};
+	LegacyStreamObj legacy{9, std::string(1000, 'l')};
+	{
+		std::ofstream out(file_name, std::ios::binary);
+		DsonObj & obj = legacy;
+		obj.copy_to_stream_network_order(out);
+		out << obj;
+	}
+	EXPECT_EQ(2, legacy.file_writes_);
+	{
+		std::ifstream in(file_name, std::ios::binary);
+		for (std::int32_t i = 0; i < 2; ++i)
+		{
+			Dson loaded;
+			in >> loaded;
+			ASSERT_EQ(DsonObj::State::Ready, loaded.state());
+			EXPECT_EQ(9, loaded.key());
+			EXPECT_EQ(std::string(1000, 'l'), to_string_view(&loaded));
+		}
+	}
+	std::remove(file_name);
+
+	// Ребёнком контейнера выгружается в std::ostream через copy_to_buf_*
+	Dson message = make_message();
+	message.emplace(std::make_unique<LegacyStreamObj>(6, std::string(500, 'L')));
+	std::stringstream stream;
+	stream << message;
+	Dson loaded;
+	stream >> loaded;
+	ASSERT_EQ(DsonObj::State::Ready, loaded.state());
+	check_message(loaded);
+	EXPECT_EQ(std::string(500, 'L'), to_string_view(loaded, 6));
+}
+
+} // namespace
+} // namespace hi
@@ -0,0 +1,177 @@
+/*
+ * This is the source code of thread_highways library
+ *
+ * Copyright (c) Dmitriy Bondarenko
+ * feel free to contact me: bondarenkoda@gmail.com
+ */
+
+#include "dson_test_io.h"
+
+#include <dson/dson.h>
+#include <dson/from_dson_converters.h>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <csignal>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace hi
+{
+namespace
+{
+
+constexpr std::int32_t big_size{256 * 1024};
+
+// Маршрут в первых полях, большой хвост в конце
+Dson make_message()
+{
+	Dson dson;
+	for (std::int32_t key = 0; key < 4; ++key)
+	{
+		Dson inner;
+		inner.emplace(1, static_cast<std::uint32_t>(key + 100));
+		inner.emplace(2, std::string(key == 3 ? big_size : 100, static_cast<char>('a' + key)));
+		dson.emplace(key, std::move(inner));
+	}
+	return dson;
+}
+
+void check_inner(Dson & dson, std::int32_t key)
+{
+	EXPECT_EQ(key, dson.key());
+	EXPECT_EQ(static_cast<std::uint32_t>(key + 100), to_uint32(dson, 1));
+	EXPECT_EQ(
+		std::string(key == 3 ? big_size : 100, static_cast<char>('a' + key)),
+		to_string_view(dson, 2));
+}
+
+TEST(TestStreamParse, FieldsBeforeMessageLoaded)
+{
+	Dson message = make_message();
+	std::vector<char> bytes = test::to_buf(message, true);
+	const std::int32_t total = static_cast<std::int32_t>(bytes.size());
+
+	Dson loaded;
+	Dson child;
+	std::vector<Dson> children;
+	std::vector<std::int32_t> fed_when_ready;
+	std::int32_t fed{0};
+	Result result{Result::InProcess};
+	while (result == Result::InProcess)
+	{
+		// Сообщение приходит кусками по 1000 байт
+		std::int32_t consumed{0};
+		const std::int32_t window = std::min(1000, total - fed);
+		result = loaded.load_from_buf(bytes.data() + fed, window, consumed);
+		fed += consumed;
+		while (loaded.next_loaded(child))
+		{
+			fed_when_ready.push_back(fed);
+			children.emplace_back(std::move(child));
+		}
+	}
+	ASSERT_EQ(Result::Ready, result);
+	ASSERT_EQ(total, fed);
+	EXPECT_FALSE(loaded.next_loaded(child));
+
+	ASSERT_EQ(4u, children.size());
+	for (std::int32_t key = 0; key < 4; ++key)
+	{
+		check_inner(children[static_cast<std::size_t>(key)], key);
+	}
+	// Маршрут известен задолго до конца сообщения
+	EXPECT_LT(fed_when_ready[0], 1000 * 2);
+	EXPECT_LT(fed_when_ready[2], 1000 * 2);
+	EXPECT_LT(fed_when_ready[2], total / 2);
+	EXPECT_EQ(total, fed_when_ready[3]);
+
+	// Загруженное сообщение доступно целиком и выгружается без искажений
+	check_inner(*static_cast<Dson *>(loaded.get(3)), 3);
+	EXPECT_EQ(bytes, test::to_buf(loaded, true));
+}
+
+TEST(TestStreamParse, ChildrenOutliveParent)
+{
+	Dson message = make_message();
+	std::vector<char> bytes = test::to_buf(message, true);
+
+	std::vector<Dson> children;
+	{
+		Dson loaded;
+		ASSERT_EQ(Result::Ready, loaded.load_from_buf(bytes.data(), static_cast<std::int32_t>(bytes.size())));
+		Dson child;
+		while (loaded.next_loaded(child))
+		{
+			children.emplace_back(std::move(child));
+		}
+		// Повторная загрузка выдаёт детей сначала
+		ASSERT_EQ(Result::Ready, loaded.load_from_buf(bytes.data(), static_cast<std::int32_t>(bytes.size())));
+		ASSERT_TRUE(loaded.next_loaded(child));
+		EXPECT_EQ(0, child.key());
+	}
+	std::fill(bytes.begin(), bytes.end(), 0);
+	ASSERT_EQ(4u, children.size());
+	for (std::int32_t key = 0; key < 4; ++key)
+	{
+		EXPECT_TRUE(children[static_cast<std::size_t>(key)].is_buf_shared());
+		check_inner(children[static_cast<std::size_t>(key)], key);
+	}
+}
+
+TEST(TestStreamParse, LoadFromFd)
+{
+	::signal(SIGPIPE, SIG_IGN);
+	Dson message = make_message();
+	const std::vector<char> bytes = test::to_buf(message, true);
+	test::SocketPair pair{test::SocketPair::Mode::BlockingWriter};
+
+	// Хвост сообщения отправляется только после разбора первых полей
+	const std::size_t head = bytes.size() - big_size / 2;
+	std::atomic<bool> send_tail{false};
+	std::thread sender(
+		[&]
+		{
+			pair.send(bytes, 0, head);
+			while (!send_tail)
+				std::this_thread::yield();
+			pair.send(bytes, head, bytes.size());
+		});
+
+	Dson loaded;
+	Dson child;
+	std::vector<Dson> children;
+	Result result{Result::InProcess};
+	while (children.size() < 3)
+	{
+		result = loaded.load_from_fd(pair.reader());
+		ASSERT_EQ(Result::InProcess, result);
+		while (loaded.next_loaded(child))
+		{
+			children.emplace_back(std::move(child));
+		}
+	}
+	for (std::int32_t key = 0; key < 3; ++key)
+	{
+		check_inner(children[static_cast<std::size_t>(key)], key);
+	}
+
+	send_tail = true;
+	while (result == Result::InProcess)
+	{
+		result = loaded.load_from_fd(pair.reader());
+		while (loaded.next_loaded(child))
+		{
+			children.emplace_back(std::move(child));
+		}
+	}
+	sender.join();
+	ASSERT_EQ(Result::Ready, result);
+	ASSERT_EQ(4u, children.size());
+	check_inner(children[3], 3);
+}
+
+} // namespace
+} // namespace hi
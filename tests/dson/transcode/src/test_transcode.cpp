@@ -0,0 +1,153 @@
+/*
+ * This is the source code of thread_highways library
+ *
+ * Copyright (c) Dmitriy Bondarenko
+ * feel free to contact me: bondarenkoda@gmail.com
+ */
+
+#include "dson_test_io.h"
+
+#include <dson/dson.h>
+#include <dson/from_dson_converters.h>
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace hi
+{
+namespace
+{
+
+Dson make_message()
+{
+	Dson dson;
+	for (std::int32_t key = 0; key < 10; ++key)
+	{
+		dson.emplace(key, static_cast<std::uint32_t>(key * 1000 + 7));
+	}
+	Dson deep;
+	deep.emplace(1, std::int32_t{-5});
+	deep.emplace(2, std::string{"deep"});
+	Dson inner;
+	inner.emplace(1, std::string(300, 'z'));
+	inner.emplace(2, 0x01020304u);
+	inner.emplace(3, std::move(deep));
+	inner.emplace(4, Dson{});
+	dson.emplace(20, std::move(inner));
+	dson.emplace(21, std::string{"tail"});
+	return dson;
+}
+
+class TestTranscode : public ::testing::Test
+{
+protected:
+	void SetUp() override
+	{
+		Dson message = make_message();
+		host_ = test::to_buf(message, false);
+		network_ = test::to_buf(message, true);
+	}
+
+	std::vector<char> host_;
+	std::vector<char> network_;
+};
+
+TEST_F(TestTranscode, NetworkToHostWithoutParse)
+{
+	if (mark_host_order == mark_network_order)
+		GTEST_SKIP() << "host order is network order";
+	ASSERT_NE(host_, network_);
+
+	// Вьюха на принятый буфер: разбор перевёл бы детей в host order прямо в нём
+	std::vector<char> received = network_;
+	Dson loaded;
+	std::int32_t consumed{0};
+	ASSERT_EQ(
+		Result::Ready,
+		loaded.load_from_buf(received.data(), static_cast<std::int32_t>(received.size()), consumed));
+	const std::vector<char> before = received;
+
+	EXPECT_EQ(host_, test::to_buf(loaded, false));
+	EXPECT_EQ(before, received);
+	EXPECT_EQ(network_, test::to_buf(loaded, true));
+	EXPECT_EQ(before, received);
+
+	// Сообщение после пересылки читается как обычно
+	EXPECT_EQ(9007u, to_uint32(loaded, 9));
+	auto inner = dson_cast<Dson>(loaded.get(20));
+	ASSERT_NE(nullptr, inner);
+	EXPECT_EQ(0x01020304u, to_uint32(*inner, 2));
+}
+
+TEST_F(TestTranscode, HostToNetwork)
+{
+	Dson loaded;
+	ASSERT_EQ(Result::Ready, loaded.load_from_buf(host_.data(), static_cast<std::int32_t>(host_.size())));
+	EXPECT_EQ(network_, test::to_buf(loaded, true));
+	EXPECT_EQ(host_, test::to_buf(loaded, false));
+}
+
+TEST_F(TestTranscode, SmallWindows)
+{
+	Dson loaded;
+	ASSERT_EQ(Result::Ready, loaded.load_from_buf(network_.data(), static_cast<std::int32_t>(network_.size())));
+	for (std::int32_t window : {1, 7, 100})
+	{
+		EXPECT_EQ(host_, test::to_buf(loaded, false, window)) << window;
+		EXPECT_EQ(network_, test::to_buf(loaded, true, window)) << window;
+	}
+}
+
+TEST_F(TestTranscode, MixedOrderAfterNextLoaded)
+{
+	Dson loaded;
+	ASSERT_EQ(Result::Ready, loaded.load_from_buf(network_.data(), static_cast<std::int32_t>(network_.size())));
+	// Часть детей переведена в host order прямо в буфере сообщения
+	Dson child;
+	for (std::int32_t key = 0; key < 3; ++key)
+	{
+		ASSERT_TRUE(loaded.next_loaded(child));
+		EXPECT_EQ(static_cast<std::uint32_t>(key * 1000 + 7), to_uint32(&child));
+	}
+
+	EXPECT_EQ(host_, test::to_buf(loaded, false));
+	EXPECT_EQ(network_, test::to_buf(loaded, true));
+}
+
+TEST_F(TestTranscode, StreamAndFd)
+{
+	Dson loaded;
+	ASSERT_EQ(Result::Ready, loaded.load_from_buf(network_.data(), static_cast<std::int32_t>(network_.size())));
+
+	std::ostringstream out;
+	loaded.copy_to_stream_host_order(out);
+	const std::string streamed = out.str();
+	EXPECT_EQ(host_, std::vector<char>(streamed.begin(), streamed.end()));
+
+	test::SocketPair pair{test::SocketPair::Mode::Blocking};
+	EXPECT_EQ(Result::Ready, loaded.copy_to_fd_host_order(pair.writer()));
+	EXPECT_EQ(host_, pair.receive(host_.size()));
+}
+
+TEST_F(TestTranscode, CorruptedBufferIsError)
+{
+	if (mark_host_order == mark_network_order)
+		GTEST_SKIP() << "host order is network order";
+
+	// Размер первого ребёнка вылезает за сообщение
+	std::vector<char> corrupted = network_;
+	const std::uint32_t size = htonl(0x7fffff00u);
+	std::memcpy(corrupted.data() + DsonObj::header_size + sizeof(std::uint32_t), &size, sizeof(size));
+	Dson loaded;
+	ASSERT_EQ(Result::Ready, loaded.load_from_buf(corrupted.data(), static_cast<std::int32_t>(corrupted.size())));
+	std::vector<char> out(host_.size());
+	char * ptr = out.data();
+	std::int32_t out_size = static_cast<std::int32_t>(out.size());
+	EXPECT_EQ(Result::Error, loaded.copy_to_buf_host_order(ptr, out_size));
+}
+
+} // namespace
+} // namespace hi
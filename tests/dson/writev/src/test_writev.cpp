@@ -0,0 +1,280 @@
+/*
+ * This is the source code of thread_highways library
+ *
+ * Copyright (c) Dmitriy Bondarenko
+ * feel free to contact me: bondarenkoda@gmail.com
+ */
+
+#include "dson_test_io.h"
+
+#include <dson/dson.h>
+#include <dson/from_dson_converters.h>
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+namespace hi
+{
+namespace
+{
+
+Dson make_message()
+{
+	Dson dson;
+	for (std::int32_t key = 0; key < 20; ++key)
+	{
+		dson.emplace(key, static_cast<std::uint32_t>(key * 1000));
+	}
+	Dson inner;
+	inner.emplace(1, std::string(100000, 'z'));
+	inner.emplace(2, -1.5);
+	dson.emplace(20, std::move(inner));
+	// не Dson: выгружается через промежуточный буфер
+	dson.emplace(std::make_unique<DsonStringObj>(21, std::string{"string obj"}));
+	return dson;
+}
+
+/*
+ * Пользовательский объект, у которого для отправки в fd работает только copy_to_fd_*:
+ * от пользовательских объектов не требуется, чтобы copy_to_buf_* выдавал те же байты
+ */
+class FdOnlyObj : public DsonObj
+{
+public:
+	FdOnlyObj(const DsonKey key, std::string data)
+		: key_{key}
+		, data_{std::move(data)}
+	{
+	}
+
+	bool is_host_order() const noexcept override
+	{
+		return true;
+	}
+
+	bool is_network_order() const noexcept override
+	{
+		return false;
+	}
+
+	std::int32_t data_size() const noexcept override
+	{
+		return static_cast<std::int32_t>(data_.size());
+	}
+
+	DsonKey key() const noexcept override
+	{
+		return key_;
+	}
+
+	void set_key(const DsonKey key) noexcept override
+	{
+		key_ = key;
+	}
+
+	TypeMarker data_type() const noexcept override
+	{
+		return types_map<std::string>::value;
+	}
+
+	void copy_to_stream_host_order(std::ostream &) override
+	{
+	}
+
+	void copy_to_stream_network_order(std::ostream &) override
+	{
+	}
+
+	Result copy_to_fd_host_order(std::int32_t fd) override
+	{
+		return copy_to_fd<false>(fd);
+	}
+
+	Result copy_to_fd_network_order(std::int32_t fd) override
+	{
+		return copy_to_fd<true>(fd);
+	}
+
+	Result copy_to_buf_host_order(char *&, std::int32_t &) override
+	{
+		return Result::Error;
+	}
+
+	Result copy_to_buf_network_order(char *&, std::int32_t &) override
+	{
+		return Result::Error;
+	}
+
+	State state() const noexcept override
+	{
+		return state_;
+	}
+
+	void reset_state() noexcept override
+	{
+		state_ = State::Ready;
+	}
+
+private:
+	template <bool network_order>
+	Result copy_to_fd(std::int32_t fd)
+	{
+		if (state_ == State::Ready)
+		{
+			Header header{mark_host_order, data_size(), key_, data_type()};
+			if constexpr (network_order)
+			{
+				header_network_host(reinterpret_cast<std::uint32_t *>(&header));
+			}
+			out_.assign(reinterpret_cast<const char *>(&header), header_size);
+			out_.append(data_);
+			offset_ = 0;
+			state_ = State::CopyingData;
+		}
+		const auto writed = write_to_fd(fd, out_.data() + offset_, static_cast<std::int64_t>(out_.size()) - offset_);
+		if (writed < 0)
+		{
+			state_ = State::Ready;
+			return Result::Error;
+		}
+		offset_ += static_cast<std::int32_t>(writed);
+		if (offset_ < static_cast<std::int32_t>(out_.size()))
+			return Result::InProcess;
+		state_ = State::Ready;
+		return Result::Ready;
+	}
+
+	DsonKey key_;
+	std::string data_;
+	std::string out_;
+};
+
+void check_message(Dson & dson)
+{
+	for (std::int32_t key = 0; key < 20; ++key)
+	{
+		EXPECT_EQ(static_cast<std::uint32_t>(key * 1000), to_uint32(dson, key));
+	}
+	auto inner = dynamic_cast<Dson *>(dson.get(20));
+	ASSERT_NE(nullptr, inner);
+	EXPECT_EQ(std::string(100000, 'z'), to_string_view(*inner, 1));
+	EXPECT_DOUBLE_EQ(-1.5, to_double(*inner, 2));
+	EXPECT_EQ("string obj", to_string_view(dson, 21));
+}
+
+class TestWritev : public ::testing::Test
+{
+protected:
+	// Выгрузка с вычитыванием из второго конца, пока не будет Ready
+	template <typename F>
+	std::vector<char> transfer(F && copy)
+	{
+		auto sent = pair_.transfer(std::forward<F>(copy));
+		EXPECT_EQ(Result::Ready, sent.result);
+		EXPECT_LT(0, sent.in_process);
+		return std::move(sent.received);
+	}
+
+	test::SocketPair pair_{test::SocketPair::Mode::NonBlocking, test::SocketPair::small_send_buf};
+};
+
+TEST_F(TestWritev, PartialWritesNetworkOrder)
+{
+	Dson message = make_message();
+	const std::vector<char> expected = test::to_buf(message, true);
+	std::vector<char> received = transfer(
+		[&](std::int32_t fd)
+		{
+			return message.copy_to_fd_network_order(fd);
+		});
+	EXPECT_EQ(expected, received);
+
+	Dson loaded;
+	ASSERT_EQ(Result::Ready, loaded.load_from_buf(received.data(), static_cast<std::int32_t>(received.size())));
+	check_message(loaded);
+}
+
+TEST_F(TestWritev, HostOrderAndRepeatedSend)
+{
+	Dson message = make_message();
+	for (std::int32_t i = 0; i < 2; ++i)
+	{
+		std::vector<char> received = transfer(
+			[&](std::int32_t fd)
+			{
+				return message.copy_to_fd_host_order(fd);
+			});
+		Dson loaded;
+		ASSERT_EQ(Result::Ready, loaded.load_from_buf(received.data(), static_cast<std::int32_t>(received.size())));
+		check_message(loaded);
+	}
+}
+
+TEST_F(TestWritev, AfterPartialCopyToBuf)
+{
+	Dson message = make_message();
+	const std::vector<char> expected = test::to_buf(message, false);
+	// Выгрузка в буфер остановлена посреди ребёнка (в том числе не Dson): в fd уходит всё дерево
+	for (const std::size_t window : {std::size_t{30}, expected.size() - 5})
+	{
+		std::vector<char> partial(window);
+		char * ptr = partial.data();
+		std::int32_t size = static_cast<std::int32_t>(partial.size());
+		ASSERT_EQ(Result::InProcess, message.copy_to_buf_host_order(ptr, size));
+
+		std::vector<char> received = transfer(
+			[&](std::int32_t fd)
+			{
+				return message.copy_to_fd_host_order(fd);
+			});
+		EXPECT_EQ(expected, received) << window;
+
+		std::vector<char> again(expected.size());
+		ptr = again.data();
+		size = static_cast<std::int32_t>(again.size());
+		ASSERT_EQ(Result::Ready, message.copy_to_buf_host_order(ptr, size));
+		EXPECT_EQ(expected, again) << window;
+	}
+}
+
+TEST_F(TestWritev, ForwardReceivedView)
+{
+	// Принятый буфер пересылается без разбора (одним участком)
+	Dson message = make_message();
+	std::vector<char> buf = test::to_buf(message, true);
+
+	Dson view{buf.data()};
+	std::vector<char> received = transfer(
+		[&](std::int32_t fd)
+		{
+			return view.copy_to_fd_network_order(fd);
+		});
+	EXPECT_EQ(buf, received);
+}
+
+TEST_F(TestWritev, CustomChildUsesOwnCopyToFd)
+{
+	for (const bool network_order : {false, true})
+	{
+		Dson message = make_message();
+		message.emplace(std::make_unique<FdOnlyObj>(22, std::string(1000, 'c')));
+		message.emplace(std::make_unique<FdOnlyObj>(23, std::string(100000, 'C')));
+		std::vector<char> received = transfer(
+			[&](std::int32_t fd)
+			{
+				return network_order ? message.copy_to_fd_network_order(fd) : message.copy_to_fd_host_order(fd);
+			});
+		ASSERT_EQ(static_cast<std::size_t>(message.data_size() + DsonObj::header_size), received.size());
+
+		Dson loaded;
+		ASSERT_EQ(Result::Ready, loaded.load_from_buf(received.data(), static_cast<std::int32_t>(received.size())));
+		check_message(loaded);
+		EXPECT_EQ(std::string(1000, 'c'), to_string_view(loaded, 22)) << network_order;
+		EXPECT_EQ(std::string(100000, 'C'), to_string_view(loaded, 23)) << network_order;
+	}
+}
+
+} // namespace
+} // namespace hi